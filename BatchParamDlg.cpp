@@ -0,0 +1,237 @@
+#include "BatchParamDlg.h"
+
+#include "xcsvmodel.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QBuffer>
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QLabel>
+#include <QTableView>
+#include <QHeaderView>
+
+enum {
+    NameColumn,
+    ColumnColumn
+};
+
+/******************************************************************/
+
+BatchParamDlg::BatchParamDlg(const QStringList &params, QWidget *parent) :
+    QDialog(parent)
+{
+    d.params = params;
+    d.csvModel = new XCsvModel(this);
+    setupUI();
+}
+
+/******************************************************************/
+
+QMap<QString, int> BatchParamDlg::columns() const
+{
+    QMap<QString, int> result;
+    for (const auto &param : d.params) {
+        QComboBox *cmb = findChild<QComboBox *>(comboName(param));
+        if (cmb) {
+            result.insert(param, cmb->currentIndex());
+        }
+    }
+    return result;
+}
+
+/******************************************************************/
+
+int BatchParamDlg::batchSize() const
+{
+    return ui_BatchSize->value();
+}
+
+/******************************************************************/
+
+void BatchParamDlg::loadFromFile()
+{
+    QString filename = QFileDialog::getOpenFileName(this, tr("Choose a CSV file"),
+                                                    QString(),
+                                                    tr("CSV files (*.csv *.tsv *.txt);;All Files (*.*)"));
+    if (filename.isEmpty()) return;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QMessageBox::critical(this, tr("Batch parameters"),
+                              tr("Could not load CSV file\n%1").arg(file.errorString()));
+        return;
+    }
+
+    d.sourceText = QString::fromUtf8(file.readAll());
+    const QSignalBlocker blocker(ui_Separator);
+    ui_Separator->setCurrentIndex(filename.endsWith(".tsv", Qt::CaseInsensitive) ? 2 : 0);
+    parseSource();
+}
+
+/******************************************************************/
+
+void BatchParamDlg::loadFromClipboard()
+{
+    d.sourceText = QApplication::clipboard()->text();
+    const QSignalBlocker blocker(ui_Separator);
+    ui_Separator->setCurrentIndex(2); // spreadsheets put tab separated text
+    parseSource();
+}
+
+/******************************************************************/
+
+void BatchParamDlg::parseSource()
+{
+    QByteArray data = d.sourceText.toUtf8();
+    QBuffer buffer(&data);
+
+    auto model = new XCsvModel(this);
+    model->setQuoteMode(XCsvModel::DoubleQuote | XCsvModel::TwoQuoteEscape);
+    model->setSource(&buffer, ui_WithHeader->isChecked(),
+                     ui_Separator->currentData().toChar());
+
+    ui_Preview->setModel(model);
+    d.csvModel->deleteLater();
+    d.csvModel = model;
+
+    updateColumns();
+}
+
+/******************************************************************/
+
+void BatchParamDlg::checkAccept()
+{
+    if (d.csvModel->rowCount() == 0) {
+        QMessageBox::warning(this, tr("Batch parameters"),
+                             tr("No bind values loaded"));
+        return;
+    }
+    const auto map = columns();
+    for (auto i = map.constBegin(); i != map.constEnd(); ++i) {
+        if (i.value() < 0) {
+            QMessageBox::warning(this, tr("Batch parameters"),
+                                 tr("No column selected for %1").arg(i.key()));
+            return;
+        }
+    }
+    accept();
+}
+
+/******************************************************************/
+
+void BatchParamDlg::setupUI()
+{
+    setWindowTitle(tr("Run for each row"));
+
+    auto fileButton = new QPushButton(QIcon::fromTheme("document-open"), tr("Load CSV..."), this);
+    auto clipButton = new QPushButton(QIcon::fromTheme("edit-paste"), tr("Paste"), this);
+
+    ui_Separator = new QComboBox(this);
+    ui_Separator->addItem(tr("Comma"), QChar(','));
+    ui_Separator->addItem(tr("Semicolon"), QChar(';'));
+    ui_Separator->addItem(tr("Tab"), QChar('\t'));
+
+    ui_WithHeader = new QCheckBox(tr("First row is header"), this);
+    ui_WithHeader->setChecked(true);
+
+    auto sourceLayout = new QHBoxLayout();
+    sourceLayout->addWidget(fileButton);
+    sourceLayout->addWidget(clipButton);
+    sourceLayout->addWidget(ui_Separator);
+    sourceLayout->addWidget(ui_WithHeader);
+    sourceLayout->addStretch();
+
+    ui_Preview = new QTableView(this);
+    ui_Preview->setModel(d.csvModel);
+    ui_Preview->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    ui_Grid = new QGridLayout();
+    ui_Grid->addWidget(new QLabel(tr("Name"), this), 0, NameColumn);
+    ui_Grid->addWidget(new QLabel(tr("Column"), this), 0, ColumnColumn);
+    for (const auto &param : qAsConst(d.params)) {
+        const int row = ui_Grid->rowCount();
+        ui_Grid->addWidget(new QLabel(param, this), row, NameColumn);
+        auto cmb = new QComboBox(this);
+        cmb->setObjectName(comboName(param));
+        ui_Grid->addWidget(cmb, row, ColumnColumn);
+    }
+
+    ui_BatchSize = new QSpinBox(this);
+    ui_BatchSize->setRange(1, 1000000);
+    ui_BatchSize->setValue(1000);
+
+    auto batchLayout = new QFormLayout();
+    batchLayout->addRow(tr("Rows per transaction"), ui_BatchSize);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(this);
+    buttonBox->setOrientation(Qt::Horizontal);
+    buttonBox->setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(sourceLayout);
+    mainLayout->addWidget(ui_Preview);
+    mainLayout->addLayout(ui_Grid);
+    mainLayout->addLayout(batchLayout);
+    mainLayout->addWidget(buttonBox);
+
+    connect(fileButton, &QPushButton::clicked,
+            this, &BatchParamDlg::loadFromFile);
+    connect(clipButton, &QPushButton::clicked,
+            this, &BatchParamDlg::loadFromClipboard);
+    connect(ui_Separator, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &BatchParamDlg::parseSource);
+    connect(ui_WithHeader, &QCheckBox::toggled,
+            this, &BatchParamDlg::parseSource);
+    connect(buttonBox, &QDialogButtonBox::accepted,
+            this, &BatchParamDlg::checkAccept);
+    connect(buttonBox, &QDialogButtonBox::rejected,
+            this, &QDialog::reject);
+}
+
+/******************************************************************/
+//! fills parameter combos with CSV columns, header names matching a parameter are preselected
+void BatchParamDlg::updateColumns()
+{
+    QStringList columns;
+    for (int i = 0; i < d.csvModel->columnCount(); ++i) {
+        QString title = d.csvModel->headerText(i);
+        columns << (title.isEmpty() ? tr("Column %1").arg(i + 1) : title);
+    }
+
+    for (int p = 0; p < d.params.size(); ++p) {
+        const QString &param = d.params.at(p);
+        QComboBox *cmb = findChild<QComboBox *>(comboName(param));
+        if (!cmb) continue;
+
+        const QSignalBlocker blocker(cmb);
+        cmb->clear();
+        cmb->addItems(columns);
+
+        int idx = columns.indexOf(QString(param).remove(':'));
+        if (idx < 0 && p < columns.size()) idx = p;
+        cmb->setCurrentIndex(idx);
+    }
+}
+
+/******************************************************************/
+
+QString BatchParamDlg::comboName(const QString &param) const
+{
+    QString result(param);
+    result.replace(":","cmb_");
+    return result;
+}
+
+/******************************************************************/
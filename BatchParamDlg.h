@@ -0,0 +1,61 @@
+#ifndef BATCHPARAMDLG_H
+#define BATCHPARAMDLG_H
+
+#include <QDialog>
+#include <QMap>
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QComboBox;
+class QGridLayout;
+class QSpinBox;
+class QTableView;
+QT_END_NAMESPACE
+
+class XCsvModel;
+
+class BatchParamDlg : public QDialog
+{
+    Q_OBJECT
+
+    struct BatchParamDlgPrivate {
+        QStringList params;
+        QString     sourceText;           ///< raw text of the loaded CSV
+        XCsvModel  *csvModel = Q_NULLPTR;
+    };
+
+public:
+    explicit BatchParamDlg(const QStringList &params, QWidget *parent = nullptr);
+
+    /// loaded bind values, one CSV row per execution
+    XCsvModel *csvModel() const {
+        return d.csvModel;
+    }
+
+    /// CSV column of every parameter
+    QMap<QString, int> columns() const;
+
+    /// rows executed in one transaction
+    int batchSize() const;
+
+private Q_SLOTS:
+    void loadFromFile();
+    void loadFromClipboard();
+    void parseSource();
+    void checkAccept();
+
+private:
+    void setupUI();
+    void updateColumns();
+    QString comboName(const QString &param) const;
+
+private:
+    QComboBox   *ui_Separator;
+    QCheckBox   *ui_WithHeader;
+    QSpinBox    *ui_BatchSize;
+    QTableView  *ui_Preview;
+    QGridLayout *ui_Grid;
+    BatchParamDlgPrivate d;
+};
+
+#endif // BATCHPARAMDLG_H
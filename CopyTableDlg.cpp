@@ -0,0 +1,293 @@
+#include "CopyTableDlg.h"
+
+#include <QSettings>
+#include <QSqlError>
+#include <QtConcurrent>
+
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QCheckBox>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QTableWidget>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QFormLayout>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QVBoxLayout>
+#include <QtWidgets/QDialogButtonBox>
+
+enum {
+    ProgressMs = 500
+};
+
+/******************************************************************/
+
+CopyTableDlg::CopyTableDlg(const QString &sourceLabel, const QString &sourceConnection, const QString &table,
+                           QWidget *parent) :
+    QDialog(parent)
+{
+    d.sourceLabel      = sourceLabel;
+    d.sourceConnection = sourceConnection;
+    d.sourceTable      = table;
+    setWindowTitle(tr("Copy %1").arg(table));
+    setupUI();
+    ui_TargetTable->setText(table);
+
+    d.timer.setInterval(ProgressMs);
+    connect(&d.timer, &QTimer::timeout,
+            this, &CopyTableDlg::updateProgress);
+    connect(&d.watcher, &QFutureWatcher<DbCopyResult>::finished,
+            this, &CopyTableDlg::showResult);
+}
+
+/******************************************************************/
+//! the worker only shares the progress, it finishes on its own
+CopyTableDlg::~CopyTableDlg()
+{
+    if (d.progress) {
+        d.progress->canceled.storeRelaxed(1);
+    }
+}
+
+/******************************************************************/
+
+void CopyTableDlg::addTarget(const QString &label, const QString &connectionName)
+{
+    ui_Target->addItem(label, connectionName);
+}
+
+/******************************************************************/
+
+void CopyTableDlg::start()
+{
+    if (d.progress) return;
+
+    prepareCopy();
+    if (!ui_Start->isEnabled()) return;
+
+    d.progress = QSharedPointer<DbCopyProgress>::create();
+    const DbTableCopy copy = d.copy;
+    const QVariant key = ui_Resume->isChecked() ? resumeKey() : QVariant();
+    QSharedPointer<DbCopyProgress> progress = d.progress;
+    d.watcher.setFuture(QtConcurrent::run([=](){
+        return copy.run(progress.data(), key);
+    }));
+
+    d.lastWritten = 0;
+    d.lastMs = 0;
+    d.elapsed.start();
+    d.timer.start();
+    ui_Start->setText(tr("Stop"));
+    for (QWidget *widget : QList<QWidget*>() << ui_Target << ui_TargetTable << ui_Resume) {
+        widget->setEnabled(false);
+    }
+    updateProgress();
+}
+
+/******************************************************************/
+//! the batch in flight is still committed
+void CopyTableDlg::stop()
+{
+    if (d.progress) {
+        d.progress->canceled.storeRelaxed(1);
+    }
+}
+
+/******************************************************************/
+
+void CopyTableDlg::reject()
+{
+    stop();
+    QDialog::reject();
+}
+
+/******************************************************************/
+//! maps the columns for the current target, the mapping is shown before the copy starts
+void CopyTableDlg::prepareCopy()
+{
+    if (d.progress) return;
+
+    ui_Columns->setRowCount(0);
+    ui_Start->setEnabled(false);
+    if (ui_Target->currentIndex() < 0) return;
+
+    QSqlDatabase source = QSqlDatabase::database(d.sourceConnection);
+    QSqlDatabase target = QSqlDatabase::database(ui_Target->currentData().toString());
+    if (!target.isOpen()) {
+        ui_Status->setText(target.lastError().text());
+        return;
+    }
+    QString err;
+    if (!d.copy.prepare(source, d.sourceTable, target, ui_TargetTable->text().trimmed(), &err)) {
+        ui_Status->setText(err);
+        return;
+    }
+
+    const QVector<DbCopyColumn> columns = d.copy.columns();
+    ui_Columns->setRowCount(columns.size());
+    for (int i = 0; i < columns.size(); ++i) {
+        const DbCopyColumn &column = columns.at(i);
+        ui_Columns->setItem(i, 0, new QTableWidgetItem(column.label));
+        ui_Columns->setItem(i, 1, new QTableWidgetItem(column.sourceType));
+        ui_Columns->setItem(i, 2, new QTableWidgetItem(column.target));
+        ui_Columns->setItem(i, 3, new QTableWidgetItem(column.targetType));
+    }
+    ui_Columns->resizeColumnsToContents();
+
+    const QVariant key = resumeKey();
+    ui_Resume->setEnabled(!d.copy.keyField().isEmpty() && key.isValid());
+    ui_Resume->setChecked(ui_Resume->isEnabled());
+    ui_Resume->setText(ui_Resume->isEnabled()
+                       ? tr("Resume above %1 = %2").arg(d.copy.keyField(), key.toString())
+                       : tr("Resume"));
+    ui_Status->setText(d.copy.createsTable()
+                       ? tr("%1 will be created").arg(ui_TargetTable->text().trimmed())
+                       : tr("%1 fields are copied").arg(columns.size()));
+    ui_Start->setEnabled(true);
+}
+
+/******************************************************************/
+
+void CopyTableDlg::updateProgress()
+{
+    if (!d.progress) return;
+
+    // the rate of the last interval, the average is shown at the end
+    const qint64 written = d.progress->written.loadRelaxed();
+    const qint64 ms = d.elapsed.elapsed();
+    const double rate = ms > d.lastMs ? (written - d.lastWritten) * 1000.0 / (ms - d.lastMs) : 0;
+    d.lastWritten = written;
+    d.lastMs = ms;
+    ui_Status->setText(tr("%1 rows read, %2 written, %3 rows/s")
+                       .arg(d.progress->read.loadRelaxed())
+                       .arg(written)
+                       .arg(qRound64(rate)));
+    saveResumeKey(d.progress->committedKey());
+}
+
+/******************************************************************/
+
+void CopyTableDlg::showResult()
+{
+    d.timer.stop();
+    const DbCopyResult result = d.watcher.result();
+    saveResumeKey(d.progress->committedKey());
+    d.progress.reset();
+    ui_Start->setText(tr("Copy"));
+    for (QWidget *widget : QList<QWidget*>() << ui_Target << ui_TargetTable) {
+        widget->setEnabled(true);
+    }
+
+    const qint64 ms = qMax<qint64>(1, d.elapsed.elapsed());
+    QString status = tr("%1 rows in %2 s, %3 rows/s")
+            .arg(result.rows)
+            .arg(ms / 1000.0, 0, 'f', 1)
+            .arg(qRound64(result.rows * 1000.0 / ms));
+    if (result.created) {
+        status += tr(", table created");
+    }
+    if (result.partial) {
+        status += tr(", stopped");
+    }
+    if (!result.error.isEmpty()) {
+        status += "\n" + result.error;
+    } else if (!result.partial) {
+        // a complete copy has nothing to resume
+        saveResumeKey(QVariant());
+    }
+    // a created table is mapped again
+    prepareCopy();
+    ui_Status->setText(status);
+}
+
+/******************************************************************/
+
+QString CopyTableDlg::resumeEntry() const
+{
+    return QString("%1.%2>%3.%4").arg(d.sourceLabel, d.sourceTable,
+                                      ui_Target->currentText(), ui_TargetTable->text().trimmed());
+}
+
+/******************************************************************/
+
+QVariant CopyTableDlg::resumeKey() const
+{
+    const CopyTableDlgSettings S;
+    QSettings settings;
+    return settings.value(S.RESUME).toMap().value(resumeEntry());
+}
+
+/******************************************************************/
+
+void CopyTableDlg::saveResumeKey(const QVariant &key)
+{
+    const CopyTableDlgSettings S;
+    QSettings settings;
+    QVariantMap keys = settings.value(S.RESUME).toMap();
+    if (!key.isValid()) {
+        if (!keys.remove(resumeEntry())) return;
+    } else if (keys.value(resumeEntry()) == key) {
+        return;
+    } else {
+        keys.insert(resumeEntry(), key);
+    }
+    settings.setValue(S.RESUME, keys);
+}
+
+/******************************************************************/
+
+void CopyTableDlg::setupUI()
+{
+    ui_Target = new QComboBox(this);
+    ui_TargetTable = new QLineEdit(this);
+    ui_TargetTable->setToolTip(tr("A missing table is created with the source columns"));
+
+    auto formLayout = new QFormLayout();
+    formLayout->addRow(tr("Source:"), new QLabel(QString("%1 / %2").arg(d.sourceLabel, d.sourceTable), this));
+    formLayout->addRow(tr("Target:"), ui_Target);
+    formLayout->addRow(tr("Target table:"), ui_TargetTable);
+
+    ui_Columns = new QTableWidget(0, 4, this);
+    ui_Columns->setHorizontalHeaderLabels(QStringList() << tr("Field") << tr("Source type")
+                                          << tr("Target field") << tr("Target type"));
+    ui_Columns->verticalHeader()->hide();
+    ui_Columns->horizontalHeader()->setStretchLastSection(true);
+    ui_Columns->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    ui_Resume = new QCheckBox(tr("Resume"), this);
+    ui_Resume->setToolTip(tr("Copy only the rows above the last committed primary key"));
+    ui_Start = new QPushButton(tr("Copy"), this);
+    ui_Status = new QLabel(this);
+    ui_Status->setWordWrap(true);
+
+    auto toolLayout = new QHBoxLayout();
+    toolLayout->addWidget(ui_Resume);
+    toolLayout->addWidget(ui_Start);
+    toolLayout->addWidget(ui_Status, 1);
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+
+    auto mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(formLayout);
+    mainLayout->addWidget(ui_Columns, 1);
+    mainLayout->addLayout(toolLayout);
+    mainLayout->addWidget(buttonBox);
+
+    resize(700, 500);
+
+    connect(ui_Target, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &CopyTableDlg::prepareCopy);
+    connect(ui_TargetTable, &QLineEdit::editingFinished,
+            this, &CopyTableDlg::prepareCopy);
+    connect(ui_Start, &QPushButton::clicked, this, [this](){
+        if (d.progress) {
+            stop();
+        } else {
+            start();
+        }
+    });
+    connect(buttonBox, &QDialogButtonBox::rejected,
+            this, &CopyTableDlg::reject);
+}
+
+/******************************************************************/
@@ -0,0 +1,78 @@
+#ifndef COPYTABLEDLG_H
+#define COPYTABLEDLG_H
+
+#include "dbcopy.h"
+
+#include <QDialog>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QCheckBox;
+class QComboBox;
+class QLineEdit;
+class QPushButton;
+class QTableWidget;
+QT_END_NAMESPACE
+
+class CopyTableDlg : public QDialog
+{
+    Q_OBJECT
+
+    struct CopyTableDlgSettings {
+        const QString RESUME = "datacopy/resume";  ///< committed keys by source and target
+    };
+
+    struct CopyTableDlgPrivate {
+        QString     sourceLabel;
+        QString     sourceConnection;
+        QString     sourceTable;
+        DbTableCopy copy;
+        QSharedPointer<DbCopyProgress>  progress;
+        QFutureWatcher<DbCopyResult>    watcher;
+        QElapsedTimer elapsed;
+        QTimer        timer;
+        qint64        lastWritten = 0;  ///< rows at the last progress update
+        qint64        lastMs      = 0;
+    };
+
+public:
+    CopyTableDlg(const QString &sourceLabel, const QString &sourceConnection, const QString &table,
+                 QWidget *parent = nullptr);
+    ~CopyTableDlg();
+
+    /// a connection to copy to
+    void addTarget(const QString &label, const QString &connectionName);
+
+public Q_SLOTS:
+    void start();
+    void stop();
+
+protected:
+    void reject() override;
+
+private Q_SLOTS:
+    void prepareCopy();
+    void updateProgress();
+    void showResult();
+
+private:
+    void setupUI();
+    QString resumeEntry() const;
+    QVariant resumeKey() const;
+    void saveResumeKey(const QVariant &key);
+
+private:
+    QComboBox    *ui_Target;
+    QLineEdit    *ui_TargetTable;
+    QTableWidget *ui_Columns;
+    QCheckBox    *ui_Resume;
+    QPushButton  *ui_Start;
+    QLabel       *ui_Status;
+    CopyTableDlgPrivate d;
+};
+
+#endif // COPYTABLEDLG_H
@@ -0,0 +1,284 @@
+#include "DumpDlg.h"
+
+#include <QDir>
+#include <QSettings>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QCheckBox>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QSpinBox>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QToolButton>
+#include <QtWidgets/QListWidget>
+#include <QtWidgets/QTableWidget>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QFormLayout>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QVBoxLayout>
+#include <QtWidgets/QDialogButtonBox>
+
+enum {
+    ProgressMs = 500,
+    MaxThreads = 8   ///< default, more workers mostly wait on the server
+};
+
+/******************************************************************/
+
+DumpDlg::DumpDlg(const QString &connectionLabel, const QString &connectionName, QWidget *parent) :
+    QDialog(parent)
+{
+    d.connectionLabel = connectionLabel;
+    d.connectionName  = connectionName;
+    setWindowTitle(tr("Dump %1").arg(connectionLabel));
+    setupUI();
+
+    d.timer.setInterval(ProgressMs);
+    connect(&d.timer, &QTimer::timeout,
+            this, &DumpDlg::updateProgress);
+    connect(&d.watcher, &QFutureWatcher<QVector<DbDumpTable>>::finished,
+            this, &DumpDlg::showResult);
+}
+
+/******************************************************************/
+//! the worker only shares the progress, it finishes on its own
+DumpDlg::~DumpDlg()
+{
+    if (d.progress) {
+        d.progress->canceled.storeRelaxed(1);
+    }
+}
+
+/******************************************************************/
+
+void DumpDlg::addTable(const QString &table, bool checked)
+{
+    auto item = new QListWidgetItem(table, ui_Tables);
+    item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+    item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+}
+
+/******************************************************************/
+
+void DumpDlg::start()
+{
+    if (d.progress) return;
+
+    QStringList tables;
+    for (int i = 0; i < ui_Tables->count(); ++i) {
+        if (ui_Tables->item(i)->checkState() == Qt::Checked) {
+            tables << ui_Tables->item(i)->text();
+        }
+    }
+    const QString folder = ui_Folder->text().trimmed();
+    if (tables.isEmpty() || folder.isEmpty()) {
+        ui_Status->setText(tr("Check the tables and choose a folder."));
+        return;
+    }
+
+    const DumpDlgSettings S;
+    QSettings settings;
+    settings.setValue(S.FOLDER, folder);
+    settings.setValue(S.FORMAT, ui_Format->currentIndex());
+    settings.setValue(S.COMPRESS, ui_Compress->isChecked());
+    settings.setValue(S.THREADS, ui_Threads->value());
+
+    DbDump dump(d.connectionName, tables, folder);
+    dump.setLabel(d.connectionLabel);
+    dump.setFormat(DbDump::Format(ui_Format->currentData().toInt()));
+    dump.setCompressed(ui_Compress->isChecked());
+
+    d.tableCount = tables.size();
+    d.progress = QSharedPointer<DumpProgress>::create();
+    QSharedPointer<DumpProgress> progress = d.progress;
+    const int threads = ui_Threads->value();
+    d.watcher.setFuture(QtConcurrent::run([=](){
+        return dump.run(threads, &progress->canceled, &progress->rows, &progress->tables, &progress->error);
+    }));
+
+    d.elapsed.start();
+    d.timer.start();
+    ui_Result->setRowCount(0);
+    ui_Start->setText(tr("Stop"));
+    for (QWidget *widget : QList<QWidget*>() << ui_Tables << ui_Folder << ui_Format << ui_Compress << ui_Threads) {
+        widget->setEnabled(false);
+    }
+    updateProgress();
+}
+
+/******************************************************************/
+//! tables in progress stop at the next buffer, their files stay incomplete
+void DumpDlg::stop()
+{
+    if (d.progress) {
+        d.progress->canceled.storeRelaxed(1);
+    }
+}
+
+/******************************************************************/
+
+void DumpDlg::reject()
+{
+    stop();
+    QDialog::reject();
+}
+
+/******************************************************************/
+
+void DumpDlg::browseFolder()
+{
+    const QString folder = QFileDialog::getExistingDirectory(this, tr("Choose a dump folder"), ui_Folder->text());
+    if (!folder.isEmpty()) {
+        ui_Folder->setText(QDir::toNativeSeparators(folder));
+    }
+}
+
+/******************************************************************/
+
+void DumpDlg::updateProgress()
+{
+    if (!d.progress) return;
+
+    const qint64 rows = d.progress->rows.loadRelaxed();
+    const qint64 ms = qMax<qint64>(1, d.elapsed.elapsed());
+    ui_Status->setText(tr("%1 of %2 tables, %3 rows, %4 rows/s")
+                       .arg(d.progress->tables.loadRelaxed())
+                       .arg(d.tableCount)
+                       .arg(rows)
+                       .arg(qRound64(rows * 1000.0 / ms)));
+}
+
+/******************************************************************/
+
+void DumpDlg::showResult()
+{
+    d.timer.stop();
+    const QVector<DbDumpTable> tables = d.watcher.result();
+    const QString error = d.progress->error;
+    d.progress.reset();
+    ui_Start->setText(tr("Dump"));
+    for (QWidget *widget : QList<QWidget*>() << ui_Tables << ui_Folder << ui_Format << ui_Compress << ui_Threads) {
+        widget->setEnabled(true);
+    }
+
+    qint64 rows = 0;
+    int failed = 0;
+    ui_Result->setRowCount(tables.size());
+    for (int i = 0; i < tables.size(); ++i) {
+        const DbDumpTable &table = tables.at(i);
+        rows += table.rows;
+        if (!table.error.isEmpty()) ++failed;
+
+        auto rowsItem = new QTableWidgetItem();
+        rowsItem->setData(Qt::DisplayRole, table.rows);
+        auto estimateItem = new QTableWidgetItem(table.estimate < 0 ? QString() : QString::number(table.estimate));
+        estimateItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        auto bytesItem = new QTableWidgetItem();
+        bytesItem->setData(Qt::DisplayRole, table.bytes);
+        auto errorItem = new QTableWidgetItem(table.error);
+        errorItem->setForeground(Qt::red);
+
+        ui_Result->setItem(i, 0, new QTableWidgetItem(table.table));
+        ui_Result->setItem(i, 1, estimateItem);
+        ui_Result->setItem(i, 2, rowsItem);
+        ui_Result->setItem(i, 3, bytesItem);
+        ui_Result->setItem(i, 4, new QTableWidgetItem(table.file));
+        ui_Result->setItem(i, 5, errorItem);
+    }
+    ui_Result->resizeColumnsToContents();
+
+    QString status = tr("%1 tables, %2 rows in %3 s")
+            .arg(tables.size() - failed)
+            .arg(rows)
+            .arg(d.elapsed.elapsed() / 1000.0, 0, 'f', 1);
+    if (failed) {
+        status += tr(", %1 failed").arg(failed);
+    }
+    if (!error.isEmpty()) {
+        status += "\n" + error;
+    }
+    ui_Status->setText(status);
+}
+
+/******************************************************************/
+
+void DumpDlg::setupUI()
+{
+    const DumpDlgSettings S;
+    QSettings settings;
+
+    ui_Tables = new QListWidget(this);
+
+    ui_Folder = new QLineEdit(settings.value(S.FOLDER).toString(), this);
+    auto browseButton = new QToolButton(this);
+    browseButton->setText("...");
+    auto folderLayout = new QHBoxLayout();
+    folderLayout->addWidget(ui_Folder, 1);
+    folderLayout->addWidget(browseButton);
+
+    ui_Format = new QComboBox(this);
+    ui_Format->addItem(tr("CSV"), DbDump::Csv);
+    ui_Format->addItem(tr("NDJSON"), DbDump::NdJson);
+    ui_Format->addItem(tr("SQL INSERT"), DbDump::SqlInsert);
+    ui_Format->setCurrentIndex(qBound(0, settings.value(S.FORMAT, 0).toInt(), ui_Format->count() - 1));
+
+    ui_Compress = new QCheckBox(tr("gzip"), this);
+    ui_Compress->setChecked(settings.value(S.COMPRESS, true).toBool());
+
+    ui_Threads = new QSpinBox(this);
+    ui_Threads->setRange(1, 32);
+    ui_Threads->setValue(settings.value(S.THREADS, qBound(1, QThread::idealThreadCount(), int(MaxThreads))).toInt());
+    ui_Threads->setToolTip(tr("Every thread opens its own connection"));
+
+    auto formLayout = new QFormLayout();
+    formLayout->addRow(tr("Folder:"), folderLayout);
+    formLayout->addRow(tr("Format:"), ui_Format);
+    formLayout->addRow(tr("Compress:"), ui_Compress);
+    formLayout->addRow(tr("Threads:"), ui_Threads);
+
+    auto topLayout = new QHBoxLayout();
+    topLayout->addWidget(ui_Tables, 1);
+    topLayout->addLayout(formLayout, 1);
+
+    ui_Start = new QPushButton(tr("Dump"), this);
+    ui_Status = new QLabel(this);
+    ui_Status->setWordWrap(true);
+
+    auto toolLayout = new QHBoxLayout();
+    toolLayout->addWidget(ui_Start);
+    toolLayout->addWidget(ui_Status, 1);
+
+    ui_Result = new QTableWidget(0, 6, this);
+    ui_Result->setHorizontalHeaderLabels(QStringList() << tr("Table") << tr("Estimate") << tr("Rows")
+                                         << tr("Bytes") << tr("File") << tr("Error"));
+    ui_Result->verticalHeader()->hide();
+    ui_Result->horizontalHeader()->setStretchLastSection(true);
+    ui_Result->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+
+    auto mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(topLayout);
+    mainLayout->addLayout(toolLayout);
+    mainLayout->addWidget(ui_Result, 1);
+    mainLayout->addWidget(buttonBox);
+
+    resize(700, 550);
+
+    connect(browseButton, &QToolButton::clicked,
+            this, &DumpDlg::browseFolder);
+    connect(ui_Start, &QPushButton::clicked, this, [this](){
+        if (d.progress) {
+            stop();
+        } else {
+            start();
+        }
+    });
+    connect(buttonBox, &QDialogButtonBox::rejected,
+            this, &DumpDlg::reject);
+}
+
+/******************************************************************/
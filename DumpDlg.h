@@ -0,0 +1,85 @@
+#ifndef DUMPDLG_H
+#define DUMPDLG_H
+
+#include "dbdump.h"
+
+#include <QDialog>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QCheckBox;
+class QComboBox;
+class QLineEdit;
+class QSpinBox;
+class QPushButton;
+class QListWidget;
+class QTableWidget;
+QT_END_NAMESPACE
+
+class DumpDlg : public QDialog
+{
+    Q_OBJECT
+
+    struct DumpDlgSettings {
+        const QString FOLDER   = "dump/folder";
+        const QString FORMAT   = "dump/format";
+        const QString COMPRESS = "dump/compress";
+        const QString THREADS  = "dump/threads";
+    };
+
+    struct DumpProgress {
+        QAtomicInt              canceled;
+        QAtomicInteger<qint64>  rows;
+        QAtomicInt              tables;
+        QString                 error;  ///< written by the worker, read when it finished
+    };
+
+    struct DumpDlgPrivate {
+        QString connectionLabel;
+        QString connectionName;
+        int     tableCount = 0;  ///< of the running dump
+        QSharedPointer<DumpProgress>          progress;
+        QFutureWatcher<QVector<DbDumpTable>>  watcher;
+        QElapsedTimer elapsed;
+        QTimer        timer;
+    };
+
+public:
+    DumpDlg(const QString &connectionLabel, const QString &connectionName, QWidget *parent = nullptr);
+    ~DumpDlg();
+
+    /// a table to offer, views are listed unchecked
+    void addTable(const QString &table, bool checked);
+
+public Q_SLOTS:
+    void start();
+    void stop();
+
+protected:
+    void reject() override;
+
+private Q_SLOTS:
+    void browseFolder();
+    void updateProgress();
+    void showResult();
+
+private:
+    void setupUI();
+
+private:
+    QListWidget  *ui_Tables;
+    QLineEdit    *ui_Folder;
+    QComboBox    *ui_Format;
+    QCheckBox    *ui_Compress;
+    QSpinBox     *ui_Threads;
+    QPushButton  *ui_Start;
+    QLabel       *ui_Status;
+    QTableWidget *ui_Result;
+    DumpDlgPrivate d;
+};
+
+#endif // DUMPDLG_H
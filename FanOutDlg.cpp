@@ -0,0 +1,276 @@
+#include "FanOutDlg.h"
+
+#include <QSettings>
+#include <QtConcurrent>
+
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QCheckBox>
+#include <QtWidgets/QSpinBox>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QListWidget>
+#include <QtWidgets/QTableView>
+#include <QtWidgets/QTableWidget>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QSplitter>
+#include <QtWidgets/QFormLayout>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QVBoxLayout>
+#include <QtWidgets/QDialogButtonBox>
+
+enum {
+    ProgressMs = 250
+};
+
+/******************************************************************/
+
+FanOutDlg::FanOutDlg(const QString &sql, const QVariantMap &bindings, QWidget *parent) :
+    QDialog(parent)
+{
+    const FanOutDlgSettings S;
+    QSettings settings;
+    d.sql            = sql;
+    d.bindings       = bindings;
+    d.checkedTargets = settings.value(S.TARGETS).toStringList();
+    setWindowTitle(tr("Run on Connections"));
+    setupUI();
+
+    d.timer.setInterval(ProgressMs);
+    connect(&d.timer, &QTimer::timeout,
+            this, &FanOutDlg::updateProgress);
+    connect(&d.watcher, &QFutureWatcher<DbFanOutResult>::finished,
+            this, &FanOutDlg::showResult);
+}
+
+/******************************************************************/
+//! the worker only shares the progress, it finishes on its own
+FanOutDlg::~FanOutDlg()
+{
+    if (d.progress) {
+        d.progress->canceled.storeRelaxed(1);
+    }
+}
+
+/******************************************************************/
+
+void FanOutDlg::addTarget(const QString &label, const QString &connectionName)
+{
+    auto item = new QListWidgetItem(label, ui_Targets);
+    item->setData(Qt::UserRole, connectionName);
+    item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+    item->setCheckState(d.checkedTargets.contains(label) ? Qt::Checked : Qt::Unchecked);
+}
+
+/******************************************************************/
+
+void FanOutDlg::start()
+{
+    if (d.progress) return;
+
+    DbFanOut fanOut(d.sql, d.bindings);
+    fanOut.setParallelism(ui_Parallelism->value());
+    fanOut.setOrderedMerge(ui_Merge->isChecked());
+    QStringList labels;
+    for (int i = 0; i < ui_Targets->count(); ++i) {
+        const QListWidgetItem *item = ui_Targets->item(i);
+        if (item->checkState() == Qt::Checked) {
+            fanOut.addTarget(item->text(), item->data(Qt::UserRole).toString());
+            labels << item->text();
+        }
+    }
+    if (labels.isEmpty()) {
+        ui_Status->setText(tr("Check the connections to run the query on."));
+        return;
+    }
+
+    const FanOutDlgSettings S;
+    QSettings settings;
+    settings.setValue(S.TARGETS, labels);
+    settings.setValue(S.PARALLELISM, ui_Parallelism->value());
+    settings.setValue(S.MERGE, ui_Merge->isChecked());
+
+    d.shardCount = labels.size();
+    d.progress = QSharedPointer<FanOutProgress>::create();
+    QSharedPointer<FanOutProgress> progress = d.progress;
+    d.watcher.setFuture(QtConcurrent::run([=](){
+        return fanOut.run(&progress->canceled, &progress->shards, &progress->rows);
+    }));
+
+    d.model.clear();
+    ui_Shards->setRowCount(0);
+    d.elapsed.start();
+    d.timer.start();
+    ui_Start->setText(tr("Stop"));
+    for (QWidget *widget : QList<QWidget*>() << ui_Targets << ui_Parallelism << ui_Merge) {
+        widget->setEnabled(false);
+    }
+    updateProgress();
+}
+
+/******************************************************************/
+//! running queries stop at the next batch, the rows read so far are shown
+void FanOutDlg::stop()
+{
+    if (d.progress) {
+        d.progress->canceled.storeRelaxed(1);
+    }
+}
+
+/******************************************************************/
+
+void FanOutDlg::reject()
+{
+    stop();
+    QDialog::reject();
+}
+
+/******************************************************************/
+
+void FanOutDlg::updateProgress()
+{
+    if (!d.progress) return;
+    ui_Status->setText(tr("%1 of %2 connections finished, %3 rows in %4 s")
+                       .arg(d.progress->shards.loadRelaxed())
+                       .arg(d.shardCount)
+                       .arg(d.progress->rows.loadRelaxed())
+                       .arg(d.elapsed.elapsed() / 1000.0, 0, 'f', 1));
+}
+
+/******************************************************************/
+
+void FanOutDlg::showResult()
+{
+    d.timer.stop();
+    const bool canceled = d.progress->canceled.loadRelaxed();
+    d.progress.reset();
+    ui_Start->setText(tr("Run"));
+    for (QWidget *widget : QList<QWidget*>() << ui_Targets << ui_Parallelism << ui_Merge) {
+        widget->setEnabled(true);
+    }
+
+    const DbFanOutResult result = d.watcher.result();
+    d.model.setResult(result);
+    ui_Rows->resizeColumnsToContents();
+
+    int failed = 0;
+    ui_Shards->setRowCount(result.shardResults.size());
+    for (int i = 0; i < result.shardResults.size(); ++i) {
+        const DbShardResult &shard = result.shardResults.at(i);
+        if (!shard.error.isEmpty()) ++failed;
+
+        auto latencyItem = new QTableWidgetItem();
+        auto totalItem = new QTableWidgetItem();
+        if (shard.latencyMs >= 0) {
+            latencyItem->setData(Qt::DisplayRole, shard.latencyMs);
+        }
+        if (shard.totalMs >= 0) {
+            totalItem->setData(Qt::DisplayRole, shard.totalMs);
+        }
+        auto rowsItem = new QTableWidgetItem();
+        rowsItem->setData(Qt::DisplayRole, shard.rows);
+        auto errorItem = new QTableWidgetItem(shard.error);
+        errorItem->setForeground(Qt::red);
+        errorItem->setToolTip(shard.error);
+
+        ui_Shards->setItem(i, 0, new QTableWidgetItem(shard.label));
+        ui_Shards->setItem(i, 1, latencyItem);
+        ui_Shards->setItem(i, 2, totalItem);
+        ui_Shards->setItem(i, 3, rowsItem);
+        ui_Shards->setItem(i, 4, errorItem);
+    }
+    ui_Shards->resizeColumnsToContents();
+
+    QString status = tr("%1 rows from %2 connections in %3 s")
+            .arg(result.rows.size())
+            .arg(result.shardResults.size() - failed)
+            .arg(d.elapsed.elapsed() / 1000.0, 0, 'f', 1);
+    if (failed) {
+        status += tr(", %1 failed").arg(failed);
+    }
+    if (result.merged) {
+        status += tr(", merged in ORDER BY order");
+    }
+    if (result.truncated) {
+        status += tr(", limited to %1 rows").arg(int(DbFanOut::MaxRows));
+    }
+    if (canceled) {
+        status += tr(", stopped");
+    }
+    if (!result.note.isEmpty()) {
+        status += "\n" + result.note;
+    }
+    ui_Status->setText(status);
+}
+
+/******************************************************************/
+
+void FanOutDlg::setupUI()
+{
+    const FanOutDlgSettings S;
+    QSettings settings;
+
+    ui_Targets = new QListWidget(this);
+
+    ui_Parallelism = new QSpinBox(this);
+    ui_Parallelism->setRange(1, 64);
+    ui_Parallelism->setValue(settings.value(S.PARALLELISM, 8).toInt());
+    ui_Parallelism->setToolTip(tr("Queries executed at the same time"));
+
+    ui_Merge = new QCheckBox(tr("Merge by ORDER BY"), this);
+    ui_Merge->setChecked(settings.value(S.MERGE, false).toBool());
+    ui_Merge->setToolTip(tr("Combine the sorted rows of all connections by the ORDER BY columns of the query"));
+
+    auto formLayout = new QFormLayout();
+    formLayout->addRow(tr("Parallel:"), ui_Parallelism);
+    formLayout->addRow(QString(), ui_Merge);
+
+    auto topLayout = new QHBoxLayout();
+    topLayout->addWidget(ui_Targets, 1);
+    topLayout->addLayout(formLayout, 1);
+
+    ui_Start = new QPushButton(tr("Run"), this);
+    ui_Status = new QLabel(this);
+    ui_Status->setWordWrap(true);
+
+    auto toolLayout = new QHBoxLayout();
+    toolLayout->addWidget(ui_Start);
+    toolLayout->addWidget(ui_Status, 1);
+
+    ui_Rows = new QTableView(this);
+    ui_Rows->setModel(&d.model);
+    ui_Rows->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    ui_Shards = new QTableWidget(0, 5, this);
+    ui_Shards->setHorizontalHeaderLabels(QStringList() << tr("Connection") << tr("Latency ms")
+                                         << tr("Total ms") << tr("Rows") << tr("Error"));
+    ui_Shards->verticalHeader()->hide();
+    ui_Shards->horizontalHeader()->setStretchLastSection(true);
+    ui_Shards->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    auto splitter = new QSplitter(Qt::Vertical, this);
+    splitter->addWidget(ui_Rows);
+    splitter->addWidget(ui_Shards);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 1);
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+
+    auto mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(topLayout);
+    mainLayout->addLayout(toolLayout);
+    mainLayout->addWidget(splitter, 1);
+    mainLayout->addWidget(buttonBox);
+
+    resize(900, 650);
+
+    connect(ui_Start, &QPushButton::clicked, this, [this](){
+        if (d.progress) {
+            stop();
+        } else {
+            start();
+        }
+    });
+    connect(buttonBox, &QDialogButtonBox::rejected,
+            this, &FanOutDlg::reject);
+}
+
+/******************************************************************/
@@ -0,0 +1,82 @@
+#ifndef FANOUTDLG_H
+#define FANOUTDLG_H
+
+#include "dbfanoutmodel.h"
+
+#include <QDialog>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QCheckBox;
+class QSpinBox;
+class QPushButton;
+class QListWidget;
+class QTableView;
+class QTableWidget;
+QT_END_NAMESPACE
+
+class FanOutDlg : public QDialog
+{
+    Q_OBJECT
+
+    struct FanOutDlgSettings {
+        const QString TARGETS     = "fanout/targets";  ///< labels of the connections checked last
+        const QString PARALLELISM = "fanout/parallelism";
+        const QString MERGE       = "fanout/merge";
+    };
+
+    struct FanOutProgress {
+        QAtomicInt              canceled;
+        QAtomicInt              shards;
+        QAtomicInteger<qint64>  rows;
+    };
+
+    struct FanOutDlgPrivate {
+        QString     sql;
+        QVariantMap bindings;
+        QStringList checkedTargets;
+        int         shardCount = 0;  ///< of the running query
+        DbFanOutModel model;
+        QSharedPointer<FanOutProgress>  progress;
+        QFutureWatcher<DbFanOutResult>  watcher;
+        QElapsedTimer elapsed;
+        QTimer        timer;
+    };
+
+public:
+    FanOutDlg(const QString &sql, const QVariantMap &bindings, QWidget *parent = nullptr);
+    ~FanOutDlg();
+
+    /// a connection to run the query on, checked if it was checked last time
+    void addTarget(const QString &label, const QString &connectionName);
+
+public Q_SLOTS:
+    void start();
+    void stop();
+
+protected:
+    void reject() override;
+
+private Q_SLOTS:
+    void updateProgress();
+    void showResult();
+
+private:
+    void setupUI();
+
+private:
+    QListWidget  *ui_Targets;
+    QSpinBox     *ui_Parallelism;
+    QCheckBox    *ui_Merge;
+    QPushButton  *ui_Start;
+    QLabel       *ui_Status;
+    QTableView   *ui_Rows;
+    QTableWidget *ui_Shards;
+    FanOutDlgPrivate d;
+};
+
+#endif // FANOUTDLG_H
@@ -0,0 +1,324 @@
+#include "HistoryWidget.h"
+
+#include "dbhistory.h"
+
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QToolButton>
+#include <QTableView>
+#include <QHeaderView>
+#include <QSplitter>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <QSqlQuery>
+#include <QSqlRecord>
+
+#include <algorithm>
+#include <cmath>
+
+enum {
+    GroupFingerprintColumn,
+    GroupRunsColumn,
+    GroupLastRunColumn,
+    GroupP50Column,
+    GroupP95Column,
+    GroupRecentP95Column,
+    GroupPreviousP95Column,
+    GroupChangeColumn
+};
+
+enum {
+    TrendWindowDays = 7,
+    MaxEntries      = 5000
+};
+
+/******************************************************************/
+
+HistoryWidget::HistoryWidget(DbHistory *history, QWidget *parent) :
+    QWidget(parent)
+{
+    d.history = history;
+    setupUI();
+}
+
+/******************************************************************/
+
+void HistoryWidget::refresh()
+{
+    if (!d.history || !d.history->isOpen()) return;
+
+    if (ui_Group->isChecked()) {
+        loadGroups();
+    } else {
+        loadEntries();
+    }
+}
+
+/******************************************************************/
+
+void HistoryWidget::activateRow(const QModelIndex &index)
+{
+    if (!index.isValid()) return;
+
+    if (ui_Group->isChecked()) {
+        emit openQuery(d.groupConnection.value(index.row()),
+                       d.groupSql.value(index.row()),
+                       QVariantMap());
+        return;
+    }
+
+    const QSqlRecord rec = d.entriesModel.record(index.row());
+    const QJsonDocument binds = QJsonDocument::fromJson(rec.value("binds").toString().toUtf8());
+    emit openQuery(rec.value("connection").toString(),
+                   rec.value("sql").toString(),
+                   binds.object().toVariantMap());
+}
+
+/******************************************************************/
+//! shows daily p50/p95 of the selected fingerprint
+void HistoryWidget::updateTrend()
+{
+    d.trendModel.clear();
+
+    const QModelIndex current = ui_Table->currentIndex();
+    if (!ui_Group->isChecked() || !current.isValid()) return;
+
+    const QString fingerprint = d.groupModel.row(current.row()).value(GroupFingerprintColumn).toString();
+
+    QSqlQuery query(d.history->database());
+    query.setForwardOnly(true);
+    query.prepare("SELECT substr(executed, 1, 10), prepare_us + exec_us + fetch_us"
+                  " FROM history"
+                  " WHERE fingerprint = ? AND (error IS NULL OR error = '')"
+                  " ORDER BY executed");
+    query.addBindValue(fingerprint);
+    if (!query.exec()) return;
+
+    QVector<DbResultModel::Row> rows;
+    QString day;
+    QVector<qint64> values;
+    auto flush = [&rows, &day, &values]() {
+        if (values.isEmpty()) return;
+        std::sort(values.begin(), values.end());
+        rows << (DbResultModel::Row() << day << values.size()
+                 << percentile(values, 0.5) << percentile(values, 0.95));
+        values.clear();
+    };
+    while (query.next()) {
+        const QString rowDay = query.value(0).toString();
+        if (rowDay != day) {
+            flush();
+            day = rowDay;
+        }
+        values << query.value(1).toLongLong();
+    }
+    flush();
+
+    d.trendModel.setFields(QStringList() << tr("Day") << tr("Runs") << tr("p50 ms") << tr("p95 ms"));
+    d.trendModel.appendRows(rows);
+    ui_Trend->resizeColumnsToContents();
+}
+
+/******************************************************************/
+
+void HistoryWidget::setupUI()
+{
+    ui_Search = new QLineEdit(this);
+    ui_Search->setPlaceholderText(tr("Search SQL or connection"));
+    ui_Search->setClearButtonEnabled(true);
+
+    ui_Group = new QCheckBox(tr("Group by fingerprint"), this);
+
+    auto refreshButton = new QToolButton(this);
+    refreshButton->setIcon(QIcon::fromTheme("view-refresh", QIcon(":/img/refresh.png")));
+    refreshButton->setToolTip(tr("Refresh"));
+
+    auto toolLayout = new QHBoxLayout();
+    toolLayout->addWidget(ui_Search);
+    toolLayout->addWidget(ui_Group);
+    toolLayout->addWidget(refreshButton);
+
+    ui_Table = new QTableView(this);
+    ui_Table->setAlternatingRowColors(true);
+    ui_Table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui_Table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui_Table->setToolTip(tr("Double click to open the query"));
+
+    ui_Trend = new QTableView(this);
+    ui_Trend->setModel(&d.trendModel);
+    ui_Trend->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui_Trend->verticalHeader()->hide();
+    ui_Trend->hide();
+
+    auto splitter = new QSplitter(Qt::Vertical, this);
+    splitter->addWidget(ui_Table);
+    splitter->addWidget(ui_Trend);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 1);
+
+    auto mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(toolLayout);
+    mainLayout->addWidget(splitter);
+
+    connect(ui_Search, &QLineEdit::returnPressed,
+            this, &HistoryWidget::refresh);
+    connect(refreshButton, &QToolButton::clicked,
+            this, &HistoryWidget::refresh);
+    connect(ui_Group, &QCheckBox::toggled, this, [this](bool checked){
+        ui_Trend->setVisible(checked);
+        refresh();
+    });
+    connect(ui_Table, &QTableView::doubleClicked,
+            this, &HistoryWidget::activateRow);
+}
+
+/******************************************************************/
+
+void HistoryWidget::loadEntries()
+{
+    const QString search = "%" + ui_Search->text() + "%";
+
+    QSqlQuery query(d.history->database());
+    query.prepare("SELECT id, executed, connection, sql,"
+                  " (prepare_us + exec_us + fetch_us) / 1000.0 AS total_ms,"
+                  " prepare_us / 1000.0 AS prepare_ms,"
+                  " exec_us / 1000.0 AS exec_ms,"
+                  " fetch_us / 1000.0 AS fetch_ms,"
+                  " rows, affected, bytes, error, fingerprint, binds"
+                  " FROM history"
+                  " WHERE sql LIKE ? OR connection LIKE ?"
+                  " ORDER BY id DESC LIMIT " + QString::number(MaxEntries));
+    query.addBindValue(search);
+    query.addBindValue(search);
+    query.exec();
+
+    d.entriesModel.setQuery(query);
+    ui_Table->setModel(&d.entriesModel);
+    ui_Table->hideColumn(0);
+    ui_Table->resizeColumnsToContents();
+    ui_Table->setColumnWidth(d.entriesModel.record().indexOf("sql"), 400);
+}
+
+/******************************************************************/
+//! aggregates latencies per fingerprint, compares p95 of the last week with the week before
+void HistoryWidget::loadGroups()
+{
+    struct Group {
+        DbResultModel::Row row;
+        QString lastRun;
+        QString sql;
+        QString connection;
+    };
+
+    const QString search = "%" + ui_Search->text() + "%";
+    const QDateTime now = QDateTime::currentDateTime();
+    const QString format("yyyy-MM-ddThh:mm:ss.zzz");
+    const QString recentFrom   = now.addDays(-TrendWindowDays).toString(format);
+    const QString previousFrom = now.addDays(-2 * TrendWindowDays).toString(format);
+
+    QSqlQuery query(d.history->database());
+    query.setForwardOnly(true);
+    query.prepare("SELECT fingerprint, executed, prepare_us + exec_us + fetch_us, sql, connection"
+                  " FROM history"
+                  " WHERE (error IS NULL OR error = '') AND (sql LIKE ? OR connection LIKE ?)"
+                  " ORDER BY fingerprint, executed");
+    query.addBindValue(search);
+    query.addBindValue(search);
+    query.exec();
+
+    QVector<Group> groups;
+    Group group;
+    QVector<qint64> all, recent, previous;
+    auto flush = [&]() {
+        if (all.isEmpty()) return;
+        std::sort(all.begin(), all.end());
+        std::sort(recent.begin(), recent.end());
+        std::sort(previous.begin(), previous.end());
+
+        QVariant recentP95, previousP95, change;
+        if (!recent.isEmpty()) recentP95 = percentile(recent, 0.95);
+        if (!previous.isEmpty()) previousP95 = percentile(previous, 0.95);
+        if (!recent.isEmpty() && !previous.isEmpty() && previousP95.toDouble() > 0) {
+            const double pct = (recentP95.toDouble() - previousP95.toDouble()) * 100.0 / previousP95.toDouble();
+            change = std::round(pct * 10.0) / 10.0;
+        }
+
+        group.row << all.size() << group.lastRun
+                  << percentile(all, 0.5) << percentile(all, 0.95)
+                  << recentP95 << previousP95 << change;
+        groups << group;
+        all.clear();
+        recent.clear();
+        previous.clear();
+    };
+
+    while (query.next()) {
+        const QString fingerprint = query.value(0).toString();
+        if (group.row.isEmpty() || group.row.first().toString() != fingerprint) {
+            flush();
+            group = Group();
+            group.row << fingerprint;
+        }
+        const QString executed = query.value(1).toString();
+        const qint64 latency = query.value(2).toLongLong();
+        all << latency;
+        if (executed >= recentFrom) {
+            recent << latency;
+        } else if (executed >= previousFrom) {
+            previous << latency;
+        }
+        group.lastRun    = executed;
+        group.sql        = query.value(3).toString();
+        group.connection = query.value(4).toString();
+    }
+    flush();
+
+    std::sort(groups.begin(), groups.end(), [](const Group &a, const Group &b) {
+        return a.lastRun > b.lastRun;
+    });
+
+    QVector<DbResultModel::Row> rows;
+    d.groupSql.clear();
+    d.groupConnection.clear();
+    for (const auto &g : qAsConst(groups)) {
+        rows << g.row;
+        d.groupSql << g.sql;
+        d.groupConnection << g.connection;
+    }
+
+    d.groupModel.setFields(QStringList()
+                           << tr("Fingerprint")
+                           << tr("Runs")
+                           << tr("Last run")
+                           << tr("p50 ms")
+                           << tr("p95 ms")
+                           << tr("p95 ms (%1 days)").arg(int(TrendWindowDays))
+                           << tr("p95 ms (previous %1 days)").arg(int(TrendWindowDays))
+                           << tr("Change %"));
+    d.groupModel.appendRows(rows);
+
+    ui_Table->setModel(&d.groupModel);
+    ui_Table->showColumn(0);
+    ui_Table->resizeColumnsToContents();
+    ui_Table->setColumnWidth(GroupFingerprintColumn, 400);
+    // the view keeps its selection model while the group model is shown again
+    connect(ui_Table->selectionModel(), &QItemSelectionModel::currentRowChanged,
+            this, &HistoryWidget::updateTrend, Qt::UniqueConnection);
+    updateTrend();
+}
+
+/******************************************************************/
+//! nearest-rank percentile of sorted microseconds in milliseconds
+double HistoryWidget::percentile(const QVector<qint64> &sorted, double p)
+{
+    if (sorted.isEmpty()) return 0;
+    int idx = int(std::ceil(p * sorted.size())) - 1;
+    idx = qBound(0, idx, sorted.size() - 1);
+    return std::round(sorted.at(idx) / 10.0) / 100.0;
+}
+
+/******************************************************************/
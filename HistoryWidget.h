@@ -0,0 +1,59 @@
+#ifndef HISTORYWIDGET_H
+#define HISTORYWIDGET_H
+
+#include "dbresultmodel.h"
+
+#include <QWidget>
+#include <QSqlQueryModel>
+
+QT_BEGIN_NAMESPACE
+class QLineEdit;
+class QCheckBox;
+class QTableView;
+QT_END_NAMESPACE
+
+class DbHistory;
+
+class HistoryWidget : public QWidget
+{
+    Q_OBJECT
+
+    struct HistoryWidgetPrivate {
+        DbHistory     *history = Q_NULLPTR;
+        QSqlQueryModel entriesModel;
+        DbResultModel  groupModel;
+        DbResultModel  trendModel;
+        QStringList    groupSql;       ///< latest SQL of every fingerprint
+        QStringList    groupConnection;  ///< latest connection of every fingerprint
+    };
+
+public:
+    explicit HistoryWidget(DbHistory *history, QWidget *parent = nullptr);
+
+public Q_SLOTS:
+    void refresh();
+
+Q_SIGNALS:
+    void openQuery(const QString &connection, const QString &sql, const QVariantMap &binds);
+
+private Q_SLOTS:
+    void activateRow(const QModelIndex &index);
+    void updateTrend();
+
+private:
+    void setupUI();
+    void loadEntries();
+    void loadGroups();
+
+private: // static
+    static double percentile(const QVector<qint64> &sorted, double p);
+
+private:
+    QLineEdit  *ui_Search;
+    QCheckBox  *ui_Group;
+    QTableView *ui_Table;
+    QTableView *ui_Trend;
+    HistoryWidgetPrivate d;
+};
+
+#endif // HISTORYWIDGET_H
@@ -5,16 +5,36 @@
 
 #include "simplereportwidget.h"
 #include "ConnectionDlg.h"
+#include "CopyTableDlg.h"
+#include "DumpDlg.h"
+#include "FanOutDlg.h"
 #include "QueryParamDlg.h"
+#include "BatchParamDlg.h"
 #include "TableHeadersDlg.h"
+#include "HistoryWidget.h"
+#include "PlanWidget.h"
+#include "PasteRowsDlg.h"
+#include "ProfileDlg.h"
+#include "TableDiffDlg.h"
+#include "ValueViewerDlg.h"
+#include "xfilterrow.h"
+#include "xfindbar.h"
+#include "xformatdelegate.h"
+#include "xtablemimedata.h"
+#include "xtablesizer.h"
 
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QTextStream>
 #include <QProcess>
+#include <QInputDialog>
+#include <QElapsedTimer>
+#include <QProgressDialog>
+#include <QScrollBar>
 
 #include <QSqlRecord>
 #include <QSqlField>
+#include <QSqlDriver>
 
 #include <QTextTable>
 #include <QTextDocument>
@@ -27,11 +47,15 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 enum {
     DataTab,
     SchemaTab,
     QueryTab,
-    SimpleReportTab
+    SimpleReportTab,
+    PlanTab,
+    HistoryTab
 };
 
 /******************************************************************/
@@ -50,6 +74,8 @@ MainWindow::MainWindow()
 
 MainWindow::~MainWindow()
 {
+    // a result still being fetched is recorded in the history
+    d.resultmodel.clear();
     delete ui;
 }
 
@@ -145,22 +171,30 @@ void MainWindow::changeCurrentTable(const QModelIndex &index)
 
     if (!dbt) return;
 
+    ui->tailDataButton->setChecked(false);
+
     if (d.datatablemodel) {
+        // pending clipboard data takes the copied cells first
+        d.datatablemodel->clear();
         d.datatablemodel->deleteLater();
     }
 
-    d.datatablemodel = new QSqlTableModel(this, dbt->dbconn->db);
+    d.datatablemodel = new DbTableModel(this, dbt->dbconn->db);
     d.datatablemodel->setTable(dbt->tablename);
 
     ui->dataTable->setModel(d.datatablemodel);
+    connect(ui->dataTable->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &MainWindow::updateSelectionStats);
+    d.datafilter->rebuild();
+    ui->filterInfoLabel->clear();
     d.schemamodel.setRecord(dbt->dbconn->db.driverName(), d.datatablemodel->record(), d.datatablemodel->primaryKey());
 
     d.datatablemodel->setEditStrategy(QSqlTableModel::OnManualSubmit);
     d.datatablemodel->select();
     d.datatablemodel_lastsort = -1;
 
-    ui->dataTable->resizeColumnsToContents();
-    ui->dataTable->resizeRowsToContents();
+    setColumnFormatters(ui->dataTable, d.datatablemodel->record());
+    XTableSizer::resize(ui->dataTable, fieldLengths(d.datatablemodel->record()));
 }
 
 /******************************************************************/
@@ -169,17 +203,89 @@ void MainWindow::showTreeDbListContextMenu(const QPoint &position)
 {
     QMenu contextmenu(this);
 
+    QAction *compareAction = Q_NULLPTR;
+    QAction *copyAction = Q_NULLPTR;
+    QAction *dumpAction = Q_NULLPTR;
     QModelIndex index = ui->treeDbList->indexAt(position);
     if (index.isValid()) {
         contextmenu.addAction(ui->action_EditConnection);
         contextmenu.addAction(ui->action_RemoveConnection);
+        if (d.dblist.getDbTable(index)) {
+            compareAction = contextmenu.addAction(tr("Compare Table..."));
+            copyAction = contextmenu.addAction(QIcon::fromTheme("edit-copy"), tr("Copy Table..."));
+        } else {
+            dumpAction = contextmenu.addAction(QIcon::fromTheme("document-save-as"), tr("Dump Tables..."));
+        }
         contextmenu.addSeparator();
     }
 
     contextmenu.addAction(ui->action_AddConnection);
     contextmenu.addAction(ui->action_RefreshTablelist);
 
-    contextmenu.exec(ui->treeDbList->mapToGlobal(position));
+    QAction *action = contextmenu.exec(ui->treeDbList->mapToGlobal(position));
+    if (!action) return;
+    if (action == compareAction) {
+        compareTable(index);
+    } else if (action == copyAction) {
+        copyTable(index);
+    } else if (action == dumpAction) {
+        dumpConnection(index);
+    }
+}
+
+/******************************************************************/
+//! compares the table with a table of the same name on another connection
+void MainWindow::compareTable(const QModelIndex &index)
+{
+    DbTable *dbt = d.dblist.getDbTable(index);
+    if (!dbt) return;
+
+    DbConnection *source = dbt->dbconn;
+    auto dlg = new TableDiffDlg(source->dbparam->connLabel, source->db.connectionName(), dbt->tablename, this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    for (int i = 0; i < d.dblist.rowCount(); ++i) {
+        DbConnection *dbc = d.dblist.getDbConnection(i);
+        if (dbc != source) {
+            dlg->addTarget(dbc->dbparam->connLabel, dbc->db.connectionName());
+        }
+    }
+    dlg->show();
+}
+
+/******************************************************************/
+//! copies the table to another connection, a missing target table is created
+void MainWindow::copyTable(const QModelIndex &index)
+{
+    DbTable *dbt = d.dblist.getDbTable(index);
+    if (!dbt) return;
+
+    DbConnection *source = dbt->dbconn;
+    auto dlg = new CopyTableDlg(source->dbparam->connLabel, source->db.connectionName(), dbt->tablename, this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    for (int i = 0; i < d.dblist.rowCount(); ++i) {
+        DbConnection *dbc = d.dblist.getDbConnection(i);
+        if (dbc != source) {
+            dlg->addTarget(dbc->dbparam->connLabel, dbc->db.connectionName());
+        }
+    }
+    dlg->show();
+}
+
+/******************************************************************/
+//! exports the tables of the connection to a folder, views are offered unchecked
+void MainWindow::dumpConnection(const QModelIndex &index)
+{
+    DbConnection *dbc = d.dblist.getDbConnection(index);
+    if (!dbc || !dbc->db.isOpen()) return;
+
+    auto dlg = new DumpDlg(dbc->dbparam->connLabel, dbc->db.connectionName(), this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    for (const DbTable *dbt : qAsConst(dbc->tablelist)) {
+        if (dbt->tabletype != DbTable::SystemTable) {
+            dlg->addTable(dbt->tablename, dbt->tabletype == DbTable::UserTable);
+        }
+    }
+    dlg->show();
 }
 
 /******************************************************************/
@@ -193,8 +299,24 @@ void MainWindow::showDataTableContextMenu(const QPoint &position)
     contextmenu.addSeparator();
     contextmenu.addAction(ui->action_AddRow);
     contextmenu.addAction(ui->action_DelRow);
-
-    contextmenu.exec(ui->dataTable->mapToGlobal(position));
+    QAction *pasteAction = contextmenu.addAction(QIcon::fromTheme("edit-paste"), tr("Paste Rows..."));
+    pasteAction->setEnabled(d.datatablemodel != Q_NULLPTR);
+    contextmenu.addSeparator();
+    const QModelIndex index = ui->dataTable->indexAt(position);
+    QAction *viewAction = contextmenu.addAction(tr("View Value..."));
+    viewAction->setEnabled(index.isValid());
+    const int column = ui->dataTable->columnAt(position.x());
+    QAction *profileAction = contextmenu.addAction(tr("Profile Column..."));
+    profileAction->setEnabled(d.datatablemodel && column >= 0);
+
+    QAction *action = contextmenu.exec(ui->dataTable->mapToGlobal(position));
+    if (action == pasteAction) {
+        pasteTableRows();
+    } else if (action == viewAction) {
+        viewTableValue(index);
+    } else if (action == profileAction) {
+        profileColumn(ui->dataTable, column);
+    }
 }
 
 /******************************************************************/
@@ -219,10 +341,27 @@ void MainWindow::delTableRow()
 {
     if (!d.datatablemodel) return;
 
-    QModelIndexList indexlist = ui->dataTable->selectionModel()->selectedIndexes();
+    // every row is removed once, however many of its cells are selected
+    QVector<bool> selected(d.datatablemodel->rowCount());
+    for (const auto &range : ui->dataTable->selectionModel()->selection()) {
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            selected[row] = true;
+        }
+    }
 
-    for (int i = 0; i < indexlist.count(); ++i) {
-        d.datatablemodel->removeRow(indexlist.at(i).row());
+    // runs of rows are removed from the bottom, so that dropped new rows do not shift the rest
+    int row = selected.size() - 1;
+    while (row >= 0) {
+        if (!selected.at(row)) {
+            --row;
+            continue;
+        }
+        int first = row;
+        while (first > 0 && selected.at(first - 1)) {
+            --first;
+        }
+        d.datatablemodel->removeRows(first, row - first + 1);
+        row = first - 1;
     }
 }
 
@@ -233,7 +372,48 @@ void MainWindow::copyTableData()
     if (!d.datatablemodel) return;
 
     QItemSelectionModel *selmodel = ui->dataTable->selectionModel();
-    saveToClipboard(d.datatablemodel->query(), selmodel->selection(), QClipboard::Clipboard);
+    if (ui->dataTable->model() != d.datatablemodel || !d.datatablemodel->hasLazyColumns()) {
+        saveToClipboard(ui->dataTable->model(), selmodel->selection(), QClipboard::Clipboard);
+        return;
+    }
+
+    // previews must not reach the clipboard, pasted back they would overwrite the full values
+    const QItemSelection selection = selmodel->selection();
+    auto mime = new XTableMimeData(d.datatablemodel, selection);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    for (const auto &index : selection.indexes()) {
+        if (!d.datatablemodel->isTruncated(index)) continue;
+        QString err;
+        const QVariant value = d.datatablemodel->fetchValue(index, &err);
+        if (err.isEmpty() && value.type() == QVariant::ByteArray) {
+            err = tr("Binary values cannot be copied as text.");
+        }
+        if (!err.isEmpty()) {
+            QApplication::restoreOverrideCursor();
+            delete mime;
+            QMessageBox::warning(this, tr("Copy"), err);
+            return;
+        }
+        mime->setCellText(index.row(), index.column(), value.toString());
+    }
+    QApplication::restoreOverrideCursor();
+    QApplication::clipboard()->setMimeData(mime, QClipboard::Clipboard);
+}
+
+/******************************************************************/
+//! writes rows from the clipboard into the table, matched by primary key
+void MainWindow::pasteTableRows()
+{
+    if (!d.datatablemodel) return;
+    if (d.datatablemodel->isDirty()) {
+        QMessageBox::information(this, tr("Paste Rows"), tr("Save or revert the pending changes first."));
+        return;
+    }
+
+    PasteRowsDlg dlg(d.datatablemodel->database(), d.datatablemodel->tableName(), this);
+    if (dlg.exec() == QDialog::Accepted) {
+        d.datatablemodel->select();
+    }
 }
 
 /******************************************************************/
@@ -241,7 +421,22 @@ void MainWindow::copyTableData()
 void MainWindow::exportTableToCsv()
 {
     if (!d.datatablemodel) return;
-    exportToCsv(d.datatablemodel);
+    if (!d.datatablemodel->hasLazyColumns()) {
+        exportToCsv(d.datatablemodel);
+        return;
+    }
+
+    // previews are not exported, the rows are read again with the full values
+    QSqlQueryModel model;
+    model.setQuery(d.datatablemodel->fullSelectStatement(), d.datatablemodel->database());
+    while (model.canFetchMore()) {
+        model.fetchMore();
+    }
+    if (model.lastError().isValid()) {
+        QMessageBox::warning(this, tr("Export to CSV"), model.lastError().text());
+        return;
+    }
+    exportToCsv(&model);
 }
 
 /******************************************************************/
@@ -256,8 +451,28 @@ void MainWindow::refreshTableData()
 
 void MainWindow::saveTableData()
 {
-    if (!d.datatablemodel) return;
-    d.datatablemodel->submitAll();
+    if (!d.datatablemodel || !d.datatablemodel->isDirty()) return;
+
+    QProgressDialog progress(tr("Saving changes..."), QString(), 0, 0, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    connect(d.datatablemodel, &DbTableModel::submitProgress, &progress, [&progress](int done, int total){
+        progress.setMaximum(total);
+        progress.setValue(done);
+    });
+
+    QString err;
+    const bool ok = d.datatablemodel->submitBatched(DbTableModel::submitBatchSize(), &err);
+    progress.reset();
+    if (ok) return;
+
+    const int row = d.datatablemodel->failedRow();
+    if (row >= 0) {
+        ui->dataTable->selectRow(row);
+        ui->dataTable->scrollTo(d.datatablemodel->index(row, 0));
+        err = tr("Row %1 could not be saved.\n%2").arg(row + 1).arg(err);
+    }
+    QMessageBox::warning(this, tr("Save Changes"), err);
 }
 
 /******************************************************************/
@@ -270,6 +485,41 @@ void MainWindow::revertTableData()
 
 /******************************************************************/
 
+void MainWindow::filterTableData()
+{
+    if (!d.datatablemodel) return;
+
+    const DbTableFilter filter = d.datatablemodel->compileFilter(d.datafilter->texts());
+    d.datafilter->setInvalid(filter.invalidColumn, filter.error);
+    if (filter.invalidColumn >= 0) {
+        ui->filterInfoLabel->setText(filter.error);
+        return;
+    }
+    if (filter.sql == d.datatablemodel->filter()) return;
+    if (d.datatablemodel->isDirty()) {
+        ui->filterInfoLabel->setText(tr("Save or revert the changes to filter"));
+        return;
+    }
+
+    // the filter row waits for a pause in typing, so only the last filter is selected
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    d.datatablemodel->setFilter(filter.sql);
+    QApplication::restoreOverrideCursor();
+
+    const QStringList index = d.schemamodel.indexFields();
+    if (d.datatablemodel->lastError().isValid()) {
+        ui->filterInfoLabel->setText(d.datatablemodel->lastError().text());
+    } else if (filter.sql.isEmpty()) {
+        ui->filterInfoLabel->clear();
+    } else if (!index.isEmpty() && filter.seekFields.contains(index.first(), Qt::CaseInsensitive)) {
+        ui->filterInfoLabel->setText(tr("Filter can use the primary key index"));
+    } else {
+        ui->filterInfoLabel->setText(tr("Filter reads the whole table"));
+    }
+}
+
+/******************************************************************/
+
 void MainWindow::sortDataTable(int logicalIndex)
 {
     if (!d.datatablemodel) return;
@@ -288,58 +538,226 @@ void MainWindow::sortDataTable(int logicalIndex)
 
 /******************************************************************/
 
-void MainWindow::runQuery()
+void MainWindow::setLazyTableData(bool enabled)
 {
-    // clear all
-    d.userquerymodel.clear();
-    ui->queryResultText->clear();
+    if (!d.datatablemodel) {
+        DbTableModel::setLazyDefault(enabled);
+        return;
+    }
+    d.datatablemodel->setLazyEnabled(enabled);
+    d.datatablemodel->select();
+    setColumnFormatters(ui->dataTable, d.datatablemodel->record());
+}
 
-    // check connections
-    DbConnection *dbc = d.dblist.getDbConnection( ui->treeDbList->currentIndex() );
+/******************************************************************/
+//! shows only the newest rows of the table, they are appended as they arrive
+void MainWindow::setTailTableData(bool enabled)
+{
+    if (enabled == (d.tailmodel != Q_NULLPTR)) return;
 
-    if (!dbc) {
-        ui->queryTable->hide();
-        ui->queryResultText->show();
-        ui->queryResultText->setPlainText("No database connection selected.\nAdd and activate a connection in the left tree view.");
+    if (enabled) {
+        if (!d.datatablemodel) {
+            const QSignalBlocker blocker(ui->tailDataButton);
+            ui->tailDataButton->setChecked(false);
+            return;
+        }
+        auto tailmodel = new DbTailModel(this);
+        QString err;
+        if (!tailmodel->setTable(d.datatablemodel->database(), d.datatablemodel->tableName(), &err)) {
+            delete tailmodel;
+            const QSignalBlocker blocker(ui->tailDataButton);
+            ui->tailDataButton->setChecked(false);
+            QMessageBox::information(this, tr("Tail"), err);
+            return;
+        }
+        d.tailmodel = tailmodel;
+        connect(tailmodel, &DbTailModel::rowsAppended, this, [this](){
+            // the scroll bar range is not updated yet, at its maximum the view was at the bottom
+            QScrollBar *bar = ui->dataTable->verticalScrollBar();
+            if (bar->value() == bar->maximum()) {
+                ui->dataTable->scrollToBottom();
+            }
+        });
+        ui->dataTable->setModel(tailmodel);
+        setColumnFormatters(ui->dataTable, tailmodel->record());
+        tailmodel->start();
+        ui->filterInfoLabel->setText(tr("Following %1").arg(tailmodel->tailField()));
+    } else {
+        d.tailmodel->stop();
+        if (d.datatablemodel) {
+            ui->dataTable->setModel(d.datatablemodel);
+            setColumnFormatters(ui->dataTable, d.datatablemodel->record());
+        }
+        // pending clipboard data takes the copied cells first
+        d.tailmodel->clear();
+        d.tailmodel->deleteLater();
+        d.tailmodel = Q_NULLPTR;
+        ui->filterInfoLabel->clear();
+    }
+    connect(ui->dataTable->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &MainWindow::updateSelectionStats);
+
+    // the tail is read-only
+    for (QAction *action : QList<QAction*>() << ui->action_AddRow << ui->action_DelRow << ui->action_SaveData
+         << ui->action_RevertData << ui->action_RefreshData) {
+        action->setEnabled(!enabled);
+    }
+    for (QWidget *widget : QList<QWidget*>() << ui->addRowButton << ui->delRowButton << ui->pasteDataButton
+         << ui->saveDataButton << ui->revertDataButton << ui->refreshDataButton << ui->lazyDataButton) {
+        widget->setEnabled(!enabled);
+    }
+    d.datafilter->setVisible(!enabled && d.datatablemodel);
+}
+
+/******************************************************************/
+//! shows the complete value, truncated previews are read from the server
+void MainWindow::viewTableValue(const QModelIndex &index)
+{
+    if (!d.datatablemodel || index.model() != d.datatablemodel) return;
+
+    QString err;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const QVariant value = d.datatablemodel->fetchValue(index, &err);
+    QApplication::restoreOverrideCursor();
+    if (!err.isEmpty()) {
+        QMessageBox::warning(this, tr("View Value"), err);
         return;
     }
 
-    if (!dbc->db.isOpen()) {
-        QSqlError ce = dbc->connect(&d.dblist);
-        if (ce.isValid()) {
-            ui->queryTable->hide();
-            ui->queryResultText->show();
-            ui->queryResultText->setPlainText(QString("%1\n%2")
-                                          .arg(ce.driverText(), ce.databaseText()));
+    const QString title = d.datatablemodel->headerData(index.column(), Qt::Horizontal).toString();
+    ValueViewerDlg dlg(title, value, this);
+    dlg.exec();
+}
+
+/******************************************************************/
+
+void MainWindow::runQuery()
+{
+    executeQuery(false);
+}
+
+/******************************************************************/
+
+void MainWindow::refreshQuery()
+{
+    executeQuery(true);
+}
+
+/******************************************************************/
+//! runs the last query again on every interval, rows are matched by the refresh keys
+void MainWindow::setAutoRefresh(bool enabled)
+{
+    if (enabled == d.refreshmodel.isRunning()) return;
+
+    if (enabled) {
+        const QAbstractItemModel *source = d.queryproxy.sourceModel();
+        if (d.querySql.isEmpty() || !source || !source->columnCount()) {
+            const QSignalBlocker blocker(ui->autoRefreshButton);
+            ui->autoRefreshButton->setChecked(false);
+            statusBar()->showMessage(tr("Execute a select query first"), 5000);
             return;
         }
+        // the first run is compared with the rows of the executed query
+        if (source != &d.refreshmodel) {
+            d.refreshmodel.setQuery(d.queryConnectionName, d.querySql, d.queryBindings);
+            // a partly fetched result would show the rest as new rows
+            if (!d.resultmodel.canFetchMore(QModelIndex()) && d.resultmodel.rowCount() <= DbRefreshModel::MaxRows) {
+                QVector<DbRefreshModel::Row> rows;
+                rows.reserve(d.resultmodel.rowCount());
+                for (int r = 0; r < d.resultmodel.rowCount(); ++r) {
+                    rows << d.resultmodel.row(r);
+                }
+                d.refreshmodel.setRows(d.resultmodel.fields(), rows);
+            }
+        }
+        d.refreshmodel.setKeyColumns(d.refreshKeys);
+        d.refreshmodel.setInterval(ui->refreshIntervalSpin->value());
+        d.queryproxy.setSourceModel(&d.refreshmodel);
+        d.refreshmodel.start();
+    } else {
+        d.refreshmodel.stop();
     }
+    ui->refreshIntervalSpin->setEnabled(!enabled);
+}
+
+/******************************************************************/
+
+void MainWindow::executeQuery(bool refresh)
+{
+    ui->autoRefreshButton->setChecked(false);
+
+    // clear all
+    d.resultmodel.clear();
+    ui->queryResultText->clear();
+    ui->cachedAtLabel->clear();
+    if (d.queryproxy.sourceModel() != &d.resultmodel) {
+        d.queryproxy.setSourceModel(&d.resultmodel);
+    }
+    ui->queryTable->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+
+    // check connections
+    DbConnection *dbc = queryConnection();
+    if (!dbc) return;
 
     // prepare for bindings
     QString sqlText = ui->editQuery->toPlainText();
     QStringList params = Report::findBindings(sqlText);
     QVariantMap bindings = setBindValues(params, dbc);
+    if (sqlText != d.querySql) {
+        d.refreshKeys.clear();
+    }
+    d.queryConnectionName = dbc->db.connectionName();
+    d.querySql            = sqlText;
+    d.queryBindings       = bindings;
+
+    // stored result of the same query
+    QString cacheKey;
+    if (d.resultcache.isEnabled()) {
+        cacheKey = d.resultcache.key(dbc, sqlText, bindings);
+        if (!refresh && d.resultcache.load(cacheKey, &d.resultmodel)) {
+            showResultModel();
+            ui->cachedAtLabel->setText(tr("Cached at %1")
+                                       .arg(d.resultmodel.cachedAt().toString("yyyy-MM-dd hh:mm:ss")));
+            return;
+        }
+    }
 
-    // initialize new sql query object   
-    QSqlQuery query(dbc->db);
-    query.prepare(sqlText);
+    DbHistoryEntry entry;
+    entry.executed   = QDateTime::currentDateTime();
+    entry.connection = dbc->dbparam->connLabel;
+    entry.sql        = sqlText;
+    entry.binds      = bindings;
+    QElapsedTimer timer;
+    timer.start();
+
+    // take prepared sql query object from the connection cache
+    QSqlQuery query = dbc->querycache.prepare(dbc->db, sqlText);
+    query.setForwardOnly(true);
     QMapIterator<QString, QVariant> i(bindings);
     while (i.hasNext()) {
         i.next();
         query.bindValue(i.key(), i.value());
     }
-    if (query.exec()) {
+    entry.prepareUs = timer.nsecsElapsed() / 1000;
+    timer.restart();
+    const bool ok = query.exec();
+    entry.execUs = timer.nsecsElapsed() / 1000;
+    timer.restart();
+
+    if (ok) {
         if (query.isSelect()) {
-            d.userquerymodel.setQuery(query);
-            ui->queryResultText->hide();
-            ui->queryTable->show();
-            ui->queryTable->resizeColumnsToContents();
-            ui->queryTable->resizeRowsToContents();
-            ui->tabWidget->setTabEnabled(SimpleReportTab, true);
-            if (simpleReportTab) {
-                simpleReportTab->updateView();
-            }
+            // rows are read while the view asks for them, the result model spills them above its memory budget
+            const QSqlRecord rec = query.record();
+            d.resultmodel.setQuery(query);
+            d.storing    = !cacheKey.isEmpty() && d.resultcache.beginStore(cacheKey, d.resultmodel.fields());
+            d.fetchEntry = entry;
+            d.fetching   = true;
+            d.resultmodel.fetchMore(QModelIndex());
+            showResultModel(rec);
+            // the execution is recorded when the rows are fetched or the result is closed
+            return;
         } else {
+            entry.affected = query.numRowsAffected();
             ui->queryTable->hide();
             ui->tabWidget->setTabEnabled(SimpleReportTab, false);
             ui->queryResultText->show();
@@ -348,6 +766,7 @@ void MainWindow::runQuery()
                                           .arg( query.numRowsAffected() ));
         }
     } else {
+        entry.error = query.lastError().text();
         ui->queryTable->hide();
         ui->tabWidget->setTabEnabled(SimpleReportTab, false);
         ui->queryResultText->show();
@@ -355,6 +774,258 @@ void MainWindow::runQuery()
                                       .arg(query.lastError().driverText(),
                                            query.lastError().databaseText()));
     }
+
+    d.history.record(entry);
+}
+
+/******************************************************************/
+
+void MainWindow::storeFetchedRows(const QVector<DbResultModel::Row> &rows)
+{
+    if (!d.fetching) return;
+
+    for (const auto &row : rows) {
+        if (d.storing) d.resultcache.storeRow(row);
+        for (const auto &value : row) {
+            d.fetchEntry.bytes += DbHistory::valueBytes(value);
+        }
+    }
+}
+
+/******************************************************************/
+//! a result which was not read to the end is not cached
+void MainWindow::finishFetch(bool complete)
+{
+    if (!d.fetching) return;
+    d.fetching = false;
+
+    if (d.storing && complete) {
+        d.resultcache.endStore();
+    } else if (d.storing) {
+        d.resultcache.cancelStore();
+    }
+    d.storing = false;
+
+    d.fetchEntry.fetchUs = d.resultmodel.fetchUs();
+    d.fetchEntry.rows    = d.resultmodel.rowCount();
+    d.fetchEntry.error   = d.resultmodel.fetchError();
+    if (!d.fetchEntry.error.isEmpty()) {
+        statusBar()->showMessage(tr("Fetching stopped after %1 rows: %2")
+                                 .arg(d.resultmodel.rowCount()).arg(d.fetchEntry.error), 5000);
+    }
+    d.history.record(d.fetchEntry);
+}
+
+/******************************************************************/
+
+void MainWindow::runBatchQuery()
+{
+    ui->autoRefreshButton->setChecked(false);
+
+    // clear all
+    d.resultmodel.clear();
+    ui->queryResultText->clear();
+    ui->cachedAtLabel->clear();
+    if (d.queryproxy.sourceModel() != &d.resultmodel) {
+        d.queryproxy.setSourceModel(&d.resultmodel);
+    }
+
+    // the rows of many bindings cannot be executed again,
+    // auto refresh and column profiles are off for a batch result
+    d.queryConnectionName.clear();
+    d.querySql.clear();
+    d.queryBindings.clear();
+
+    // check connections
+    DbConnection *dbc = queryConnection();
+    if (!dbc) return;
+
+    QString sqlText = ui->editQuery->toPlainText();
+    QStringList params = Report::findBindings(sqlText);
+    if (params.isEmpty()) {
+        showQueryMessage("The query has no named parameters to bind.");
+        return;
+    }
+
+    BatchParamDlg dlg(params, this);
+    if (dlg.exec() != QDialog::Accepted) return;
+
+    const XCsvModel *csv = dlg.csvModel();
+    const QMap<QString, int> columns = dlg.columns();
+    const int rows = csv->rowCount();
+    const int batchSize = dlg.batchSize();
+    const bool useTransactions = dbc->db.driver()->hasFeature(QSqlDriver::Transactions);
+
+    QSqlQuery query = dbc->querycache.prepare(dbc->db, sqlText);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    bool isSelect = false;
+    int committed = 0;
+    int errorRow = -1;
+    bool batchFailed = false;
+    QSqlError error;
+
+    auto bindRow = [&](int row) {
+        QMapIterator<QString, int> i(columns);
+        while (i.hasNext()) {
+            i.next();
+            query.bindValue(i.key(), csvBindValue(csv, row, i.value()));
+        }
+    };
+
+    for (int first = 0; first < rows && errorRow < 0; first += batchSize) {
+        const int last = qMin(first + batchSize, rows);
+        if (useTransactions) dbc->db.transaction();
+
+        int row = first;
+        while (row < last) {
+            // the first row tells if the statement returns a result set,
+            // without transactions the rows before a failure must be known
+            if (row == 0 || isSelect || !useTransactions) {
+                bindRow(row);
+                if (!query.exec()) {
+                    errorRow = row;
+                    break;
+                }
+                if (row == 0) {
+                    isSelect = query.isSelect();
+                    if (isSelect) {
+                        QSqlRecord rec = query.record();
+                        QStringList labels;
+                        for (int c = 0; c < rec.count(); ++c) {
+                            labels << rec.fieldName(c);
+                        }
+                        d.resultmodel.setFields(labels);
+                    }
+                }
+                if (isSelect) {
+                    const int cols = d.resultmodel.columnCount();
+                    QVector<DbResultModel::Row> rows;
+                    while (query.next()) {
+                        DbResultModel::Row values(cols);
+                        for (int c = 0; c < cols; ++c) {
+                            values[c] = query.value(c);
+                        }
+                        rows.append(values);
+                        if (rows.size() == DbResultModel::BlockRows) {
+                            d.resultmodel.appendRows(rows);
+                            rows.clear();
+                        }
+                    }
+                    d.resultmodel.appendRows(rows);
+                }
+                ++row;
+            } else {
+                // the rest of the chunk goes as one batch
+                QMapIterator<QString, int> i(columns);
+                while (i.hasNext()) {
+                    i.next();
+                    QVariantList values;
+                    for (int r = row; r < last; ++r) {
+                        values << csvBindValue(csv, r, i.value());
+                    }
+                    query.bindValue(i.key(), values);
+                }
+                if (!query.execBatch()) {
+                    errorRow = row;
+                    batchFailed = true;
+                    break;
+                }
+                row = last;
+            }
+        }
+
+        if (errorRow >= 0) {
+            error = query.lastError();
+            if (!useTransactions) {
+                committed = errorRow;
+            } else {
+                dbc->db.rollback();
+                // a batch does not tell its failing row, the chunk is executed row by row and rolled back again
+                if (batchFailed && dbc->db.transaction()) {
+                    for (int r = first; r < last; ++r) {
+                        bindRow(r);
+                        if (!query.exec()) {
+                            errorRow = r;
+                            error = query.lastError();
+                            break;
+                        }
+                    }
+                    dbc->db.rollback();
+                }
+            }
+        } else {
+            if (useTransactions) dbc->db.commit();
+            committed = last;
+        }
+    }
+
+    QApplication::restoreOverrideCursor();
+
+    if (errorRow >= 0) {
+        showQueryMessage(QString("Error in CSV row %1, %2 of %3 rows committed.\n%4\n%5")
+                         .arg(errorRow + 1).arg(committed).arg(rows)
+                         .arg(error.driverText(), error.databaseText()));
+        return;
+    }
+
+    if (isSelect) {
+        showResultModel();
+    } else {
+        showQueryMessage(QString("%1 rows executed.").arg(committed));
+    }
+}
+
+/******************************************************************/
+//! runs the query on several connections, the bindings are asked once for all
+void MainWindow::runFanOutQuery()
+{
+    DbConnection *dbc = queryConnection();
+    if (!dbc) return;
+
+    QString sqlText = ui->editQuery->toPlainText();
+    QStringList params = Report::findBindings(sqlText);
+    QVariantMap bindings = setBindValues(params, dbc);
+
+    auto dlg = new FanOutDlg(sqlText, bindings, this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    for (int i = 0; i < d.dblist.rowCount(); ++i) {
+        DbConnection *target = d.dblist.getDbConnection(i);
+        dlg->addTarget(target->dbparam->connLabel, target->db.connectionName());
+    }
+    dlg->show();
+}
+
+/******************************************************************/
+//! runs EXPLAIN for the query and shows the plan tree
+void MainWindow::explainQuery()
+{
+    DbConnection *dbc = queryConnection();
+    if (!dbc) return;
+
+    if (!DbPlan::isSupported(dbc->db.driverName())) {
+        showQueryMessage(QString("Execution plans are not supported for %1 connections.")
+                         .arg(dbc->db.driverName()));
+        return;
+    }
+
+    QString sqlText = ui->editQuery->toPlainText();
+    QStringList params = Report::findBindings(sqlText);
+    QVariantMap bindings = setBindValues(params, dbc);
+
+    DbPlanNode plan;
+    QString err;
+    if (!DbPlan::explain(dbc->db, sqlText, bindings, &plan, &err)) {
+        showQueryMessage(err);
+        return;
+    }
+
+    // earlier plans are listed before this one is stored
+    planTab->showPlan(sqlText, plan);
+    d.history.recordPlan(dbc->dbparam->connLabel, sqlText, plan.toJson());
+    ui->tabWidget->setTabEnabled(PlanTab, true);
+    ui->tabWidget->setCurrentIndex(PlanTab);
 }
 
 /******************************************************************/
@@ -362,7 +1033,7 @@ void MainWindow::runQuery()
 void MainWindow::copyQueryResult()
 {
     auto selmodel = ui->queryTable->selectionModel();
-    saveToClipboard(d.userquerymodel.query(), selmodel->selection(), QClipboard::Clipboard);
+    saveToClipboard(&d.queryproxy, selmodel->selection(), QClipboard::Clipboard);
 }
 
 /******************************************************************/
@@ -370,7 +1041,7 @@ void MainWindow::copyQueryResult()
 void MainWindow::exportQueryToCsv()
 {
     if (ui->queryTable->isHidden()) return;
-    exportToCsv(&d.userquerymodel);
+    exportToCsv(ui->queryTable->model());
 }
 
 /******************************************************************/
@@ -425,33 +1096,165 @@ void MainWindow::saveQueryToFile()
 
 void MainWindow::setTableHeaders()
 {
-    QSqlRecord rec = d.userquerymodel.record();
-    if (rec.isEmpty()) {
+    const QStringList fields = d.resultmodel.fields();
+    if (fields.isEmpty()) {
         return;
     }
-    QStringList fields;
-    for (int i=0; i < rec.count(); ++i) {
-        fields << rec.field(i).name();
-    }
     QStringList headers;
-    for (int i=0; i < d.userquerymodel.columnCount(); ++i) {
-        headers << d.userquerymodel.headerData(i, Qt::Horizontal).toString();
+    for (int i=0; i < d.resultmodel.columnCount(); ++i) {
+        headers << d.resultmodel.headerData(i, Qt::Horizontal).toString();
     }
     TableHeadersDlg dlg(fields);
     dlg.setHeaders(headers);
     if (dlg.exec() == QDialog::Accepted) {
         headers = dlg.headers();
         for (int i=0; i < headers.size(); ++i) {
-            d.userquerymodel.setHeaderData(i, Qt::Horizontal, headers.at(i));
+            d.resultmodel.setHeaderData(i, Qt::Horizontal, headers.at(i));
         }
     }
 }
 
+/******************************************************************/
+//! selects the connection of a history entry and runs its SQL again
+void MainWindow::openHistoryQuery(const QString &connection, const QString &sql, const QVariantMap &binds)
+{
+    for (int row = 0; row < d.dblist.rowCount(); ++row) {
+        const QModelIndex index = d.dblist.index(row, 0);
+        DbConnection *dbc = d.dblist.getDbConnection(index);
+        if (dbc && dbc->dbparam->connLabel == connection) {
+            ui->treeDbList->setCurrentIndex(index);
+            break;
+        }
+    }
+
+    ui->editQuery->setPlainText(sql);
+    d.bindDefaults = binds;
+    ui->tabWidget->setCurrentIndex(QueryTab);
+    runQuery();
+}
+
+/******************************************************************/
+//! filters of the query result columns
+void MainWindow::showQueryHeaderContextMenu(const QPoint &position)
+{
+    const int column = ui->queryTable->horizontalHeader()->logicalIndexAt(position);
+    if (column < 0) return;
+
+    QMenu menu(this);
+    QAction *filterAction   = menu.addAction(QIcon::fromTheme("view-filter"), tr("Filter..."));
+    QAction *clearAction    = menu.addAction(tr("Clear Filter"));
+    QAction *clearAllAction = menu.addAction(tr("Clear All Filters"));
+    menu.addSeparator();
+    QAction *profileAction  = menu.addAction(tr("Profile Column..."));
+    QAction *keyAction      = menu.addAction(tr("Refresh Key"));
+    keyAction->setCheckable(true);
+    keyAction->setChecked(d.refreshKeys.contains(column));
+    clearAction->setEnabled(!d.queryproxy.filter(column).isEmpty());
+    clearAllAction->setEnabled(d.queryproxy.hasFilters());
+    profileAction->setEnabled(!d.querySql.isEmpty());
+
+    QAction *action = menu.exec(ui->queryTable->horizontalHeader()->mapToGlobal(position));
+    if (action == filterAction) {
+        bool ok = false;
+        const QString predicate = QInputDialog::getText(this, tr("Filter"),
+                tr("Values containing text, or =, !=, <, <=, >, >= value, or null, !null"),
+                QLineEdit::Normal, d.queryproxy.filter(column), &ok);
+        if (ok) {
+            QApplication::setOverrideCursor(Qt::WaitCursor);
+            d.queryproxy.setFilter(column, predicate);
+            QApplication::restoreOverrideCursor();
+        }
+    } else if (action == clearAction) {
+        d.queryproxy.setFilter(column, QString());
+    } else if (action == clearAllAction) {
+        d.queryproxy.clearFilters();
+    } else if (action == profileAction) {
+        profileColumn(ui->queryTable, column);
+    } else if (action == keyAction) {
+        if (keyAction->isChecked()) {
+            d.refreshKeys << column;
+            std::sort(d.refreshKeys.begin(), d.refreshKeys.end());
+        } else {
+            d.refreshKeys.removeAll(column);
+        }
+        d.refreshmodel.setKeyColumns(d.refreshKeys);
+    }
+}
+
+/******************************************************************/
+//! streams the column again on a worker connection, the models are not read
+void MainWindow::profileColumn(QTableView *view, int column)
+{
+    if (view == ui->dataTable && !d.datatablemodel) return;
+
+    const QString title = view->model()->headerData(column, Qt::Horizontal).toString();
+    auto dlg = new ProfileDlg(title, this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    if (view == ui->dataTable) {
+        dlg->setTable(d.datatablemodel->database().connectionName(), d.datatablemodel->tableName(),
+                      d.datatablemodel->record().fieldName(column));
+    } else {
+        dlg->setQuery(d.queryConnectionName, d.querySql, d.queryBindings, column);
+    }
+    dlg->show();
+    dlg->start();
+}
+
+/******************************************************************/
+//! recalculates the aggregates for the table of the current tab
+void MainWindow::updateSelectionStats()
+{
+    QTableView *view = Q_NULLPTR;
+    switch (ui->tabWidget->currentIndex()) {
+    case DataTab:
+        view = ui->dataTable;
+        break;
+    case QueryTab:
+        view = ui->queryTable;
+        break;
+    }
+
+    if (!view || !view->model() || !view->selectionModel()) {
+        d.selectionstats.setSelection(Q_NULLPTR, QItemSelection());
+        return;
+    }
+    d.selectionstats.setSelection(view->model(), view->selectionModel()->selection());
+}
+
+/******************************************************************/
+
+void MainWindow::showSelectionStats(const XSelectionStats::Result &result)
+{
+    if (result.cells < 2) {
+        selectionStatsLabel->clear();
+        return;
+    }
+
+    const QLocale locale;
+    QStringList parts;
+    parts << tr("Count: %1").arg(result.count);
+    if (result.numbers) {
+        parts << tr("Sum: %1").arg(locale.toString(result.sum, 'g', 15))
+              << tr("Avg: %1").arg(locale.toString(result.avg(), 'g', 15))
+              << tr("Min: %1").arg(locale.toString(result.min, 'g', 15))
+              << tr("Max: %1").arg(locale.toString(result.max, 'g', 15));
+    }
+    parts << tr("Distinct: %1").arg(result.distinct);
+    selectionStatsLabel->setText(parts.join("   "));
+}
+
 /******************************************************************/
 
 void MainWindow::setupUI()
 {
-    statusBar()->hide();
+    // aggregates of the selected cells
+    selectionStatsLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(selectionStatsLabel);
+    connect(&d.selectionstats, &XSelectionStats::progress, this, [this](int percent){
+        selectionStatsLabel->setText(tr("Calculating... %1%").arg(percent));
+    });
+    connect(&d.selectionstats, &XSelectionStats::finished,
+            this, &MainWindow::showSelectionStats);
 
     d.dblist.loadAll();
 
@@ -467,6 +1270,7 @@ void MainWindow::setupUI()
 
     connect(ui->dataTable->horizontalHeader(), &QHeaderView::sectionDoubleClicked,
             this, &MainWindow::sortDataTable);
+    ui->lazyDataButton->setChecked(DbTableModel::lazyDefault());
 
     ui->schemaTable->setModel(&d.schemamodel);
     ui->schemaTable->verticalHeader()->hide();
@@ -479,19 +1283,67 @@ void MainWindow::setupUI()
     new SQLHighlighter(ui->editQuery->document());
 
     ui->queryTable->hide();
-    ui->queryTable->setModel(&d.userquerymodel);
+    d.queryproxy.setSourceModel(&d.resultmodel);
+    ui->queryTable->setModel(&d.queryproxy);
+    ui->queryTable->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    ui->queryTable->setSortingEnabled(true);
+    ui->queryTable->horizontalHeader()->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->queryTable->horizontalHeader(), &QWidget::customContextMenuRequested,
+            this, &MainWindow::showQueryHeaderContextMenu);
+    connect(ui->queryTable->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &MainWindow::updateSelectionStats);
 
     connect(ui->setHeadersButton, &QToolButton::clicked,
             this, &MainWindow::setTableHeaders);
 
+    ui->cacheQueryButton->setChecked(d.resultcache.isEnabled());
+
+    // filter row above the data table, the filter is applied by the server
+    {
+        auto layout = qobject_cast<QBoxLayout*>(ui->dataTable->parentWidget()->layout());
+        d.datafilter = new XFilterRow(ui->dataTable, ui->dataTable->parentWidget());
+        layout->insertWidget(layout->indexOf(ui->dataTable), d.datafilter);
+        d.datafilter->rebuild();
+        connect(d.datafilter, &XFilterRow::filterChanged,
+                this, &MainWindow::filterTableData);
+    }
+
+    // find bars below the result tables, Ctrl+F in a table opens it
+    for (QTableView *view : QList<QTableView*>() << ui->dataTable << ui->queryTable) {
+        auto layout = qobject_cast<QBoxLayout*>(view->parentWidget()->layout());
+        auto findBar = new XFindBar(view, view->parentWidget());
+        layout->insertWidget(layout->indexOf(view) + 1, findBar);
+    }
+
     // configure simple report tab
     simpleReportTab = new SimpleReportWidget(this);
-    simpleReportTab->setUserQueryModel(&d.userquerymodel);
+    simpleReportTab->setUserQueryModel(&d.resultmodel);
     ui->tabWidget->addTab(simpleReportTab, QIcon::fromTheme("printer"), tr("Simple Report"));
     ui->tabWidget->setTabEnabled(SimpleReportTab, false);
 
     connect(simpleReportTab, &SimpleReportWidget::tableHeaders,
             this, &MainWindow::setTableHeaders);
+
+    d.history.open();
+
+    // configure plan tab
+    planTab = new PlanWidget(&d.history, this);
+    ui->tabWidget->addTab(planTab, QIcon::fromTheme("view-list-tree"), tr("Plan"));
+    ui->tabWidget->setTabEnabled(PlanTab, false);
+
+    // configure history tab
+    historyTab = new HistoryWidget(&d.history, this);
+    ui->tabWidget->addTab(historyTab, QIcon::fromTheme("document-open-recent"), tr("History"));
+    ui->tabWidget->setTabEnabled(HistoryTab, d.history.isOpen());
+
+    connect(historyTab, &HistoryWidget::openQuery,
+            this, &MainWindow::openHistoryQuery);
+    connect(ui->tabWidget, &QTabWidget::currentChanged, this, [this](int index){
+        if (index == HistoryTab) {
+            historyTab->refresh();
+        }
+        updateSelectionStats();
+    });
 }
 
 /******************************************************************/
@@ -525,6 +1377,7 @@ void MainWindow::setupIcons()
     ui->action_RefreshData->setIcon(iconRefresh);
     ui->action_RefreshTablelist->setIcon(iconRefresh);
     ui->refreshDataButton->setIcon(iconRefresh);
+    ui->refreshQueryButton->setIcon(iconRefresh);
 
     // document-revert
     // x-office-spreadsheet
@@ -574,8 +1427,20 @@ void MainWindow::setupActions()
             this, &MainWindow::delTableRow);
     connect(ui->copyDataButton, &QAbstractButton::clicked,
             this, &MainWindow::copyTableData);
+    connect(ui->pasteDataButton, &QAbstractButton::clicked,
+            this, &MainWindow::pasteTableRows);
     connect(ui->toCsvDataButton, &QAbstractButton::clicked,
             this, &MainWindow::exportTableToCsv);
+    connect(ui->lazyDataButton, &QAbstractButton::toggled,
+            this, &MainWindow::setLazyTableData);
+    connect(ui->tailDataButton, &QAbstractButton::toggled,
+            this, &MainWindow::setTailTableData);
+    connect(ui->dataTable, &QAbstractItemView::doubleClicked, this, [this](const QModelIndex &index){
+        // truncated cells are read-only, double click opens the viewer instead
+        if (d.datatablemodel && index.model() == d.datatablemodel && d.datatablemodel->isTruncated(index)) {
+            viewTableValue(index);
+        }
+    });
     connect(ui->action_RefreshData, &QAction::triggered,
             this, &MainWindow::refreshTableData);
     connect(ui->refreshDataButton, &QAbstractButton::clicked,
@@ -592,6 +1457,33 @@ void MainWindow::setupActions()
     // *** Query Tab ***
     connect(ui->goQueryButton, &QAbstractButton::clicked,
             this, &MainWindow::runQuery);
+    connect(ui->batchQueryButton, &QAbstractButton::clicked,
+            this, &MainWindow::runBatchQuery);
+    connect(ui->fanOutQueryButton, &QAbstractButton::clicked,
+            this, &MainWindow::runFanOutQuery);
+    connect(ui->explainQueryButton, &QAbstractButton::clicked,
+            this, &MainWindow::explainQuery);
+    connect(ui->refreshQueryButton, &QAbstractButton::clicked,
+            this, &MainWindow::refreshQuery);
+    connect(ui->autoRefreshButton, &QAbstractButton::toggled,
+            this, &MainWindow::setAutoRefresh);
+    connect(&d.resultmodel, &DbResultModel::rowsFetched,
+            this, &MainWindow::storeFetchedRows);
+    connect(&d.resultmodel, &DbResultModel::fetchFinished,
+            this, &MainWindow::finishFetch);
+    connect(&d.refreshmodel, &DbRefreshModel::refreshed, this, [this](){
+        QString text = tr("Refreshed at %1").arg(d.refreshmodel.refreshedAt().toString("hh:mm:ss"));
+        if (d.refreshmodel.skippedTicks()) {
+            text += tr(", %1 ticks skipped").arg(d.refreshmodel.skippedTicks());
+        }
+        ui->cachedAtLabel->setText(text);
+        if (!d.refreshmodel.lastError().isEmpty()) {
+            statusBar()->showMessage(d.refreshmodel.lastError(), 5000);
+        }
+    });
+    connect(ui->cacheQueryButton, &QAbstractButton::toggled, this, [this](bool checked){
+        d.resultcache.setEnabled(checked);
+    });
     connect(ui->copyQueryDataButton, &QAbstractButton::clicked,
             this, &MainWindow::copyQueryResult);
     connect(ui->toScvButton, &QAbstractButton::clicked,
@@ -604,6 +1496,93 @@ void MainWindow::setupActions()
             this, &MainWindow::saveQueryToFile);
 }
 
+/******************************************************************/
+//! returns the current connection for the query tab, opens it if needed
+DbConnection *MainWindow::queryConnection()
+{
+    DbConnection *dbc = d.dblist.getDbConnection( ui->treeDbList->currentIndex() );
+
+    if (!dbc) {
+        showQueryMessage("No database connection selected.\nAdd and activate a connection in the left tree view.");
+        return Q_NULLPTR;
+    }
+
+    if (!dbc->db.isOpen()) {
+        QSqlError ce = dbc->connect(&d.dblist);
+        if (ce.isValid()) {
+            showQueryMessage(QString("%1\n%2").arg(ce.driverText(), ce.databaseText()));
+            return Q_NULLPTR;
+        }
+    }
+
+    return dbc;
+}
+
+/******************************************************************/
+
+void MainWindow::showQueryMessage(const QString &text)
+{
+    ui->queryTable->hide();
+    ui->tabWidget->setTabEnabled(SimpleReportTab, false);
+    ui->queryResultText->show();
+    ui->queryResultText->setPlainText(text);
+}
+
+/******************************************************************/
+//! shows materialized rows of a batch run or of the result cache
+void MainWindow::showResultModel(const QSqlRecord &rec)
+{
+    if (d.queryproxy.sourceModel() != &d.resultmodel) {
+        d.queryproxy.setSourceModel(&d.resultmodel);
+    }
+    ui->queryResultText->hide();
+    ui->queryTable->show();
+    setColumnFormatters(ui->queryTable, rec);
+    if (rec.isEmpty()) {
+        XTableSizer::resize(ui->queryTable);
+    } else {
+        XTableSizer::resize(ui->queryTable, fieldLengths(rec));
+    }
+    ui->tabWidget->setTabEnabled(SimpleReportTab, true);
+    if (simpleReportTab) {
+        simpleReportTab->updateView();
+    }
+    if (d.resultmodel.spilledRows()) {
+        statusBar()->showMessage(tr("%1 of %2 rows are kept in a spill file")
+                                 .arg(d.resultmodel.spilledRows())
+                                 .arg(d.resultmodel.rowCount()), 5000);
+    }
+}
+
+/******************************************************************/
+//! formatters are chosen once per result from the field types
+void MainWindow::setColumnFormatters(QTableView *view, const QSqlRecord &rec)
+{
+    auto delegate = qobject_cast<XFormatDelegate*>(view->itemDelegate());
+    if (!delegate) return;
+
+    QVector<XColumnFormatter> formatters;
+    for (int c = 0; c < rec.count(); ++c) {
+        const QSqlField field = rec.field(c);
+        formatters << XColumnFormatter::forType(field.type(), field.precision());
+    }
+    delegate->setFormatters(view->model(), formatters);
+}
+
+/******************************************************************/
+//! declared lengths of text columns, they limit the sampled column widths
+QVector<int> MainWindow::fieldLengths(const QSqlRecord &rec)
+{
+    QVector<int> result(rec.count(), -1);
+    for (int c = 0; c < rec.count(); ++c) {
+        const QSqlField field = rec.field(c);
+        if (field.type() == QVariant::String) {
+            result[c] = field.length();
+        }
+    }
+    return result;
+}
+
 /******************************************************************/
 
 QVariantMap MainWindow::setBindValues(const QStringList &params, DbConnection *dbc)
@@ -616,6 +1595,8 @@ QVariantMap MainWindow::setBindValues(const QStringList &params, DbConnection *d
     dlg.setBindSql(d.bindRef);
     dlg.setBindTypes(d.bindTypes);
     dlg.setupParams(params);
+    dlg.setDefaults(d.bindDefaults);
+    d.bindDefaults.clear();
     if (dlg.exec()) {
         d.bindTypes = dlg.bindTypes();
         d.bindRef = dlg.bindSql();
@@ -627,7 +1608,7 @@ QVariantMap MainWindow::setBindValues(const QStringList &params, DbConnection *d
 
 /******************************************************************/
 
-void MainWindow::exportToCsv(QAbstractTableModel *model)
+void MainWindow::exportToCsv(QAbstractItemModel *model)
 {
     QString fileName = Report::exportToCsvDlg(this);
     if (fileName.isEmpty()) return;
@@ -639,33 +1620,22 @@ void MainWindow::exportToCsv(QAbstractTableModel *model)
 
 /******************************************************************/
 
-void MainWindow::saveToClipboard(QSqlQuery query, const QItemSelection &sellist, QClipboard::Mode mode)
+void MainWindow::saveToClipboard(QAbstractItemModel *model, const QItemSelection &sellist, QClipboard::Mode mode)
 {
-    if (!query.isSelect() || !query.isActive()) {
-        qDebug() << "bad query";
-        return;
-    }
-
-    QString seltext;
+    // the texts are rendered when the target application pastes them
+    QClipboard *clip = QApplication::clipboard();
+    clip->setMimeData(new XTableMimeData(model, sellist), mode);
+}
 
-    for (const auto &selrange : sellist) {
-        if (!query.seek(selrange.top())) {
-            qDebug() << "Could not seek in result";
-            continue;
-        }
+/******************************************************************/
 
-        for (int rowi = selrange.top(); rowi <= selrange.bottom(); ++rowi) {
-            for(int fi = selrange.left(); fi <= selrange.right(); ++fi) {
-                if (fi != selrange.left()) seltext += "\t";
-                seltext += query.value(fi).toString();
-            }
-            seltext += "\n";
-            query.next();
-        }
+QVariant MainWindow::csvBindValue(const XCsvModel *csv, int row, int column)
+{
+    const QString text = csv->text(row, column);
+    if (text.isEmpty()) {
+        return QVariant(QVariant::String);
     }
-
-    QClipboard *clip = QApplication::clipboard();
-    clip->setText(seltext, mode);
+    return text;
 }
 
 /******************************************************************/
@@ -3,6 +3,14 @@
 
 #include "dbschemamodel.h"
 #include "dblistmodel.h"
+#include "dbrefreshmodel.h"
+#include "dbresultmodel.h"
+#include "dbresultcache.h"
+#include "dbtablemodel.h"
+#include "dbtailmodel.h"
+#include "dbhistory.h"
+#include "xsortfiltermodel.h"
+#include "xselectionstats.h"
 
 #include <QMainWindow>
 #include <QClipboard>
@@ -11,6 +19,7 @@
 
 #include <QSqlTableModel>
 #include <QSqlQuery>
+#include <QSqlRecord>
 
 #ifdef Q_WS_WIN
 #include <windows.h>
@@ -20,6 +29,8 @@
 
 QT_BEGIN_NAMESPACE
 class QTextCursor;
+class QLabel;
+class QTableView;
 QT_END_NAMESPACE
 
 namespace Ui {
@@ -27,6 +38,10 @@ class MainWindow;
 }
 
 class SimpleReportWidget;
+class HistoryWidget;
+class PlanWidget;
+class XCsvModel;
+class XFilterRow;
 
 class MainWindow : public QMainWindow
 {
@@ -34,12 +49,27 @@ class MainWindow : public QMainWindow
 
     struct MainWindowPrivate {
         DbListModel	    dblist;
-        QSqlTableModel *datatablemodel = Q_NULLPTR;
+        DbTableModel   *datatablemodel = Q_NULLPTR;
+        XFilterRow     *datafilter = Q_NULLPTR;
+        DbTailModel    *tailmodel = Q_NULLPTR;
         int			    datatablemodel_lastsort = -1;
         DbSchemaModel   schemamodel;
-        QSqlQueryModel  userquerymodel;
+        DbResultModel   resultmodel;
+        DbRefreshModel  refreshmodel;
+        QVector<int>    refreshKeys;  ///< key columns of the auto refresh
+        XSortFilterModel queryproxy;
+        XSelectionStats selectionstats;
+        DbResultCache   resultcache;
         QVariantMap     bindTypes;
         QVariantMap     bindRef;
+        QVariantMap     bindDefaults;
+        QString         queryConnectionName; ///< source of the query result
+        QString         querySql;
+        QVariantMap     queryBindings;
+        DbHistory       history;
+        DbHistoryEntry  fetchEntry;        ///< execution whose rows are fetched, recorded when the fetch ends
+        bool            fetching = false;
+        bool            storing  = false;  ///< fetched rows are written to the result cache
     };
 
 public:
@@ -59,20 +89,35 @@ private slots:
     // *** Triggers of the DbList TreeView 
     void changeCurrentTable(const QModelIndex &index);
     void showTreeDbListContextMenu(const QPoint &position);
+    void compareTable(const QModelIndex &index);
+    void copyTable(const QModelIndex &index);
+    void dumpConnection(const QModelIndex &index);
 
     // *** Data Table Tab ***
     void showDataTableContextMenu(const QPoint &position);
     void addTableRow();
     void delTableRow();
     void copyTableData();
+    void pasteTableRows();
+    void filterTableData();
+    void setTailTableData(bool enabled);
     void exportTableToCsv();
     void refreshTableData();
     void saveTableData();
     void revertTableData();
     void sortDataTable(int logicalIndex);
+    void setLazyTableData(bool enabled);
+    void viewTableValue(const QModelIndex &index);
 
     // *** Query Tab ***
     void runQuery();
+    void refreshQuery();
+    void setAutoRefresh(bool enabled);
+    void storeFetchedRows(const QVector<DbResultModel::Row> &rows);
+    void finishFetch(bool complete);
+    void runBatchQuery();
+    void runFanOutQuery();
+    void explainQuery();
     void copyQueryResult();
     void exportQueryToCsv();
     void clearQueryResult();
@@ -80,21 +125,38 @@ private slots:
     void saveQueryToFile();
 
     void setTableHeaders();
+    void updateSelectionStats();
+    void showSelectionStats(const XSelectionStats::Result &result);
+    void showQueryHeaderContextMenu(const QPoint &position);
+    void profileColumn(QTableView *view, int column);
+
+    // *** History Tab ***
+    void openHistoryQuery(const QString &connection, const QString &sql, const QVariantMap &binds);
 
 private:
     void setupUI();
     void setupIcons();
     void setupActions();
+    DbConnection *queryConnection();
+    void executeQuery(bool refresh);
+    void showQueryMessage(const QString &text);
+    void showResultModel(const QSqlRecord &rec = QSqlRecord());
+    void setColumnFormatters(QTableView *view, const QSqlRecord &rec);
     QVariantMap setBindValues(const QStringList &params, DbConnection *dbc);
-    void exportToCsv(QAbstractTableModel *model);
+    void exportToCsv(QAbstractItemModel *model);
 
 private: // static
-    static void saveToClipboard(QSqlQuery query, const QItemSelection &sellist, QClipboard::Mode mode);
+    static void saveToClipboard(QAbstractItemModel *model, const QItemSelection &sellist, QClipboard::Mode mode);
+    static QVector<int> fieldLengths(const QSqlRecord &rec);
+    static QVariant csvBindValue(const XCsvModel *csv, int row, int column);
     static bool launch(const QUrl &url, const QString &client);
 
 private:
     Ui::MainWindow *ui;
     SimpleReportWidget *simpleReportTab;
+    PlanWidget *planTab;
+    HistoryWidget *historyTab;
+    QLabel *selectionStatsLabel;
     MainWindowPrivate d;
 };
 
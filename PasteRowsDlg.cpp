@@ -0,0 +1,262 @@
+#include "PasteRowsDlg.h"
+
+#include "dbupsert.h"
+#include "dbtablemodel.h"
+#include "xcsvmodel.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QBuffer>
+#include <QMessageBox>
+#include <QProgressDialog>
+
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QLabel>
+#include <QTableWidget>
+#include <QHeaderView>
+
+/******************************************************************/
+
+PasteRowsDlg::PasteRowsDlg(QSqlDatabase db, const QString &table, QWidget *parent) :
+    QDialog(parent)
+{
+    d.db = db;
+    d.table = table;
+    d.record = db.record(table);
+    d.upsert = new DbUpsert(db, table, this);
+    setupUI();
+    loadFromClipboard();
+}
+
+/******************************************************************/
+
+void PasteRowsDlg::loadFromClipboard()
+{
+    d.sourceText = QApplication::clipboard()->text();
+
+    // spreadsheets put tab separated text, a first line of field names is a header
+    const QString line = d.sourceText.section('\n', 0, 0);
+    const QChar separator = line.contains('\t') || !line.contains(',') ? QChar('\t') : QChar(',');
+    const QSignalBlocker blocker(ui_Separator);
+    const QSignalBlocker headerBlocker(ui_WithHeader);
+    ui_Separator->setCurrentIndex(ui_Separator->findData(separator));
+    ui_WithHeader->setChecked(isHeader(line, separator));
+    parseSource();
+}
+
+/******************************************************************/
+
+void PasteRowsDlg::parseSource()
+{
+    ui_Preview->clear();
+    ui_Preview->setRowCount(0);
+    ui_Preview->setColumnCount(0);
+    ui_Apply->setEnabled(false);
+
+    QByteArray data = d.sourceText.toUtf8();
+    QBuffer buffer(&data);
+
+    XCsvModel csv;
+    csv.setQuoteMode(XCsvModel::DoubleQuote | XCsvModel::TwoQuoteEscape);
+    csv.setSource(&buffer, ui_WithHeader->isChecked(), ui_Separator->currentData().toChar());
+    if (csv.rowCount() == 0) {
+        showError(tr("The clipboard holds no rows."));
+        return;
+    }
+
+    // columns are matched by the header or else by position
+    QStringList fields;
+    for (int c = 0; c < csv.columnCount(); ++c) {
+        if (ui_WithHeader->isChecked()) {
+            fields << csv.headerText(c).trimmed();
+        } else if (c < d.record.count()) {
+            fields << d.record.fieldName(c);
+        } else {
+            showError(tr("The rows have more columns than %1.").arg(d.table));
+            return;
+        }
+    }
+
+    QVector<QStringList> rows;
+    rows.reserve(csv.rowCount());
+    for (int r = 0; r < csv.rowCount(); ++r) {
+        QStringList row;
+        for (int c = 0; c < fields.size(); ++c) {
+            row << csv.text(r, c);
+        }
+        rows << row;
+    }
+
+    QString err;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const bool ok = d.upsert->setRows(fields, rows, &err) && d.upsert->classify(&err);
+    QApplication::restoreOverrideCursor();
+    if (!ok) {
+        showError(err);
+        return;
+    }
+
+    const int shown = qMin(rows.size(), int(PreviewRows));
+    ui_Preview->setColumnCount(fields.size() + 1);
+    ui_Preview->setHorizontalHeaderLabels(QStringList() << tr("Status") << fields);
+    ui_Preview->setRowCount(shown);
+    for (int r = 0; r < shown; ++r) {
+        QString status;
+        QColor color;
+        switch (d.upsert->state(r)) {
+        case DbUpsert::New:
+            status = tr("new");
+            color = QColor(200, 255, 200);
+            break;
+        case DbUpsert::Changed:
+            status = tr("changed");
+            color = QColor(255, 240, 180);
+            break;
+        case DbUpsert::Unchanged:
+            status = tr("unchanged");
+            break;
+        }
+        auto item = new QTableWidgetItem(status);
+        if (color.isValid()) {
+            item->setBackground(color);
+        }
+        ui_Preview->setItem(r, 0, item);
+        for (int c = 0; c < fields.size(); ++c) {
+            ui_Preview->setItem(r, c + 1, new QTableWidgetItem(rows.at(r).at(c)));
+        }
+    }
+
+    const int added = d.upsert->count(DbUpsert::New);
+    const int changed = d.upsert->count(DbUpsert::Changed);
+    QString status = tr("%1 new, %2 changed, %3 unchanged rows")
+            .arg(added).arg(changed).arg(d.upsert->count(DbUpsert::Unchanged));
+    if (rows.size() > shown) {
+        status += tr(", the first %1 are shown").arg(shown);
+    }
+    ui_Status->setText(status);
+    ui_Apply->setEnabled(added + changed > 0);
+}
+
+/******************************************************************/
+
+void PasteRowsDlg::apply()
+{
+    QProgressDialog progress(tr("Writing rows..."), QString(), 0, 0, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    connect(d.upsert, &DbUpsert::progress, &progress, [&progress](int done, int total){
+        progress.setMaximum(total);
+        progress.setValue(done);
+    });
+
+    QString err;
+    const bool ok = d.upsert->apply(ui_BatchSize->value(), &err);
+    progress.reset();
+    if (ok) {
+        accept();
+        return;
+    }
+
+    const int row = d.upsert->failedRow();
+    if (row >= 0 && row < ui_Preview->rowCount()) {
+        ui_Preview->selectRow(row);
+        ui_Preview->scrollToItem(ui_Preview->item(row, 0));
+    }
+    QMessageBox::warning(this, windowTitle(),
+                         tr("The batch from row %1 could not be written, no rows were changed.\n%2")
+                         .arg(row + 1).arg(err));
+}
+
+/******************************************************************/
+
+void PasteRowsDlg::setupUI()
+{
+    setWindowTitle(tr("Paste Rows into %1").arg(d.table));
+
+    auto clipButton = new QPushButton(QIcon::fromTheme("edit-paste"), tr("Paste Again"), this);
+
+    ui_Separator = new QComboBox(this);
+    ui_Separator->addItem(tr("Comma"), QChar(','));
+    ui_Separator->addItem(tr("Semicolon"), QChar(';'));
+    ui_Separator->addItem(tr("Tab"), QChar('\t'));
+
+    ui_WithHeader = new QCheckBox(tr("First row is header"), this);
+
+    auto sourceLayout = new QHBoxLayout();
+    sourceLayout->addWidget(clipButton);
+    sourceLayout->addWidget(ui_Separator);
+    sourceLayout->addWidget(ui_WithHeader);
+    sourceLayout->addStretch();
+
+    ui_Status = new QLabel(this);
+    ui_Status->setWordWrap(true);
+
+    ui_Preview = new QTableWidget(this);
+    ui_Preview->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui_Preview->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui_Preview->horizontalHeader()->setStretchLastSection(true);
+
+    ui_BatchSize = new QSpinBox(this);
+    ui_BatchSize->setRange(1, 1000000);
+    ui_BatchSize->setValue(DbTableModel::submitBatchSize());
+    ui_BatchSize->setToolTip(d.upsert->hasUpsert()
+                             ? tr("Rows are written with the upsert statement of the database")
+                             : tr("New rows are inserted, changed rows are updated"));
+
+    auto batchLayout = new QFormLayout();
+    batchLayout->addRow(tr("Rows per batch"), ui_BatchSize);
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Cancel, this);
+    ui_Apply = buttonBox->addButton(tr("Apply"), QDialogButtonBox::AcceptRole);
+
+    auto mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(sourceLayout);
+    mainLayout->addWidget(ui_Status);
+    mainLayout->addWidget(ui_Preview);
+    mainLayout->addLayout(batchLayout);
+    mainLayout->addWidget(buttonBox);
+
+    resize(800, 500);
+
+    connect(clipButton, &QPushButton::clicked,
+            this, &PasteRowsDlg::loadFromClipboard);
+    connect(ui_Separator, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &PasteRowsDlg::parseSource);
+    connect(ui_WithHeader, &QCheckBox::toggled,
+            this, &PasteRowsDlg::parseSource);
+    connect(buttonBox, &QDialogButtonBox::accepted,
+            this, &PasteRowsDlg::apply);
+    connect(buttonBox, &QDialogButtonBox::rejected,
+            this, &QDialog::reject);
+}
+
+/******************************************************************/
+
+void PasteRowsDlg::showError(const QString &err)
+{
+    ui_Status->setText(QString("<font color=red>%1</font>").arg(err.toHtmlEscaped()));
+}
+
+/******************************************************************/
+//! every cell of the line is a field of the table
+bool PasteRowsDlg::isHeader(const QString &line, QChar separator) const
+{
+    const QStringList cells = line.trimmed().split(separator);
+    for (const auto &cell : cells) {
+        QString name = cell.trimmed();
+        if (name.startsWith('"') && name.endsWith('"') && name.size() > 1) {
+            name = name.mid(1, name.size() - 2);
+        }
+        if (d.record.indexOf(name) < 0) return false;
+    }
+    return !cells.isEmpty();
+}
+
+/******************************************************************/
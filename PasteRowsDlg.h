@@ -0,0 +1,58 @@
+#ifndef PASTEROWSDLG_H
+#define PASTEROWSDLG_H
+
+#include <QDialog>
+#include <QSqlDatabase>
+#include <QSqlRecord>
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QPushButton;
+class QSpinBox;
+class QTableWidget;
+QT_END_NAMESPACE
+
+class DbUpsert;
+
+class PasteRowsDlg : public QDialog
+{
+    Q_OBJECT
+
+    struct PasteRowsDlgPrivate {
+        QSqlDatabase db;
+        QString      table;
+        QSqlRecord   record;
+        QString      sourceText;  ///< clipboard text
+        DbUpsert    *upsert = Q_NULLPTR;
+    };
+
+public:
+    enum {
+        PreviewRows = 1000
+    };
+
+    PasteRowsDlg(QSqlDatabase db, const QString &table, QWidget *parent = nullptr);
+
+private Q_SLOTS:
+    void loadFromClipboard();
+    void parseSource();
+    void apply();
+
+private:
+    void setupUI();
+    void showError(const QString &err);
+    bool isHeader(const QString &line, QChar separator) const;
+
+private:
+    QComboBox    *ui_Separator;
+    QCheckBox    *ui_WithHeader;
+    QLabel       *ui_Status;
+    QTableWidget *ui_Preview;
+    QSpinBox     *ui_BatchSize;
+    QPushButton  *ui_Apply;
+    PasteRowsDlgPrivate d;
+};
+
+#endif // PASTEROWSDLG_H
@@ -0,0 +1,113 @@
+#include "PlanWidget.h"
+
+#include <QLabel>
+#include <QComboBox>
+#include <QTreeView>
+#include <QHeaderView>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+/******************************************************************/
+
+PlanWidget::PlanWidget(DbHistory *history, QWidget *parent) :
+    QWidget(parent)
+{
+    d.history = history;
+    setupUI();
+}
+
+/******************************************************************/
+
+void PlanWidget::showPlan(const QString &sql, const DbPlanNode &plan)
+{
+    d.model.setPlan(plan);
+    d.baselines.clear();
+    if (d.history) {
+        d.baselines = d.history->plans(DbHistory::fingerprint(sql));
+    }
+
+    QSignalBlocker blocker(ui_Baseline);
+    ui_Baseline->clear();
+    ui_Baseline->addItem(tr("No comparison"));
+    for (const auto &baseline : qAsConst(d.baselines)) {
+        ui_Baseline->addItem(QString("%1 (%2)").arg(baseline.executed.toString("yyyy-MM-dd hh:mm:ss"),
+                                                    baseline.connection));
+    }
+    ui_Baseline->setEnabled(!d.baselines.isEmpty());
+
+    int fullScans = 0;
+    QList<const DbPlanNode *> nodes;
+    nodes << &d.model.plan();
+    while (!nodes.isEmpty()) {
+        const DbPlanNode *node = nodes.takeFirst();
+        if (node->fullScan) ++fullScans;
+        for (const auto &child : node->children) {
+            nodes << &child;
+        }
+    }
+
+    QString summary = plan.actualMs >= 0
+            ? tr("Execution time: %1 ms").arg(plan.actualMs, 0, 'f', 2)
+            : tr("Estimated cost: %1").arg(plan.cost >= 0 ? QString::number(plan.cost, 'f', 2) : tr("n/a"));
+    if (fullScans) {
+        summary += tr(", full scans: %1").arg(fullScans);
+    }
+    ui_Summary->setText(summary);
+
+    updateView();
+}
+
+/******************************************************************/
+
+void PlanWidget::selectBaseline(int index)
+{
+    if (index <= 0 || index > d.baselines.size()) {
+        d.model.clearBaseline();
+    } else {
+        d.model.setBaseline(DbPlanNode::fromJson(d.baselines.at(index - 1).plan));
+    }
+    updateView();
+}
+
+/******************************************************************/
+
+void PlanWidget::setupUI()
+{
+    ui_Summary = new QLabel(this);
+
+    ui_Baseline = new QComboBox(this);
+    ui_Baseline->setToolTip(tr("Earlier plan of the same statement"));
+    ui_Baseline->setEnabled(false);
+
+    auto toolLayout = new QHBoxLayout();
+    toolLayout->addWidget(ui_Summary);
+    toolLayout->addStretch();
+    toolLayout->addWidget(new QLabel(tr("Compare with"), this));
+    toolLayout->addWidget(ui_Baseline);
+
+    ui_Tree = new QTreeView(this);
+    ui_Tree->setModel(&d.model);
+    ui_Tree->setAlternatingRowColors(true);
+    ui_Tree->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    auto mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(toolLayout);
+    mainLayout->addWidget(ui_Tree);
+
+    connect(ui_Baseline, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &PlanWidget::selectBaseline);
+}
+
+/******************************************************************/
+
+void PlanWidget::updateView()
+{
+    ui_Tree->expandAll();
+    for (int c = 0; c < d.model.columnCount(); ++c) {
+        ui_Tree->resizeColumnToContents(c);
+    }
+    // conditions may be long
+    ui_Tree->setColumnWidth(1, qMin(ui_Tree->columnWidth(1), 400));
+}
+
+/******************************************************************/
@@ -0,0 +1,45 @@
+#ifndef PLANWIDGET_H
+#define PLANWIDGET_H
+
+#include "dbplanmodel.h"
+#include "dbhistory.h"
+
+#include <QWidget>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QComboBox;
+class QTreeView;
+QT_END_NAMESPACE
+
+class PlanWidget : public QWidget
+{
+    Q_OBJECT
+
+    struct PlanWidgetPrivate {
+        DbHistory           *history = Q_NULLPTR;
+        DbPlanModel          model;
+        QList<DbHistoryPlan> baselines; ///< earlier plans of the same fingerprint
+    };
+
+public:
+    explicit PlanWidget(DbHistory *history, QWidget *parent = nullptr);
+
+    /// shows the plan of sql, earlier plans of the statement are offered for comparison
+    void showPlan(const QString &sql, const DbPlanNode &plan);
+
+private Q_SLOTS:
+    void selectBaseline(int index);
+
+private:
+    void setupUI();
+    void updateView();
+
+private:
+    QLabel    *ui_Summary;
+    QComboBox *ui_Baseline;
+    QTreeView *ui_Tree;
+    PlanWidgetPrivate d;
+};
+
+#endif // PLANWIDGET_H
@@ -0,0 +1,262 @@
+#include "ProfileDlg.h"
+
+#include "dbdialect.h"
+
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QtConcurrent>
+
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QSpinBox>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QTableWidget>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QFormLayout>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QVBoxLayout>
+#include <QtWidgets/QDialogButtonBox>
+
+#include <algorithm>
+#include <limits>
+
+enum {
+    ProgressMs = 250,
+    BarWidth   = 40   ///< characters of the longest histogram bar
+};
+
+/******************************************************************/
+
+ProfileDlg::ProfileDlg(const QString &column, QWidget *parent) :
+    QDialog(parent)
+{
+    setWindowTitle(tr("Profile of %1").arg(column));
+    setupUI();
+
+    d.progress.setInterval(ProgressMs);
+    connect(&d.progress, &QTimer::timeout,
+            this, &ProfileDlg::updateProgress);
+    connect(&d.watcher, &QFutureWatcher<DbColumnProfile>::finished,
+            this, &ProfileDlg::showProfile);
+}
+
+/******************************************************************/
+//! the worker only shares the flags, it finishes on its own
+ProfileDlg::~ProfileDlg()
+{
+    if (d.canceled) {
+        d.canceled->storeRelaxed(1);
+    }
+}
+
+/******************************************************************/
+
+void ProfileDlg::setQuery(const QString &connectionName, const QString &sql, const QVariantMap &bindings, int column)
+{
+    d.connectionName = connectionName;
+    d.sql            = sql;
+    d.bindings       = bindings;
+    d.column         = column;
+    d.limitOnServer  = false;
+}
+
+/******************************************************************/
+
+void ProfileDlg::setTable(const QString &connectionName, const QString &table, const QString &field)
+{
+    const QSqlDriver *driver = QSqlDatabase::database(connectionName, false).driver();
+    d.connectionName = connectionName;
+    d.sql = QString("SELECT %1 FROM %2")
+            .arg(driver->escapeIdentifier(field, QSqlDriver::FieldName),
+                 driver->escapeIdentifier(table, QSqlDriver::TableName));
+    d.bindings.clear();
+    d.column        = 0;
+    d.limitOnServer = true;
+}
+
+/******************************************************************/
+
+void ProfileDlg::start()
+{
+    stop();
+
+    const qint64 limit = ui_Limit->value();
+    QString sql = d.sql;
+    if (limit && d.limitOnServer) {
+        sql = Db::limitSql(QSqlDatabase::database(d.connectionName, false).driverName(), sql, int(limit));
+    }
+
+    d.canceled = QSharedPointer<QAtomicInt>::create(0);
+    d.rowsRead = QSharedPointer<QAtomicInteger<qint64>>::create(0);
+    const QString connectionName = d.connectionName;
+    const QVariantMap bindings = d.bindings;
+    const int column = d.column;
+    QSharedPointer<QAtomicInt> canceled = d.canceled;
+    QSharedPointer<QAtomicInteger<qint64>> rowsRead = d.rowsRead;
+    d.watcher.setFuture(QtConcurrent::run([=](){
+        return DbColumnProfiler::run(connectionName, sql, bindings, column, limit,
+                                     canceled.data(), rowsRead.data());
+    }));
+
+    d.elapsed.start();
+    d.progress.start();
+    ui_Start->setText(tr("Stop"));
+    updateProgress();
+}
+
+/******************************************************************/
+//! the worker returns the profile of the rows read so far
+void ProfileDlg::stop()
+{
+    if (d.canceled) {
+        d.canceled->storeRelaxed(1);
+    }
+}
+
+/******************************************************************/
+
+void ProfileDlg::reject()
+{
+    stop();
+    QDialog::reject();
+}
+
+/******************************************************************/
+
+void ProfileDlg::updateProgress()
+{
+    if (!d.rowsRead) return;
+    ui_Status->setText(tr("Reading... %1 rows in %2 s")
+                       .arg(d.rowsRead->loadRelaxed())
+                       .arg(d.elapsed.elapsed() / 1000.0, 0, 'f', 1));
+}
+
+/******************************************************************/
+
+void ProfileDlg::showProfile()
+{
+    d.progress.stop();
+    d.canceled.reset();
+    d.rowsRead.reset();
+    ui_Start->setText(tr("Start"));
+
+    const DbColumnProfile profile = d.watcher.result();
+    if (!profile.error.isEmpty()) {
+        ui_Status->setText(profile.error);
+        return;
+    }
+
+    ui_Status->setText(tr("%1 rows in %2 s%3")
+                       .arg(profile.rows)
+                       .arg(d.elapsed.elapsed() / 1000.0, 0, 'f', 1)
+                       .arg(profile.partial ? tr(", stopped") : QString()));
+    ui_Rows->setText(QString::number(profile.rows));
+    ui_Nulls->setText(tr("%1 (%2%)").arg(profile.nulls).arg(profile.nullRatio() * 100, 0, 'f', 1));
+    ui_Distinct->setText(tr("~%1").arg(qRound64(profile.distinct)));
+    ui_Min->setText(profile.min);
+    ui_Max->setText(profile.max);
+
+    ui_Top->setRowCount(profile.top.size());
+    for (int i = 0; i < profile.top.size(); ++i) {
+        const auto &item = profile.top.at(i);
+        ui_Top->setItem(i, 0, new QTableWidgetItem(item.first));
+        auto countItem = new QTableWidgetItem(QString::number(item.second));
+        countItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        ui_Top->setItem(i, 1, countItem);
+    }
+    ui_Top->resizeColumnsToContents();
+
+    const int bins = profile.histogram.size();
+    const qint64 highest = bins ? *std::max_element(profile.histogram.constBegin(), profile.histogram.constEnd()) : 0;
+    const double width = bins ? (profile.histMax - profile.histMin) / bins : 0;
+    ui_Histogram->setRowCount(bins);
+    for (int i = 0; i < bins; ++i) {
+        const qint64 count = profile.histogram.at(i);
+        const double from = profile.histMin + i * width;
+        ui_Histogram->setItem(i, 0, new QTableWidgetItem(QString("%1 .. %2")
+                                                         .arg(from, 0, 'g', 6)
+                                                         .arg(from + width, 0, 'g', 6)));
+        auto countItem = new QTableWidgetItem(QString::number(count));
+        countItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        ui_Histogram->setItem(i, 1, countItem);
+        const int bar = highest ? int(count * BarWidth / highest) : 0;
+        ui_Histogram->setItem(i, 2, new QTableWidgetItem(QString(bar, QChar(0x2588))));
+    }
+    ui_Histogram->resizeColumnsToContents();
+}
+
+/******************************************************************/
+
+void ProfileDlg::setupUI()
+{
+    ui_Limit = new QSpinBox(this);
+    ui_Limit->setRange(0, std::numeric_limits<int>::max());
+    ui_Limit->setSingleStep(100000);
+    ui_Limit->setSpecialValueText(tr("All rows"));
+    ui_Limit->setToolTip(tr("Profile only the first rows"));
+
+    ui_Start = new QPushButton(tr("Start"), this);
+    ui_Status = new QLabel(this);
+
+    auto toolLayout = new QHBoxLayout();
+    toolLayout->addWidget(new QLabel(tr("Rows"), this));
+    toolLayout->addWidget(ui_Limit);
+    toolLayout->addWidget(ui_Start);
+    toolLayout->addWidget(ui_Status, 1);
+
+    ui_Rows     = new QLabel(this);
+    ui_Nulls    = new QLabel(this);
+    ui_Distinct = new QLabel(this);
+    ui_Min      = new QLabel(this);
+    ui_Max      = new QLabel(this);
+    for (QLabel *label : QList<QLabel*>() << ui_Min << ui_Max) {
+        label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    }
+    ui_Distinct->setToolTip(tr("HyperLogLog estimate, about 1% error"));
+
+    auto summaryLayout = new QFormLayout();
+    summaryLayout->addRow(tr("Rows:"), ui_Rows);
+    summaryLayout->addRow(tr("Nulls:"), ui_Nulls);
+    summaryLayout->addRow(tr("Distinct:"), ui_Distinct);
+    summaryLayout->addRow(tr("Min:"), ui_Min);
+    summaryLayout->addRow(tr("Max:"), ui_Max);
+
+    ui_Top = new QTableWidget(0, 2, this);
+    ui_Top->setHorizontalHeaderLabels(QStringList() << tr("Top value") << tr("Count"));
+    ui_Top->setToolTip(tr("Counts of rare values may be overestimated"));
+
+    ui_Histogram = new QTableWidget(0, 3, this);
+    ui_Histogram->setHorizontalHeaderLabels(QStringList() << tr("Range") << tr("Count") << QString());
+    ui_Histogram->setToolTip(tr("Estimated from a sample of the numeric values"));
+
+    for (QTableWidget *table : QList<QTableWidget*>() << ui_Top << ui_Histogram) {
+        table->verticalHeader()->hide();
+        table->horizontalHeader()->setStretchLastSection(true);
+        table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    }
+
+    auto resultLayout = new QHBoxLayout();
+    resultLayout->addLayout(summaryLayout);
+    resultLayout->addWidget(ui_Top, 1);
+    resultLayout->addWidget(ui_Histogram, 2);
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+
+    auto mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(toolLayout);
+    mainLayout->addLayout(resultLayout);
+    mainLayout->addWidget(buttonBox);
+
+    resize(900, 400);
+
+    connect(ui_Start, &QPushButton::clicked, this, [this](){
+        if (d.canceled) {
+            stop();
+        } else {
+            start();
+        }
+    });
+    connect(buttonBox, &QDialogButtonBox::rejected,
+            this, &ProfileDlg::reject);
+}
+
+/******************************************************************/
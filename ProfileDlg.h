@@ -0,0 +1,73 @@
+#ifndef PROFILEDLG_H
+#define PROFILEDLG_H
+
+#include "dbprofile.h"
+
+#include <QDialog>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QSpinBox;
+class QPushButton;
+class QTableWidget;
+QT_END_NAMESPACE
+
+class ProfileDlg : public QDialog
+{
+    Q_OBJECT
+
+    struct ProfileDlgPrivate {
+        QString     connectionName;
+        QString     sql;
+        QVariantMap bindings;
+        int         column = 0;
+        bool        limitOnServer = false;  ///< sql is a plain select of the column
+        QSharedPointer<QAtomicInt>             canceled;
+        QSharedPointer<QAtomicInteger<qint64>> rowsRead;
+        QFutureWatcher<DbColumnProfile>        watcher;
+        QElapsedTimer elapsed;
+        QTimer        progress;
+    };
+
+public:
+    explicit ProfileDlg(const QString &column, QWidget *parent = nullptr);
+    ~ProfileDlg();
+
+    /// profiles the column of the result of sql
+    void setQuery(const QString &connectionName, const QString &sql, const QVariantMap &bindings, int column);
+    /// profiles a column of a table, the row limit is applied by the server
+    void setTable(const QString &connectionName, const QString &table, const QString &field);
+
+public Q_SLOTS:
+    void start();
+    void stop();
+
+protected:
+    void reject() override;
+
+private Q_SLOTS:
+    void updateProgress();
+    void showProfile();
+
+private:
+    void setupUI();
+
+private:
+    QSpinBox     *ui_Limit;
+    QPushButton  *ui_Start;
+    QLabel       *ui_Status;
+    QLabel       *ui_Rows;
+    QLabel       *ui_Nulls;
+    QLabel       *ui_Distinct;
+    QLabel       *ui_Min;
+    QLabel       *ui_Max;
+    QTableWidget *ui_Top;
+    QTableWidget *ui_Histogram;
+    ProfileDlgPrivate d;
+};
+
+#endif // PROFILEDLG_H
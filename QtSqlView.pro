@@ -1,4 +1,4 @@
-QT += core gui sql xml printsupport
+QT += core gui sql xml printsupport concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -20,18 +20,38 @@ TARGET = QtSqlView
 include("common/common.pri")
 
 SOURCES += \
+    BatchParamDlg.cpp \
     ConnectionDlg.cpp \
+    CopyTableDlg.cpp \
+    DumpDlg.cpp \
+    FanOutDlg.cpp \
+    HistoryWidget.cpp \
     MainWindow.cpp \
+    PasteRowsDlg.cpp \
+    PlanWidget.cpp \
+    ProfileDlg.cpp \
     QueryParamDlg.cpp \
+    TableDiffDlg.cpp \
     TableHeadersDlg.cpp \
+    ValueViewerDlg.cpp \
     main.cpp \
     simplereportwidget.cpp
 
 HEADERS += \
+    BatchParamDlg.h \
     ConnectionDlg.h \
+    CopyTableDlg.h \
+    DumpDlg.h \
+    FanOutDlg.h \
+    HistoryWidget.h \
     MainWindow.h \
+    PasteRowsDlg.h \
+    PlanWidget.h \
+    ProfileDlg.h \
     QueryParamDlg.h \
+    TableDiffDlg.h \
     TableHeadersDlg.h \
+    ValueViewerDlg.h \
     simplereportwidget.h
 
 FORMS += \
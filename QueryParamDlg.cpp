@@ -117,7 +117,7 @@ void QueryParamDlg::fillReference(QComboBox *cmb, const QString &param)
 {
     QString sql = d.bindSql.value(param).toString();
     bool ok = false;
-    bool done = Report::fillSqlRef(cmb, sql, d.dbConn->db);
+    bool done = Report::setupSqlRef(cmb, sql, d.dbConn->db);
     while (!done) {
         sql = QInputDialog::getMultiLineText(this, tr("Reference"), tr("SQL"), sql, &ok);
         if (!ok) break; // canceled
@@ -126,7 +126,7 @@ void QueryParamDlg::fillReference(QComboBox *cmb, const QString &param)
                                  tr("Error in SQL\nSQL text is Empty"));
         } else {
             QString err;
-            done = Report::fillSqlRef(cmb, sql,  d.dbConn->db, &err);
+            done = Report::setupSqlRef(cmb, sql, d.dbConn->db, &err);
             if (done) {
                 d.bindSql.insert(param, sql);
             }
@@ -0,0 +1,219 @@
+#include "TableDiffDlg.h"
+
+#include <QtConcurrent>
+
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QTableWidget>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QFormLayout>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QVBoxLayout>
+#include <QtWidgets/QDialogButtonBox>
+
+enum {
+    ProgressMs = 250
+};
+
+/******************************************************************/
+
+TableDiffDlg::TableDiffDlg(const QString &sourceLabel, const QString &sourceConnection, const QString &table,
+                           QWidget *parent) :
+    QDialog(parent)
+{
+    d.sourceConnection = sourceConnection;
+    d.sourceTable      = table;
+    setWindowTitle(tr("Compare %1").arg(table));
+    setupUI(sourceLabel);
+    ui_TargetTable->setText(table);
+
+    d.timer.setInterval(ProgressMs);
+    connect(&d.timer, &QTimer::timeout,
+            this, &TableDiffDlg::updateProgress);
+    connect(&d.watcher, &QFutureWatcher<DbTableDiffResult>::finished,
+            this, &TableDiffDlg::showDiff);
+}
+
+/******************************************************************/
+//! the worker only shares the flags, it finishes on its own
+TableDiffDlg::~TableDiffDlg()
+{
+    if (d.canceled) {
+        d.canceled->storeRelaxed(1);
+    }
+}
+
+/******************************************************************/
+
+void TableDiffDlg::addTarget(const QString &label, const QString &connectionName)
+{
+    ui_Target->addItem(label, connectionName);
+}
+
+/******************************************************************/
+
+void TableDiffDlg::start()
+{
+    stop();
+    if (ui_Target->currentIndex() < 0) return;
+
+    d.canceled = QSharedPointer<QAtomicInt>::create(0);
+    d.progress = QSharedPointer<QAtomicInteger<qint64>>::create(0);
+    const QString sourceConnection = d.sourceConnection;
+    const QString sourceTable = d.sourceTable;
+    const QString targetConnection = ui_Target->currentData().toString();
+    const QString targetTable = ui_TargetTable->text().trimmed();
+    QSharedPointer<QAtomicInt> canceled = d.canceled;
+    QSharedPointer<QAtomicInteger<qint64>> progress = d.progress;
+    d.watcher.setFuture(QtConcurrent::run([=](){
+        DbTableDiff diff(sourceConnection, sourceTable, targetConnection, targetTable);
+        return diff.run(canceled.data(), progress.data());
+    }));
+
+    ui_Rows->clear();
+    ui_Rows->setRowCount(0);
+    ui_Rows->setColumnCount(0);
+    d.elapsed.start();
+    d.timer.start();
+    ui_Start->setText(tr("Stop"));
+    updateProgress();
+}
+
+/******************************************************************/
+
+void TableDiffDlg::stop()
+{
+    if (d.canceled) {
+        d.canceled->storeRelaxed(1);
+    }
+}
+
+/******************************************************************/
+
+void TableDiffDlg::reject()
+{
+    stop();
+    QDialog::reject();
+}
+
+/******************************************************************/
+
+void TableDiffDlg::updateProgress()
+{
+    if (!d.progress) return;
+    ui_Status->setText(tr("Comparing... %1 ranges checksummed in %2 s")
+                       .arg(d.progress->loadRelaxed())
+                       .arg(d.elapsed.elapsed() / 1000.0, 0, 'f', 1));
+}
+
+/******************************************************************/
+
+void TableDiffDlg::showDiff()
+{
+    d.timer.stop();
+    d.canceled.reset();
+    d.progress.reset();
+    ui_Start->setText(tr("Compare"));
+
+    const DbTableDiffResult result = d.watcher.result();
+    if (!result.error.isEmpty()) {
+        ui_Status->setText(result.error);
+        return;
+    }
+
+    QString status = result.rows.isEmpty() && !result.partial
+            ? tr("Tables match, %1 rows in %2 s").arg(result.sourceRows)
+            : tr("%1 differences, %2 rows in %3 s").arg(result.rows.size()).arg(result.sourceRows);
+    status = status.arg(d.elapsed.elapsed() / 1000.0, 0, 'f', 1);
+    status += tr(", %1 chunks, %2 leaf ranges fetched, %3 checksums")
+            .arg(result.chunks)
+            .arg(result.mismatched)
+            .arg(result.serverHash ? tr("server") : tr("client"));
+    if (result.partial) {
+        status += tr(", incomplete");
+    }
+    ui_Status->setText(status);
+
+    ui_Rows->setColumnCount(result.fields.size() + 1);
+    ui_Rows->setHorizontalHeaderLabels(QStringList(tr("Difference")) << result.fields);
+    ui_Rows->setRowCount(result.rows.size());
+    const QColor changedColor(255, 224, 96, 120);
+    for (int r = 0; r < result.rows.size(); ++r) {
+        const DbRowDiff &diff = result.rows.at(r);
+        QString kind;
+        switch (diff.kind) {
+        case DbRowDiff::Missing:
+            kind = tr("Missing in target");
+            break;
+        case DbRowDiff::Extra:
+            kind = tr("Only in target");
+            break;
+        case DbRowDiff::Changed:
+            kind = tr("Changed");
+            break;
+        }
+        ui_Rows->setItem(r, 0, new QTableWidgetItem(kind));
+
+        const DbTableDiff::Row &row = diff.kind == DbRowDiff::Extra ? diff.target : diff.source;
+        for (int c = 0; c < row.size(); ++c) {
+            auto item = new QTableWidgetItem(row.at(c).toString());
+            if (diff.kind == DbRowDiff::Changed && diff.changed.testBit(c)) {
+                item->setText(QString("%1 %2 %3").arg(row.at(c).toString(), QChar(0x2192), diff.target.at(c).toString()));
+                item->setBackground(changedColor);
+            }
+            ui_Rows->setItem(r, c + 1, item);
+        }
+    }
+    ui_Rows->resizeColumnsToContents();
+}
+
+/******************************************************************/
+
+void TableDiffDlg::setupUI(const QString &sourceLabel)
+{
+    ui_Target = new QComboBox(this);
+    ui_TargetTable = new QLineEdit(this);
+    ui_TargetTable->setToolTip(tr("Name of the table on the target connection"));
+
+    auto formLayout = new QFormLayout();
+    formLayout->addRow(tr("Source:"), new QLabel(QString("%1 / %2").arg(sourceLabel, d.sourceTable), this));
+    formLayout->addRow(tr("Target:"), ui_Target);
+    formLayout->addRow(tr("Target table:"), ui_TargetTable);
+
+    ui_Start = new QPushButton(tr("Compare"), this);
+    ui_Status = new QLabel(this);
+    ui_Status->setWordWrap(true);
+
+    auto toolLayout = new QHBoxLayout();
+    toolLayout->addWidget(ui_Start);
+    toolLayout->addWidget(ui_Status, 1);
+
+    ui_Rows = new QTableWidget(0, 0, this);
+    ui_Rows->horizontalHeader()->setStretchLastSection(true);
+    ui_Rows->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui_Rows->setToolTip(tr("Changed cells show the source and the target value"));
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+
+    auto mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(formLayout);
+    mainLayout->addLayout(toolLayout);
+    mainLayout->addWidget(ui_Rows, 1);
+    mainLayout->addWidget(buttonBox);
+
+    resize(900, 500);
+
+    connect(ui_Start, &QPushButton::clicked, this, [this](){
+        if (d.canceled) {
+            stop();
+        } else {
+            start();
+        }
+    });
+    connect(buttonBox, &QDialogButtonBox::rejected,
+            this, &TableDiffDlg::reject);
+}
+
+/******************************************************************/
@@ -0,0 +1,65 @@
+#ifndef TABLEDIFFDLG_H
+#define TABLEDIFFDLG_H
+
+#include "dbtablediff.h"
+
+#include <QDialog>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QComboBox;
+class QLineEdit;
+class QPushButton;
+class QTableWidget;
+QT_END_NAMESPACE
+
+class TableDiffDlg : public QDialog
+{
+    Q_OBJECT
+
+    struct TableDiffDlgPrivate {
+        QString     sourceConnection;
+        QString     sourceTable;
+        QSharedPointer<QAtomicInt>             canceled;
+        QSharedPointer<QAtomicInteger<qint64>> progress;
+        QFutureWatcher<DbTableDiffResult>      watcher;
+        QElapsedTimer elapsed;
+        QTimer        timer;
+    };
+
+public:
+    TableDiffDlg(const QString &sourceLabel, const QString &sourceConnection, const QString &table,
+                 QWidget *parent = nullptr);
+    ~TableDiffDlg();
+
+    /// a connection to compare with
+    void addTarget(const QString &label, const QString &connectionName);
+
+public Q_SLOTS:
+    void start();
+    void stop();
+
+protected:
+    void reject() override;
+
+private Q_SLOTS:
+    void updateProgress();
+    void showDiff();
+
+private:
+    void setupUI(const QString &sourceLabel);
+
+private:
+    QComboBox    *ui_Target;
+    QLineEdit    *ui_TargetTable;
+    QPushButton  *ui_Start;
+    QLabel       *ui_Status;
+    QTableWidget *ui_Rows;
+    TableDiffDlgPrivate d;
+};
+
+#endif // TABLEDIFFDLG_H
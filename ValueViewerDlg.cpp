@@ -0,0 +1,114 @@
+#include "ValueViewerDlg.h"
+
+#include <QFile>
+#include <QMessageBox>
+#include <QFileDialog>
+
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QPlainTextEdit>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QDialogButtonBox>
+#include <QtWidgets/QVBoxLayout>
+
+enum {
+    DumpLimit   = 256 * 1024, ///< bytes shown as hex dump
+    BytesPerRow = 16
+};
+
+/******************************************************************/
+
+ValueViewerDlg::ValueViewerDlg(const QString &title, const QVariant &value, QWidget *parent) :
+    QDialog(parent)
+{
+    m_Value = value;
+    setWindowTitle(title);
+    setupUI();
+}
+
+/******************************************************************/
+
+void ValueViewerDlg::saveToFile()
+{
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Save Value"));
+    if (fileName.isEmpty()) return;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        QMessageBox::warning(this, tr("Save Value"), file.errorString());
+        return;
+    }
+    file.write(m_Value.type() == QVariant::ByteArray
+               ? m_Value.toByteArray()
+               : m_Value.toString().toUtf8());
+}
+
+/******************************************************************/
+
+void ValueViewerDlg::setupUI()
+{
+    ui_Info = new QLabel(this);
+
+    ui_Text = new QPlainTextEdit(this);
+    ui_Text->setReadOnly(true);
+    ui_Text->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    if (m_Value.isNull()) {
+        ui_Info->setText(tr("NULL"));
+    } else if (m_Value.type() == QVariant::ByteArray) {
+        const QByteArray data = m_Value.toByteArray();
+        QFont font("Courier", 10);
+        font.setFixedPitch(true);
+        ui_Text->setFont(font);
+        ui_Text->setPlainText(hexDump(data, DumpLimit));
+        ui_Info->setText(data.size() > DumpLimit
+                         ? tr("%1 bytes, the first %2 are shown").arg(data.size()).arg(int(DumpLimit))
+                         : tr("%1 bytes").arg(data.size()));
+    } else {
+        const QString text = m_Value.toString();
+        ui_Text->setPlainText(text);
+        ui_Text->setLineWrapMode(QPlainTextEdit::WidgetWidth);
+        ui_Info->setText(tr("%1 characters").arg(text.size()));
+    }
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *saveButton = buttonBox->addButton(tr("Save As..."), QDialogButtonBox::ActionRole);
+    saveButton->setEnabled(!m_Value.isNull());
+
+    auto mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(ui_Info);
+    mainLayout->addWidget(ui_Text);
+    mainLayout->addWidget(buttonBox);
+
+    resize(700, 500);
+
+    connect(saveButton, &QPushButton::clicked,
+            this, &ValueViewerDlg::saveToFile);
+    connect(buttonBox, &QDialogButtonBox::rejected,
+            this, &QDialog::reject);
+}
+
+/******************************************************************/
+
+QString ValueViewerDlg::hexDump(const QByteArray &data, int limit)
+{
+    const int size = qMin(data.size(), limit);
+    QString result;
+    result.reserve(size / BytesPerRow * 80);
+    for (int offset = 0; offset < size; offset += BytesPerRow) {
+        QString hex;
+        QString ascii;
+        for (int i = offset; i < offset + BytesPerRow; ++i) {
+            if (i < size) {
+                const uchar c = uchar(data.at(i));
+                hex += QString("%1 ").arg(c, 2, 16, QChar('0'));
+                ascii += (c >= 0x20 && c < 0x7f) ? QChar(c) : QChar('.');
+            } else {
+                hex += "   ";
+            }
+        }
+        result += QString("%1  %2 %3\n").arg(offset, 8, 16, QChar('0')).arg(hex, ascii);
+    }
+    return result;
+}
+
+/******************************************************************/
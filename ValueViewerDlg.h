@@ -0,0 +1,35 @@
+#ifndef VALUEVIEWERDLG_H
+#define VALUEVIEWERDLG_H
+
+#include <QDialog>
+#include <QVariant>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QPlainTextEdit;
+QT_END_NAMESPACE
+
+/// shows a complete cell value, binary values as hex dump
+class ValueViewerDlg : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ValueViewerDlg(const QString &title, const QVariant &value, QWidget *parent = nullptr);
+
+private Q_SLOTS:
+    void saveToFile();
+
+private:
+    void setupUI();
+
+private: // static
+    static QString hexDump(const QByteArray &data, int limit);
+
+private:
+    QVariant        m_Value;
+    QLabel         *ui_Info;
+    QPlainTextEdit *ui_Text;
+};
+
+#endif // VALUEVIEWERDLG_H
@@ -71,6 +71,7 @@ QSqlError DbConnection::connect(DbListModel *dblist)
 
 void DbConnection::disconnect(DbListModel *dblist)
 {
+    querycache.clear();
     if (db.isOpen()) {
         db.close();
         db = QSqlDatabase();
@@ -1,6 +1,8 @@
 #ifndef DBCONNECTION_H
 #define DBCONNECTION_H
 
+#include "dbquerycache.h"
+
 #include <QSettings>
 
 #ifdef USE_QUERY_DB
@@ -185,6 +187,9 @@ public:
 
     tablelist_t tablelist;
 
+    /// prepared statements of user queries
+    DbQueryCache querycache;
+
     DbConnection(PDbParam params)
 	: QObject(), dbparam(params),
 	  dbuuid( QUuid::createUuid() ),
@@ -3,13 +3,47 @@ DEPENDPATH += $$PWD
 
 HEADERS += \
     $$PWD/dbconnection.h \
+    $$PWD/dbcopy.h \
+    $$PWD/dbdialect.h \
+    $$PWD/dbdump.h \
+    $$PWD/dbfanout.h \
+    $$PWD/dbfanoutmodel.h \
+    $$PWD/dbhistory.h \
     $$PWD/dblistmodel.h \
+    $$PWD/dbplan.h \
+    $$PWD/dbplanmodel.h \
+    $$PWD/dbprofile.h \
+    $$PWD/dbquerycache.h \
+    $$PWD/dbrefreshmodel.h \
+    $$PWD/dbresultcache.h \
+    $$PWD/dbresultmodel.h \
     $$PWD/dbschemamodel.h \
-    $$PWD/dbtypes.h
+    $$PWD/dbtablediff.h \
+    $$PWD/dbtablemodel.h \
+    $$PWD/dbtailmodel.h \
+    $$PWD/dbtypes.h \
+    $$PWD/dbupsert.h \
+    $$PWD/dbworker.h
 
 SOURCES += \
     $$PWD/dbconnection.cpp \
+    $$PWD/dbcopy.cpp \
+    $$PWD/dbdump.cpp \
+    $$PWD/dbfanout.cpp \
+    $$PWD/dbfanoutmodel.cpp \
+    $$PWD/dbhistory.cpp \
     $$PWD/dblistmodel.cpp \
-    $$PWD/dbschemamodel.cpp
+    $$PWD/dbplan.cpp \
+    $$PWD/dbplanmodel.cpp \
+    $$PWD/dbprofile.cpp \
+    $$PWD/dbquerycache.cpp \
+    $$PWD/dbrefreshmodel.cpp \
+    $$PWD/dbresultcache.cpp \
+    $$PWD/dbresultmodel.cpp \
+    $$PWD/dbschemamodel.cpp \
+    $$PWD/dbtablediff.cpp \
+    $$PWD/dbtablemodel.cpp \
+    $$PWD/dbtailmodel.cpp \
+    $$PWD/dbupsert.cpp
 
 
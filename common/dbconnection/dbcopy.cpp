@@ -0,0 +1,246 @@
+#include "dbcopy.h"
+
+#include "dbtypes.h"
+#include "dbworker.h"
+
+#include <QtConcurrent>
+#include <QBitArray>
+#include <QSqlDriver>
+#include <QSqlRecord>
+#include <QSqlField>
+#include <QSqlIndex>
+#include <QSqlQuery>
+#include <QSqlError>
+
+/******************************************************************/
+
+bool DbTableCopy::prepare(QSqlDatabase source, const QString &sourceTable,
+                          QSqlDatabase target, const QString &targetTable, QString *err)
+{
+    m_Columns.clear();
+    m_KeyColumn = -1;
+    m_CreateSql.clear();
+
+    const QSqlRecord sourceRecord = source.record(sourceTable);
+    if (sourceRecord.isEmpty()) {
+        if (err) *err = tr("Table %1 not found.").arg(sourceTable);
+        return false;
+    }
+    const QSqlRecord targetRecord = target.record(targetTable);
+    const QSqlDriver *sourceDriver = source.driver();
+    const QSqlDriver *targetDriver = target.driver();
+    m_SourceConnection = source.connectionName();
+    m_TargetConnection = target.connectionName();
+    m_SourceTable = Db::escapedName(sourceDriver, sourceTable, QSqlDriver::TableName);
+    m_TargetTable = Db::escapedName(targetDriver, targetTable, QSqlDriver::TableName);
+
+    for (int i = 0; i < sourceRecord.count(); ++i) {
+        const QSqlField field = sourceRecord.field(i);
+        DbCopyColumn column;
+        column.label      = field.name();
+        column.source     = Db::escapedName(sourceDriver, field.name(), QSqlDriver::FieldName);
+        column.sourceType = Db::typeNameById(source.driverName(), field.typeID());
+        if (targetRecord.isEmpty()) {
+            column.target     = Db::escapedName(targetDriver, field.name(), QSqlDriver::FieldName);
+            column.targetType = Db::columnTypeSql(target.driverName(), field);
+            column.type       = field.type();
+        } else {
+            int j = 0;
+            while (j < targetRecord.count() && targetRecord.fieldName(j).compare(field.name(), Qt::CaseInsensitive)) ++j;
+            if (j == targetRecord.count()) continue;
+            const QSqlField targetField = targetRecord.field(j);
+            column.target     = Db::escapedName(targetDriver, targetField.name(), QSqlDriver::FieldName);
+            column.targetType = Db::typeNameById(target.driverName(), targetField.typeID());
+            column.type       = targetField.type();
+        }
+        m_Columns << column;
+    }
+    if (m_Columns.isEmpty()) {
+        if (err) *err = tr("No field of %1 is found in %2.").arg(sourceTable, targetTable);
+        return false;
+    }
+
+    const QSqlIndex primaryKey = source.primaryIndex(sourceTable);
+    QStringList keys;
+    for (int i = 0; i < m_Columns.size(); ++i) {
+        if (primaryKey.contains(m_Columns.at(i).label)) {
+            keys << m_Columns.at(i).target;
+            if (primaryKey.count() == 1) m_KeyColumn = i;
+        }
+    }
+
+    if (targetRecord.isEmpty()) {
+        QStringList definitions;
+        for (const auto &column : qAsConst(m_Columns)) {
+            definitions << QString("%1 %2").arg(column.target, column.targetType);
+        }
+        if (!keys.isEmpty()) {
+            definitions << QString("PRIMARY KEY (%1)").arg(keys.join(", "));
+        }
+        m_CreateSql = QString("CREATE TABLE %1 (%2)").arg(m_TargetTable, definitions.join(", "));
+    }
+    return true;
+}
+
+/******************************************************************/
+
+DbCopyResult DbTableCopy::run(DbCopyProgress *progress, const QVariant &resumeKey) const
+{
+    DbCopyResult result;
+    XBoundedQueue<Batch> queue(QueueBatches);
+    QThreadPool pool;
+    pool.setMaxThreadCount(2);
+
+    // either side closes the queue when it stops, which releases the other
+    QString readError;
+    QFuture<void> reader = QtConcurrent::run(&pool, [&](){
+        readError = read(&queue, progress, resumeKey);
+        queue.close();
+    });
+    QFuture<void> writer = QtConcurrent::run(&pool, [&](){
+        result.error = write(&queue, progress, &result);
+        queue.close();
+    });
+    reader.waitForFinished();
+    writer.waitForFinished();
+
+    if (result.error.isEmpty()) result.error = readError;
+    result.rows = progress->written.loadRelaxed();
+    result.partial = progress->canceled.loadRelaxed();
+    return result;
+}
+
+/******************************************************************/
+
+QString DbTableCopy::read(XBoundedQueue<Batch> *queue, DbCopyProgress *progress, const QVariant &resumeKey) const
+{
+    return Db::withClone(m_SourceConnection, "copyread", [&](QSqlDatabase &db) -> QString {
+        QStringList fields;
+        for (const auto &column : m_Columns) {
+            fields << column.source;
+        }
+        QString sql = QString("SELECT %1 FROM %2").arg(fields.join(", "), m_SourceTable);
+        const bool resume = m_KeyColumn >= 0 && resumeKey.isValid();
+        if (resume) {
+            sql += QString(" WHERE %1 > ?").arg(m_Columns.at(m_KeyColumn).source);
+        }
+        if (m_KeyColumn >= 0) {
+            sql += QString(" ORDER BY %1").arg(m_Columns.at(m_KeyColumn).source);
+        }
+
+        // decimals are read as text, as doubles they would lose digits
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+        bool ok = query.prepare(sql);
+        if (ok) {
+            if (resume) query.addBindValue(resumeKey);
+            ok = query.exec();
+        }
+        if (!ok) {
+            return query.lastError().text();
+        }
+
+        // numeric target columns take the text as it is, the server converts it
+        const int columns = m_Columns.size();
+        QBitArray numeric(columns);
+        for (int c = 0; c < columns; ++c) {
+            switch (m_Columns.at(c).type) {
+            case QVariant::Int:
+            case QVariant::UInt:
+            case QVariant::LongLong:
+            case QVariant::ULongLong:
+            case QVariant::Double:
+                numeric.setBit(c);
+                break;
+            default:
+                break;
+            }
+        }
+
+        Batch batch;
+        batch.reserve(BatchRows);
+        while (query.next()) {
+            Row row(columns);
+            for (int c = 0; c < columns; ++c) {
+                const QVariant value = query.value(c);
+                row[c] = numeric.testBit(c) && value.type() == QVariant::String
+                        ? value : Db::convertValue(value, m_Columns.at(c).type);
+            }
+            batch << row;
+            if (batch.size() == BatchRows) {
+                progress->read.fetchAndAddRelaxed(batch.size());
+                // a full queue holds the reader here
+                if (progress->canceled.loadRelaxed() || !queue->push(batch)) break;
+                batch.clear();
+                batch.reserve(BatchRows);
+            }
+        }
+        if (!batch.isEmpty() && !progress->canceled.loadRelaxed()) {
+            progress->read.fetchAndAddRelaxed(batch.size());
+            queue->push(batch);
+        }
+        const QString err = query.lastError().isValid() ? query.lastError().text() : QString();
+        query.finish();
+        return err;
+    });
+}
+
+/******************************************************************/
+
+QString DbTableCopy::write(XBoundedQueue<Batch> *queue, DbCopyProgress *progress, DbCopyResult *result) const
+{
+    return Db::withClone(m_TargetConnection, "copywrite", [&](QSqlDatabase &db) -> QString {
+        QSqlQuery query(db);
+        if (!m_CreateSql.isEmpty()) {
+            if (!query.exec(m_CreateSql)) {
+                return query.lastError().text();
+            }
+            result->created = true;
+        }
+
+        QStringList fields, marks;
+        for (const auto &column : m_Columns) {
+            fields << column.target;
+            marks << "?";
+        }
+        if (!query.prepare(QString("INSERT INTO %1 (%2) VALUES (%3)").arg(m_TargetTable, fields.join(", "), marks.join(", ")))) {
+            return query.lastError().text();
+        }
+
+        // every batch is committed on its own, so a copy can be resumed after it
+        const bool useTransactions = db.driver()->hasFeature(QSqlDriver::Transactions);
+        const int columns = m_Columns.size();
+        Batch batch;
+        while (queue->pop(&batch)) {
+            if (progress->canceled.loadRelaxed()) break;
+
+            for (int c = 0; c < columns; ++c) {
+                QVariantList values;
+                values.reserve(batch.size());
+                for (const auto &row : qAsConst(batch)) {
+                    values << row.at(c);
+                }
+                query.bindValue(c, values);
+            }
+            if (useTransactions && !db.transaction()) {
+                return db.lastError().text();
+            }
+            if (!query.execBatch()) {
+                const QString err = query.lastError().text();
+                if (useTransactions) db.rollback();
+                return err;
+            }
+            if (useTransactions && !db.commit()) {
+                return db.lastError().text();
+            }
+            progress->written.fetchAndAddRelaxed(batch.size());
+            if (m_KeyColumn >= 0) {
+                progress->setCommittedKey(batch.last().at(m_KeyColumn));
+            }
+        }
+        return QString();
+    });
+}
+
+/******************************************************************/
@@ -0,0 +1,126 @@
+#ifndef DBCOPY_H
+#define DBCOPY_H
+
+#include "xboundedqueue.h"
+
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QVariant>
+#include <QVector>
+#include <QAtomicInt>
+#include <QMutex>
+
+/******************************************************************/
+
+struct DbCopyColumn
+{
+    QString label;            ///< source field
+    QString source;           ///< escaped source field
+    QString target;           ///< escaped target field
+    QString sourceType;       ///< type name of the source driver
+    QString targetType;       ///< type name of the target driver, or the column type of a created table
+    QVariant::Type type = QVariant::Invalid;  ///< values are converted to it
+};
+
+/******************************************************************/
+//! shared between the copy threads and the dialog
+class DbCopyProgress
+{
+public:
+    QAtomicInteger<qint64> read;
+    QAtomicInteger<qint64> written;
+    QAtomicInt             canceled;
+
+    void setCommittedKey(const QVariant &key) {
+        QMutexLocker locker(&m_Mutex);
+        m_Key = key;
+    }
+
+    /// key of the last committed row
+    QVariant committedKey() const {
+        QMutexLocker locker(&m_Mutex);
+        return m_Key;
+    }
+
+private:
+    mutable QMutex m_Mutex;
+    QVariant       m_Key;
+};
+
+/******************************************************************/
+
+struct DbCopyResult
+{
+    qint64  rows    = 0;      ///< written by this run
+    bool    created = false;  ///< the target table was created
+    bool    partial = false;  ///< canceled
+    QString error;
+};
+
+/******************************************************************/
+/**
+ * @brief Copy of a table to another connection
+ *
+ * A reader thread streams the source with a forward-only query and
+ * converts the values to the types of the target columns; decimals are
+ * read as text and passed to numeric columns unchanged. A writer thread
+ * inserts them as prepared batches, each batch in its own transaction.
+ * Between them is a queue of QueueBatches batches, so the reader waits
+ * while the writer is behind. With a single field primary key the rows
+ * are read in key order and a copy can be resumed above the last
+ * committed key.
+ */
+class DbTableCopy
+{
+    Q_DECLARE_TR_FUNCTIONS(DbTableCopy)
+
+public:
+    typedef QVector<QVariant> Row;
+    typedef QVector<Row> Batch;
+
+    enum {
+        BatchRows    = 1000,
+        QueueBatches = 8
+    };
+
+    /**
+     * @brief Maps the source fields to the target table
+     *
+     * Fields are matched by name without case, source fields missing in
+     * the target are not copied. A missing target table is created on
+     * run() with column types of the target dialect.
+     */
+    bool prepare(QSqlDatabase source, const QString &sourceTable,
+                 QSqlDatabase target, const QString &targetTable, QString *err = Q_NULLPTR);
+
+    QVector<DbCopyColumn> columns() const {
+        return m_Columns;
+    }
+
+    /// source field of the resume key, empty without a single field primary key
+    QString keyField() const {
+        return m_KeyColumn < 0 ? QString() : m_Columns.at(m_KeyColumn).label;
+    }
+
+    bool createsTable() const {
+        return !m_CreateSql.isEmpty();
+    }
+
+    /// runs in the calling (worker) thread, a valid resumeKey copies only the rows above it
+    DbCopyResult run(DbCopyProgress *progress, const QVariant &resumeKey) const;
+
+private:
+    QString read(XBoundedQueue<Batch> *queue, DbCopyProgress *progress, const QVariant &resumeKey) const;
+    QString write(XBoundedQueue<Batch> *queue, DbCopyProgress *progress, DbCopyResult *result) const;
+
+private:
+    QString m_SourceConnection;
+    QString m_TargetConnection;
+    QString m_SourceTable;          ///< escaped
+    QString m_TargetTable;          ///< escaped
+    QVector<DbCopyColumn> m_Columns;
+    int     m_KeyColumn = -1;
+    QString m_CreateSql;            ///< creates the missing target table
+};
+
+#endif // DBCOPY_H
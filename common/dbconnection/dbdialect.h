@@ -0,0 +1,245 @@
+#ifndef DBDIALECT_H
+#define DBDIALECT_H
+
+#include <QString>
+#include <QStringList>
+#include <QSqlDriver>
+
+namespace Db {
+
+enum {
+    SetParams = 900  ///< placeholders of a key set, below the limits of SQLite and Oracle
+};
+
+/******************************************************************/
+
+enum Dialect {
+    GenericSql,
+    MySqlSql,
+    PostgreSql,
+    SqliteSql,
+    OracleSql
+};
+
+/******************************************************************/
+
+inline Dialect dialect(const QString &driver) {
+    if (driver == "QMYSQL" || driver == "QMYSQL3") {
+        return MySqlSql;
+    }
+    if (driver  == "QPSQL" || driver == "PSQL7") {
+        return PostgreSql;
+    }
+    if (driver  == "QSQLITE" || driver == "QSQLITE2") {
+        return SqliteSql;
+    }
+    if (driver  == "QOCI" || driver == "QOCI8") {
+        return OracleSql;
+    }
+    return GenericSql;
+}
+
+/******************************************************************/
+//! name quoted for driver, unless it is quoted already
+inline QString escapedName(const QSqlDriver *driver, const QString &name, QSqlDriver::IdentifierType type) {
+    return driver->isIdentifierEscaped(name, type) ? name : driver->escapeIdentifier(name, type);
+}
+
+/******************************************************************/
+/**
+ * @brief Condition which matches count keys at once
+ *
+ * keys are the escaped key columns. One column becomes "k IN (?, ...)",
+ * several become "(k1 = ? AND k2 = ?) OR ...". The values are bound key
+ * by key, row after row; count should keep count * keys below SetParams.
+ */
+inline QString keySetSql(const QStringList &keys, int count) {
+    QStringList sets;
+    if (keys.size() == 1) {
+        QStringList marks;
+        for (int i = 0; i < count; ++i) {
+            marks << "?";
+        }
+        sets << QString("%1 IN (%2)").arg(keys.first(), marks.join(", "));
+    } else {
+        const QString where = QString("(%1 = ?)").arg(keys.join(" = ? AND "));
+        for (int i = 0; i < count; ++i) {
+            sets << where;
+        }
+    }
+    return sets.join(" OR ");
+}
+
+/******************************************************************/
+//! wraps sql so that the server returns at most limit rows, callers must still stop reading at limit
+inline QString limitSql(const QString &driver, const QString &sql, int limit) {
+    switch (dialect(driver)) {
+    case MySqlSql:
+    case PostgreSql:
+    case SqliteSql:
+        return QString("%1 LIMIT %2").arg(sql, QString::number(limit));
+    case OracleSql:
+        return QString("SELECT * FROM (%1) WHERE ROWNUM <= %2").arg(sql, QString::number(limit));
+    case GenericSql:
+        break;
+    }
+    return sql;
+}
+
+/******************************************************************/
+/**
+ * @brief Server side preview of a large value
+ *
+ * Text longer than prefix characters becomes "<prefix>... [<length> chars]",
+ * shorter text is returned unchanged. Binary values always become
+ * "<hex of prefix/2 bytes>... [<length> bytes]". Returns an empty string
+ * if the dialect has no suitable functions.
+ */
+inline QString previewSql(const QString &driver, const QString &column, bool binary, int prefix) {
+    const QString n = QString::number(prefix);
+    const QString half = QString::number(prefix / 2);
+    switch (dialect(driver)) {
+    case PostgreSql:
+        return binary
+                ? QString("encode(substring(%1 from 1 for %2), 'hex') || '... [' || octet_length(%1) || ' bytes]'").arg(column, half)
+                : QString("CASE WHEN char_length(%1) > %2 THEN substring(%1 from 1 for %2) || '... [' || char_length(%1) || ' chars]' ELSE %1 END")
+                  .arg(QString("CAST(%1 AS text)").arg(column), n); // json and xml have no substring
+    case MySqlSql:
+        return binary
+                ? QString("CONCAT(HEX(LEFT(%1, %2)), '... [', LENGTH(%1), ' bytes]')").arg(column, half)
+                : QString("CASE WHEN CHAR_LENGTH(%1) > %2 THEN CONCAT(LEFT(%1, %2), '... [', CHAR_LENGTH(%1), ' chars]') ELSE %1 END").arg(column, n);
+    case SqliteSql:
+        return binary
+                ? QString("hex(substr(%1, 1, %2)) || '... [' || length(%1) || ' bytes]'").arg(column, half)
+                : QString("CASE WHEN length(%1) > %2 THEN substr(%1, 1, %2) || '... [' || length(%1) || ' chars]' ELSE %1 END").arg(column, n);
+    case OracleSql:
+        return binary
+                ? QString("CASE WHEN %1 IS NULL THEN NULL ELSE RAWTOHEX(DBMS_LOB.SUBSTR(%1, %2, 1)) || '... [' || DBMS_LOB.GETLENGTH(%1) || ' bytes]' END").arg(column, half)
+                : QString("CASE WHEN DBMS_LOB.GETLENGTH(%1) > %2 THEN DBMS_LOB.SUBSTR(%1, %2, 1) || '... [' || DBMS_LOB.GETLENGTH(%1) || ' chars]' ELSE TO_CHAR(%1) END").arg(column, n);
+    case GenericSql:
+        break;
+    }
+    return QString();
+}
+
+/******************************************************************/
+/**
+ * @brief Insert which updates the row with the same primary key instead
+ *
+ * table, columns and keys are escaped names, the keys are part of the
+ * columns. The statement has one placeholder per column in the order of
+ * columns. Returns an empty string if the dialect has no upsert.
+ */
+inline QString upsertSql(const QString &driver, const QString &table, const QStringList &columns, const QStringList &keys) {
+    QStringList marks, updates;
+    for (int i = 0; i < columns.size(); ++i) {
+        marks << "?";
+    }
+    switch (dialect(driver)) {
+    case PostgreSql:
+    case SqliteSql:
+        for (const auto &column : columns) {
+            if (!keys.contains(column)) updates << QString("%1 = excluded.%1").arg(column);
+        }
+        return QString("INSERT INTO %1 (%2) VALUES (%3) ON CONFLICT (%4) %5")
+                .arg(table, columns.join(", "), marks.join(", "), keys.join(", "),
+                     updates.isEmpty() ? QString("DO NOTHING") : "DO UPDATE SET " + updates.join(", "));
+    case MySqlSql:
+        for (const auto &column : columns) {
+            if (!keys.contains(column)) updates << QString("%1 = VALUES(%1)").arg(column);
+        }
+        if (updates.isEmpty()) {
+            updates << QString("%1 = %1").arg(keys.first());
+        }
+        return QString("INSERT INTO %1 (%2) VALUES (%3) ON DUPLICATE KEY UPDATE %4")
+                .arg(table, columns.join(", "), marks.join(", "), updates.join(", "));
+    case OracleSql: {
+        QStringList sources, on, values;
+        for (const auto &column : columns) {
+            sources << QString("? AS %1").arg(column);
+            values << QString("s.%1").arg(column);
+            if (keys.contains(column)) {
+                on << QString("t.%1 = s.%1").arg(column);
+            } else {
+                updates << QString("t.%1 = s.%1").arg(column);
+            }
+        }
+        QString sql = QString("MERGE INTO %1 t USING (SELECT %2 FROM dual) s ON (%3)")
+                .arg(table, sources.join(", "), on.join(" AND "));
+        if (!updates.isEmpty()) {
+            sql += " WHEN MATCHED THEN UPDATE SET " + updates.join(", ");
+        }
+        return sql + QString(" WHEN NOT MATCHED THEN INSERT (%1) VALUES (%2)").arg(columns.join(", "), values.join(", "));
+    }
+    case GenericSql:
+        break;
+    }
+    return QString();
+}
+
+/******************************************************************/
+/**
+ * @brief Server side checksum of a set of rows
+ *
+ * Select list of "count, checksum" where the checksum is the sum of a
+ * hash of every row, so it does not depend on the order of the rows.
+ * columns are escaped names. Checksums are only comparable between
+ * servers of the same dialect. Returns an empty string if the dialect
+ * has no suitable hash function.
+ */
+inline QString rangeHashSql(const QString &driver, const QStringList &columns) {
+    QStringList nulls;
+    switch (dialect(driver)) {
+    case PostgreSql:
+        return QString("COUNT(*), COALESCE(SUM(('x' || substr(md5(CAST(ROW(%1) AS text)), 1, 15))::bit(60)::bigint), 0)")
+                .arg(columns.join(", "));
+    case MySqlSql:
+        for (const auto &column : columns) {
+            nulls << QString("ISNULL(%1)").arg(column);
+        }
+        return QString("COUNT(*), COALESCE(SUM(CAST(CONV(SUBSTRING(MD5(CONCAT_WS('#', %1, CONCAT(%2))), 1, 15), 16, 10) AS UNSIGNED)), 0)")
+                .arg(columns.join(", "), nulls.join(", "));
+    case OracleSql:
+        for (const auto &column : columns) {
+            nulls << QString("NVL2(%1, '1', '0')").arg(column);
+        }
+        return QString("COUNT(*), NVL(SUM(ORA_HASH(%1 || '#' || %2)), 0)")
+                .arg(columns.join(" || '#' || "), nulls.join(" || "));
+    case SqliteSql:
+    case GenericSql:
+        break;
+    }
+    return QString();
+}
+
+/******************************************************************/
+/**
+ * @brief Row counts of all tables as estimated by the server statistics
+ *
+ * The query returns the table name and the estimated rows. Returns an
+ * empty string if the dialect keeps no statistics; SQLite has them only
+ * after ANALYZE.
+ */
+inline QString rowEstimatesSql(const QString &driver) {
+    switch (dialect(driver)) {
+    case PostgreSql:
+        return "SELECT c.relname, CAST(c.reltuples AS bigint) FROM pg_class c "
+               "JOIN pg_namespace n ON n.oid = c.relnamespace "
+               "WHERE c.relkind IN ('r', 'p', 'm') AND n.nspname = ANY (current_schemas(false))";
+    case MySqlSql:
+        return "SELECT table_name, table_rows FROM information_schema.tables WHERE table_schema = DATABASE()";
+    case OracleSql:
+        return "SELECT table_name, num_rows FROM user_tables";
+    case SqliteSql:
+        return "SELECT tbl, MAX(CAST(stat AS INTEGER)) FROM sqlite_stat1 GROUP BY tbl";
+    case GenericSql:
+        break;
+    }
+    return QString();
+}
+
+/******************************************************************/
+
+} // namespace Db
+
+#endif // DBDIALECT_H
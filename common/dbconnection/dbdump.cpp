@@ -0,0 +1,396 @@
+#include "dbdump.h"
+
+#include "dbdialect.h"
+#include "dbworker.h"
+#include "xgzipwriter.h"
+
+#include <QtConcurrent>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QLocale>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+#include <QRegularExpression>
+#include <QSet>
+#include <QSqlDriver>
+#include <QSqlRecord>
+#include <QSqlField>
+#include <QSqlQuery>
+#include <QSqlError>
+
+#include <algorithm>
+
+/******************************************************************/
+
+static QByteArray csvText(const QString &text)
+{
+    // an empty string is quoted to tell it from NULL
+    if (!text.isEmpty() && std::none_of(text.begin(), text.end(), [](QChar ch){
+        return ch == ',' || ch == '"' || ch == '\r' || ch == '\n';
+    })) {
+        return text.toUtf8();
+    }
+    QString quoted = text;
+    quoted.replace('"', "\"\"");
+    return '"' + quoted.toUtf8() + '"';
+}
+
+/******************************************************************/
+
+static QByteArray jsonText(const QString &text)
+{
+    QString escaped;
+    escaped.reserve(text.size() + 2);
+    escaped += '"';
+    for (const QChar ch : text) {
+        switch (ch.unicode()) {
+        case '"':  escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\b': escaped += "\\b"; break;
+        case '\f': escaped += "\\f"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+            if (ch.unicode() < 0x20) {
+                escaped += QString("\\u%1").arg(ch.unicode(), 4, 16, QLatin1Char('0'));
+            } else {
+                escaped += ch;
+            }
+            break;
+        }
+    }
+    escaped += '"';
+    return escaped.toUtf8();
+}
+
+/******************************************************************/
+//! integers and decimals are written as their text, a double would round them
+static QByteArray jsonValue(const QVariant &value, QVariant::Type fieldType)
+{
+    static const QRegularExpression number("^-?(0|[1-9][0-9]*)(\\.[0-9]+)?([eE][+-]?[0-9]+)?$");
+
+    if (value.isNull()) return "null";
+
+    switch (value.type()) {
+    case QVariant::Bool:
+        return value.toBool() ? "true" : "false";
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+        return value.toString().toLatin1();
+    case QVariant::Double: {
+        const double d = value.toDouble();
+        return qIsFinite(d) ? QString::number(d, 'g', QLocale::FloatingPointShortest).toLatin1() : QByteArray("null");
+    }
+    case QVariant::ByteArray:
+        return jsonText(QString::fromLatin1(value.toByteArray().toBase64()));
+    default:
+        break;
+    }
+
+    const QString text = value.toString();
+    switch (fieldType) {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double:
+        // decimals are read as text, only plain numbers are valid JSON
+        if (number.match(text).hasMatch()) return text.toLatin1();
+        break;
+    default:
+        break;
+    }
+    return jsonText(text);
+}
+
+/******************************************************************/
+
+DbDump::DbDump(const QString &connectionName, const QStringList &tables, const QString &folder)
+    : m_ConnectionName(connectionName)
+    , m_Label(connectionName)
+    , m_Tables(tables)
+    , m_Folder(folder)
+{
+}
+
+/******************************************************************/
+
+QString DbDump::extension(Format format)
+{
+    switch (format) {
+    case Csv:       return "csv";
+    case NdJson:    return "ndjson";
+    case SqlInsert: return "sql";
+    }
+    return QString();
+}
+
+/******************************************************************/
+
+QVector<DbDumpTable> DbDump::run(int threads, const QAtomicInt *canceled, QAtomicInteger<qint64> *rows,
+                                 QAtomicInt *tablesDone, QString *err) const
+{
+    // names which differ only in case or in replaced characters get a suffix,
+    // the file systems of Windows and macOS do not tell them apart
+    QVector<DbDumpTable> tables;
+    QSet<QString> fileNames;
+    for (const QString &name : m_Tables) {
+        DbDumpTable table;
+        table.table = name;
+        QString base = name;
+        base.replace(QRegularExpression("[^A-Za-z0-9_.-]"), "_");
+        QString fileName = base;
+        for (int n = 2; fileNames.contains(fileName.toLower()); ++n) {
+            fileName = QString("%1_%2").arg(base).arg(n);
+        }
+        fileNames.insert(fileName.toLower());
+        table.file = fileName + "." + extension(m_Format) + (m_Compressed ? ".gz" : "");
+        tables << table;
+    }
+    if (!QDir().mkpath(m_Folder)) {
+        if (err) *err = tr("Cannot create %1.").arg(m_Folder);
+        return tables;
+    }
+
+    // estimates only order the work, a failure is not an error
+    Db::withClone(m_ConnectionName, "dump", [&](QSqlDatabase &db) -> QString {
+        estimateRows(db, &tables);
+        return QString();
+    });
+    std::stable_sort(tables.begin(), tables.end(), [](const DbDumpTable &a, const DbDumpTable &b){
+        return a.estimate > b.estimate;
+    });
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qBound(1, threads, tables.size()));
+    QAtomicInt next;
+    QMutex errorMutex;
+    QString workerError;
+    QVector<QFuture<void>> workers;
+    for (int i = 0; i < pool.maxThreadCount(); ++i) {
+        workers << QtConcurrent::run(&pool, [&](){
+            const QString openError = Db::withClone(m_ConnectionName, "dump", [&](QSqlDatabase &db) -> QString {
+                for (int j = next.fetchAndAddRelaxed(1); j < tables.size(); j = next.fetchAndAddRelaxed(1)) {
+                    if (canceled->loadRelaxed()) break;
+                    DbDumpTable *table = tables.data() + j;
+                    table->error = dumpTable(db, table, canceled, rows);
+                    tablesDone->ref();
+                }
+                return QString();
+            });
+            if (!openError.isEmpty()) {
+                QMutexLocker lock(&errorMutex);
+                workerError = openError;
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.waitForFinished();
+    }
+
+    for (auto &table : tables) {
+        if (table.sha256.isEmpty() && table.error.isEmpty()) {
+            table.file.clear();
+            table.error = canceled->loadRelaxed() ? tr("Stopped") : workerError;
+        }
+    }
+    QString manifestError;
+    if (!writeManifest(tables, &manifestError)) {
+        workerError = manifestError;
+    }
+    if (err) *err = workerError;
+    return tables;
+}
+
+/******************************************************************/
+//! the statistics name tables without schema and may differ in case
+void DbDump::estimateRows(QSqlDatabase &db, QVector<DbDumpTable> *tables) const
+{
+    const QString sql = Db::rowEstimatesSql(db.driverName());
+    if (sql.isEmpty()) return;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec(sql)) return;
+
+    QHash<QString, qint64> estimates;
+    while (query.next()) {
+        if (query.value(1).isNull()) continue;
+        estimates.insert(query.value(0).toString().toLower(), query.value(1).toLongLong());
+    }
+    for (auto &table : *tables) {
+        const QString name = table.table.toLower();
+        table.estimate = estimates.value(name, estimates.value(name.mid(name.lastIndexOf('.') + 1), -1));
+    }
+}
+
+/******************************************************************/
+
+QString DbDump::dumpTable(QSqlDatabase &db, DbDumpTable *table, const QAtomicInt *canceled,
+                          QAtomicInteger<qint64> *rows) const
+{
+    const QSqlDriver *driver = db.driver();
+    QFile file(QDir(m_Folder).filePath(table->file));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return file.errorString();
+    }
+    // the checksum is of the file as written, compressed or not
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    XGzipWriter gzip(&file);
+    gzip.setHash(&hash);
+    auto write = [&](const QByteArray &data){
+        if (m_Compressed) return gzip.write(data);
+        hash.addData(data);
+        return file.write(data) == data.size();
+    };
+
+    const QString escapedTable = Db::escapedName(driver, table->table, QSqlDriver::TableName);
+    // decimals are read as text, as doubles they would lose digits
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+    if (!query.exec("SELECT * FROM " + escapedTable)) {
+        return query.lastError().text();
+    }
+
+    QSqlRecord values = query.record();
+    QStringList names;
+    for (int i = 0; i < values.count(); ++i) {
+        names << Db::escapedName(driver, values.fieldName(i), QSqlDriver::FieldName);
+    }
+    const QString insert = QString("INSERT INTO %1 (%2) VALUES (").arg(escapedTable, names.join(", "));
+
+    QByteArray buffer;
+    buffer.reserve(FlushBytes);
+    if (m_Format == Csv) {
+        QByteArrayList header;
+        for (int i = 0; i < values.count(); ++i) {
+            header << csvText(values.fieldName(i));
+        }
+        buffer = header.join(',') + '\n';
+    }
+
+    QString err;
+    qint64 pending = 0;
+    while (query.next()) {
+        buffer += line(query, &values, driver, insert);
+        ++pending;
+        if (buffer.size() < FlushBytes) continue;
+
+        if (!write(buffer)) {
+            err = file.errorString();
+            break;
+        }
+        buffer.clear();
+        table->rows += pending;
+        rows->fetchAndAddRelaxed(pending);
+        pending = 0;
+        if (canceled->loadRelaxed()) {
+            err = tr("Stopped");
+            break;
+        }
+    }
+    if (err.isEmpty() && query.lastError().isValid()) {
+        err = query.lastError().text();
+    }
+    if (err.isEmpty()) {
+        if (!write(buffer)) {
+            err = file.errorString();
+        } else {
+            table->rows += pending;
+            rows->fetchAndAddRelaxed(pending);
+        }
+    }
+    if (m_Compressed && !gzip.close() && err.isEmpty()) {
+        err = file.errorString();
+    }
+    table->sha256 = hash.result().toHex();
+    table->bytes  = file.size();
+    file.close();
+    return err;
+}
+
+/******************************************************************/
+
+QByteArray DbDump::line(const QSqlQuery &query, QSqlRecord *values, const QSqlDriver *driver,
+                        const QString &insert) const
+{
+    switch (m_Format) {
+    case Csv: {
+        QByteArrayList fields;
+        for (int i = 0; i < values->count(); ++i) {
+            const QVariant value = query.value(i);
+            if (value.isNull()) {
+                fields << QByteArray();
+            } else if (value.type() == QVariant::ByteArray) {
+                fields << value.toByteArray().toBase64();
+            } else {
+                fields << csvText(value.toString());
+            }
+        }
+        return fields.join(',') + '\n';
+    }
+    case NdJson: {
+        // the line is built as text, QJsonValue keeps every number as a double
+        QByteArray result = "{";
+        for (int i = 0; i < values->count(); ++i) {
+            if (i) result += ',';
+            result += jsonText(values->fieldName(i)) + ':' + jsonValue(query.value(i), values->field(i).type());
+        }
+        return result + "}\n";
+    }
+    case SqlInsert: {
+        QStringList texts;
+        for (int i = 0; i < values->count(); ++i) {
+            values->setValue(i, query.value(i));
+            texts << driver->formatValue(values->field(i));
+        }
+        return (insert + texts.join(", ") + ");\n").toUtf8();
+    }
+    }
+    return QByteArray();
+}
+
+/******************************************************************/
+
+bool DbDump::writeManifest(const QVector<DbDumpTable> &tables, QString *err) const
+{
+    QJsonArray entries;
+    for (const auto &table : tables) {
+        QJsonObject entry;
+        entry.insert("table",    table.table);
+        entry.insert("file",     table.file);
+        entry.insert("estimate", table.estimate);
+        entry.insert("rows",     table.rows);
+        entry.insert("bytes",    table.bytes);
+        entry.insert("sha256",   table.sha256);
+        if (!table.error.isEmpty()) {
+            entry.insert("error", table.error);
+        }
+        entries << entry;
+    }
+    QJsonObject manifest;
+    manifest.insert("connection", m_Label);
+    manifest.insert("format",     extension(m_Format));
+    manifest.insert("compressed", m_Compressed);
+    manifest.insert("created",    QDateTime::currentDateTime().toString(Qt::ISODate));
+    manifest.insert("tables",     entries);
+
+    QSaveFile file(QDir(m_Folder).filePath("manifest.json"));
+    if (!file.open(QIODevice::WriteOnly)
+            || file.write(QJsonDocument(manifest).toJson()) < 0
+            || !file.commit()) {
+        if (err) *err = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/******************************************************************/
@@ -0,0 +1,92 @@
+#ifndef DBDUMP_H
+#define DBDUMP_H
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QVector>
+#include <QAtomicInt>
+
+QT_BEGIN_NAMESPACE
+class QSqlDatabase;
+class QSqlRecord;
+class QSqlDriver;
+class QSqlQuery;
+QT_END_NAMESPACE
+
+/******************************************************************/
+
+struct DbDumpTable
+{
+    QString table;
+    qint64  estimate = -1;   ///< rows by the server statistics, -1 if unknown
+    QString file;            ///< in the dump folder, unique ignoring case, empty if not dumped
+    qint64  rows  = 0;
+    qint64  bytes = 0;       ///< size of the file
+    QString sha256;          ///< of the file
+    QString error;
+};
+
+/******************************************************************/
+/**
+ * @brief Export of many tables of a connection into a folder
+ *
+ * The tables are ordered by the row estimates of the server, the largest
+ * first, so the long exports do not start last. Every worker thread
+ * opens one clone of the connection and takes the next table until none
+ * is left. Files are streamed, optionally as gzip, and a manifest.json
+ * with the rows, sizes and SHA-256 checksums of the files is written at
+ * the end.
+ */
+class DbDump
+{
+    Q_DECLARE_TR_FUNCTIONS(DbDump)
+
+public:
+    enum Format {
+        Csv,
+        NdJson,
+        SqlInsert
+    };
+
+    enum {
+        FlushBytes = 1 << 16  ///< rows are written in buffers of this size
+    };
+
+    DbDump(const QString &connectionName, const QStringList &tables, const QString &folder);
+
+    void setLabel(const QString &label) {
+        m_Label = label;
+    }
+
+    void setFormat(Format format) {
+        m_Format = format;
+    }
+
+    void setCompressed(bool compressed) {
+        m_Compressed = compressed;
+    }
+
+    /// runs in the calling (worker) thread with threads workers
+    QVector<DbDumpTable> run(int threads, const QAtomicInt *canceled, QAtomicInteger<qint64> *rows,
+                             QAtomicInt *tablesDone, QString *err) const;
+
+    static QString extension(Format format);
+
+private:
+    void estimateRows(QSqlDatabase &db, QVector<DbDumpTable> *tables) const;
+    QString dumpTable(QSqlDatabase &db, DbDumpTable *table, const QAtomicInt *canceled,
+                      QAtomicInteger<qint64> *rows) const;
+    QByteArray line(const QSqlQuery &query, QSqlRecord *values, const QSqlDriver *driver,
+                    const QString &insert) const;
+    bool writeManifest(const QVector<DbDumpTable> &tables, QString *err) const;
+
+private:
+    QString     m_ConnectionName;
+    QString     m_Label;
+    QStringList m_Tables;
+    QString     m_Folder;
+    Format      m_Format     = Csv;
+    bool        m_Compressed = true;
+};
+
+#endif // DBDUMP_H
@@ -0,0 +1,499 @@
+#include "dbfanout.h"
+
+#include "dbdialect.h"
+#include "dbworker.h"
+#include "xboundedqueue.h"
+
+#include <QtConcurrent>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <QSqlRecord>
+#include <QSqlField>
+#include <QSqlQuery>
+#include <QSqlError>
+
+#include <queue>
+
+/******************************************************************/
+
+template <typename T>
+static int compared(const T &a, const T &b)
+{
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+/******************************************************************/
+
+DbFanOut::DbFanOut(const QString &sql, const QVariantMap &bindings)
+    : m_Sql(sql)
+    , m_Bindings(bindings)
+{
+}
+
+/******************************************************************/
+//! the driver is looked up here, a connection only answers its own thread
+void DbFanOut::addTarget(const QString &label, const QString &connectionName)
+{
+    Target target;
+    target.label          = label;
+    target.connectionName = connectionName;
+    target.driverName     = QSqlDatabase::database(connectionName, false).driverName();
+    m_Targets << target;
+}
+
+/******************************************************************/
+
+DbFanOutResult DbFanOut::run(const QAtomicInt *canceled, QAtomicInt *shardsDone, QAtomicInteger<qint64> *rows) const
+{
+    DbFanOutResult result;
+    for (const auto &target : m_Targets) {
+        DbShardResult shard;
+        shard.label = target.label;
+        result.shardResults << shard;
+    }
+    if (m_Targets.isEmpty()) return result;
+
+    if (m_OrderedMerge) {
+        merge(&result, canceled, shardsDone, rows);
+    } else {
+        concatenate(&result, canceled, shardsDone, rows);
+    }
+    return result;
+}
+
+/******************************************************************/
+//! executing is held from opening the clone until the query is executed
+void DbFanOut::runShard(int shard, const BatchSink &sink, const QAtomicInt *canceled, QSemaphore *executing,
+                        QSqlRecord *record, DbShardResult *result) const
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (executing) executing->acquire();
+    bool holding = executing;
+    auto release = [&](){
+        if (holding) executing->release();
+        holding = false;
+    };
+
+    result->error = Db::withClone(m_Targets.at(shard).connectionName, "fanout", [&](QSqlDatabase &db) -> QString {
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        bool ok = query.prepare(m_Sql);
+        if (ok) {
+            for (auto it = m_Bindings.constBegin(); it != m_Bindings.constEnd(); ++it) {
+                query.bindValue(it.key(), it.value());
+            }
+            ok = query.exec();
+        }
+        release();
+        if (!ok) {
+            return query.lastError().text();
+        }
+        result->latencyMs = timer.elapsed();
+
+        *record = query.record();
+        const int columns = record->count();
+        Batch batch;
+        batch.reserve(BatchRows);
+        bool open = true;
+        while (open && query.next()) {
+            Row row(columns);
+            for (int c = 0; c < columns; ++c) {
+                row[c] = query.value(c);
+            }
+            batch << row;
+            if (batch.size() == BatchRows) {
+                result->rows += batch.size();
+                // a full queue of a merge holds the shard here
+                open = !canceled->loadRelaxed() && sink(batch);
+                batch.clear();
+                batch.reserve(BatchRows);
+            }
+        }
+        if (open && !batch.isEmpty()) {
+            result->rows += batch.size();
+            sink(batch);
+        }
+        const QString err = query.lastError().isValid() ? query.lastError().text() : QString();
+        query.finish();
+        return err;
+    });
+    release();
+    result->totalMs = timer.elapsed();
+}
+
+/******************************************************************/
+//! every shard collects its own rows, they are joined in the order of the targets
+void DbFanOut::concatenate(DbFanOutResult *result, const QAtomicInt *canceled, QAtomicInt *shardsDone,
+                           QAtomicInteger<qint64> *rows) const
+{
+    const int count = m_Targets.size();
+    QVector<QSqlRecord> records(count);
+    QVector<Batch> collected(count);
+    QSqlRecord *shardRecords = records.data();
+    Batch *shardRows = collected.data();
+    DbShardResult *shardResults = result->shardResults.data();
+    QAtomicInt total;
+    QAtomicInt truncated;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMin(m_Parallelism, count));
+    QVector<QFuture<void>> shards;
+    for (int i = 0; i < count; ++i) {
+        shards << QtConcurrent::run(&pool, [&, i](){
+            if (canceled->loadRelaxed()) {
+                shardResults[i].error = tr("Stopped");
+            } else if (truncated.loadRelaxed()) {
+                shardResults[i].error = tr("Not executed, %1 rows reached").arg(int(MaxRows));
+            } else {
+                runShard(i, [&, i](const Batch &batch){
+                    const int taken = qBound(0, MaxRows - total.fetchAndAddRelaxed(batch.size()), batch.size());
+                    shardRows[i] += batch.mid(0, taken);
+                    rows->fetchAndAddRelaxed(taken);
+                    if (taken == batch.size()) return true;
+                    truncated.storeRelaxed(1);
+                    return false;
+                }, canceled, Q_NULLPTR, shardRecords + i, shardResults + i);
+            }
+            shardsDone->ref();
+        });
+    }
+    for (auto &shard : shards) {
+        shard.waitForFinished();
+    }
+
+    result->truncated = truncated.loadRelaxed();
+    int fieldShard = -1;
+    for (int i = 0; i < count; ++i) {
+        if (!records.at(i).isEmpty()) {
+            fieldShard = i;
+            break;
+        }
+    }
+    if (fieldShard < 0) return;
+
+    const QSqlRecord &record = records.at(fieldShard);
+    for (int c = 0; c < record.count(); ++c) {
+        result->fields << record.fieldName(c);
+    }
+    for (int i = 0; i < count; ++i) {
+        if (records.at(i).count() != record.count()) {
+            if (result->shardResults.at(i).error.isEmpty()) {
+                result->shardResults[i].error = tr("%1 fields instead of %2")
+                        .arg(records.at(i).count()).arg(record.count());
+            }
+            continue;
+        }
+        result->rows += collected.at(i);
+        result->shards += QVector<int>(collected.at(i).size(), i);
+    }
+}
+
+/******************************************************************/
+/**
+ * All shards stream their batches into a queue of their own, the merge
+ * keeps the current batch of every shard and a heap of the shards by
+ * their head row. A shard is only read again when its head row was taken.
+ */
+void DbFanOut::merge(DbFanOutResult *result, const QAtomicInt *canceled, QAtomicInt *shardsDone,
+                     QAtomicInteger<qint64> *rows) const
+{
+    struct Head {
+        Batch batch;
+        int   pos = -1;
+    };
+
+    const int count = m_Targets.size();
+    QVector<QSqlRecord> records(count);
+    QSqlRecord *shardRecords = records.data();
+    DbShardResult *shardResults = result->shardResults.data();
+    QVector<QSharedPointer<XBoundedQueue<Batch>>> queues;
+    for (int i = 0; i < count; ++i) {
+        queues << QSharedPointer<XBoundedQueue<Batch>>::create(QueueBatches);
+    }
+
+    // every shard streams until the merge ends, only the executions are bounded
+    QThreadPool pool;
+    pool.setMaxThreadCount(count);
+    QSemaphore executing(m_Parallelism);
+    QVector<QFuture<void>> shards;
+    for (int i = 0; i < count; ++i) {
+        XBoundedQueue<Batch> *queue = queues.at(i).data();
+        shards << QtConcurrent::run(&pool, [&, i, queue](){
+            if (canceled->loadRelaxed()) {
+                shardResults[i].error = tr("Stopped");
+            } else {
+                runShard(i, [queue](const Batch &batch){
+                    return queue->push(batch);
+                }, canceled, &executing, shardRecords + i, shardResults + i);
+            }
+            queue->close();
+            shardsDone->ref();
+        });
+    }
+
+    QVector<Head> heads(count);
+    QVector<bool> mismatched(count, false);
+    QSqlRecord record;
+    // moves the head of shard i to its next row, false when the shard is exhausted
+    auto advance = [&](int i) -> bool {
+        Head &head = heads[i];
+        if (++head.pos < head.batch.size()) return true;
+        head.pos = 0;
+        while (queues.at(i)->pop(&head.batch)) {
+            // the record is set before the first batch is queued
+            if (record.isEmpty()) {
+                record = records.at(i);
+            } else if (records.at(i).count() != record.count()) {
+                mismatched[i] = true;
+                queues.at(i)->close();
+                return false;
+            }
+            if (!head.batch.isEmpty()) return true;
+        }
+        return false;
+    };
+    auto take = [&](int i) -> bool {
+        if (result->rows.size() >= MaxRows) {
+            result->truncated = true;
+            return false;
+        }
+        const Head &head = heads.at(i);
+        result->rows << head.batch.at(head.pos);
+        result->shards << i;
+        rows->fetchAndAddRelaxed(1);
+        return !canceled->loadRelaxed();
+    };
+
+    QVector<int> live;
+    for (int i = 0; i < count; ++i) {
+        if (advance(i)) live << i;
+    }
+
+    // NULL sorts last in ascending order on PostgreSQL and Oracle, first elsewhere
+    const Db::Dialect dialect = Db::dialect(m_Targets.constFirst().driverName);
+    const bool nullsLargest = dialect == Db::PostgreSql || dialect == Db::OracleSql;
+    QVector<DbSortKey> keys;
+    if (!live.isEmpty()) {
+        keys = sortKeys(m_Sql, record, nullsLargest, &result->note);
+    }
+    if (keys.isEmpty()) {
+        // the shards are joined one after the other
+        bool more = true;
+        for (int i : qAsConst(live)) {
+            do {
+                more = take(i);
+            } while (more && advance(i));
+            if (!more) break;
+        }
+    } else {
+        result->merged = true;
+        auto greater = [&](int a, int b){
+            const Row &rowA = heads.at(a).batch.at(heads.at(a).pos);
+            const Row &rowB = heads.at(b).batch.at(heads.at(b).pos);
+            if (rowLess(rowB, rowA, keys)) return true;
+            if (rowLess(rowA, rowB, keys)) return false;
+            return a > b;
+        };
+        std::priority_queue<int, std::vector<int>, decltype(greater)> heap(greater);
+        for (int i : qAsConst(live)) {
+            heap.push(i);
+        }
+        while (!heap.empty()) {
+            const int i = heap.top();
+            heap.pop();
+            if (!take(i)) break;
+            if (advance(i)) heap.push(i);
+        }
+    }
+
+    for (auto &queue : queues) {
+        queue->close();
+    }
+    for (auto &shard : shards) {
+        shard.waitForFinished();
+    }
+
+    if (record.isEmpty()) {
+        for (const auto &shardRecord : qAsConst(records)) {
+            if (!shardRecord.isEmpty()) {
+                record = shardRecord;
+                break;
+            }
+        }
+    }
+    for (int c = 0; c < record.count(); ++c) {
+        result->fields << record.fieldName(c);
+    }
+    for (int i = 0; i < count; ++i) {
+        if (mismatched.at(i) && result->shardResults.at(i).error.isEmpty()) {
+            result->shardResults[i].error = tr("%1 fields instead of %2")
+                    .arg(records.at(i).count()).arg(record.count());
+        }
+    }
+}
+
+/******************************************************************/
+
+QVector<DbSortKey> DbFanOut::sortKeys(const QString &sql, const QSqlRecord &record, bool nullsLargest,
+                                      QString *err)
+{
+    // literals, comments and parentheses are blanked, only the words of the top level remain
+    QString top = sql;
+    int depth = 0;
+    for (int i = 0; i < top.size(); ++i) {
+        int end = -1;
+        if (top.at(i) == '\'') {
+            end = top.indexOf('\'', i + 1);
+        } else if (top.midRef(i, 2) == QLatin1String("--")) {
+            end = top.indexOf('\n', i);
+        } else if (top.midRef(i, 2) == QLatin1String("/*")) {
+            end = top.indexOf("*/", i + 2);
+            if (end >= 0) ++end;
+        } else {
+            if (top.at(i) == '(') ++depth;
+            if (depth > 0) {
+                if (top.at(i) == ')') --depth;
+                top[i] = ' ';
+            }
+            continue;
+        }
+        if (end < 0) end = top.size() - 1;
+        for (; i <= end; ++i) {
+            top[i] = ' ';
+        }
+        i = end;
+    }
+
+    QRegularExpressionMatchIterator it = QRegularExpression("\\bORDER\\s+BY\\b",
+                                                            QRegularExpression::CaseInsensitiveOption).globalMatch(top);
+    int start = -1;
+    while (it.hasNext()) {
+        start = it.next().capturedEnd();
+    }
+    if (start < 0) {
+        if (err) *err = tr("The query has no ORDER BY, the rows are not merged.");
+        return QVector<DbSortKey>();
+    }
+    const QRegularExpression clauseEnd("\\b(LIMIT|OFFSET|FETCH|FOR|UNION|INTERSECT|EXCEPT)\\b|;",
+                                       QRegularExpression::CaseInsensitiveOption);
+    const QRegularExpressionMatch endMatch = clauseEnd.match(top, start);
+    const int end = endMatch.hasMatch() ? endMatch.capturedStart() : top.size();
+    if (sql.midRef(start, end - start).contains('(')) {
+        if (err) *err = tr("ORDER BY uses an expression, the rows are not merged.");
+        return QVector<DbSortKey>();
+    }
+
+    const QRegularExpression termExp("^\\s*(.+?)(?:\\s+(ASC|DESC))?(?:\\s+NULLS\\s+(FIRST|LAST))?\\s*$",
+                                     QRegularExpression::CaseInsensitiveOption);
+    // only the last part of a qualified name is captured
+    const QString part("(?:[\\w$]+|\"[^\"]+\"|`[^`]+`|\\[[^\\]]+\\])");
+    const QRegularExpression nameExp(QString("^(?:%1\\.)*(%1)$").arg(part));
+    QVector<DbSortKey> keys;
+    for (const QString &term : top.mid(start, end - start).split(',')) {
+        const QRegularExpressionMatch termMatch = termExp.match(term);
+        const QString expression = termMatch.captured(1);
+        DbSortKey key;
+        key.column = -1;
+        bool ordinal = false;
+        const int position = expression.toInt(&ordinal);
+        if (ordinal) {
+            key.column = position - 1;
+        } else {
+            const QRegularExpressionMatch nameMatch = nameExp.match(expression);
+            if (nameMatch.hasMatch()) {
+                QString name = nameMatch.captured(nameMatch.lastCapturedIndex());
+                if (!name.isEmpty() && !name.at(0).isLetterOrNumber() && name.at(0) != '_' && name.at(0) != '$') {
+                    name = name.mid(1, name.size() - 2);
+                }
+                key.column = name.isEmpty() ? -1 : record.indexOf(name);
+            }
+        }
+        if (!termMatch.hasMatch() || key.column < 0 || key.column >= record.count()) {
+            if (err) *err = tr("ORDER BY %1 is not a column of the result, the rows are not merged.")
+                    .arg(expression.isEmpty() ? term.trimmed() : expression);
+            return QVector<DbSortKey>();
+        }
+        key.type = record.field(key.column).type();
+        if (!isMergeType(key.type)) {
+            // the servers order text by their collation, which is not known here
+            if (err) *err = tr("ORDER BY %1 is not a number or a date, the rows are concatenated, not merged.")
+                    .arg(expression);
+            return QVector<DbSortKey>();
+        }
+        key.descending = !termMatch.captured(2).compare("DESC", Qt::CaseInsensitive);
+        key.nullsFirst = termMatch.captured(3).isEmpty()
+                ? key.descending == nullsLargest
+                : !termMatch.captured(3).compare("FIRST", Qt::CaseInsensitive);
+        keys << key;
+    }
+    return keys;
+}
+
+/******************************************************************/
+
+int DbFanOut::compareValues(const QVariant &a, const QVariant &b, QVariant::Type type)
+{
+    // drivers may deliver numbers as text, the field type tells how to compare
+    switch (type) {
+    case QVariant::Bool:
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+        return compared(a.toLongLong(), b.toLongLong());
+    case QVariant::ULongLong:
+        return compared(a.toULongLong(), b.toULongLong());
+    case QVariant::Double:
+        return compared(a.toDouble(), b.toDouble());
+    case QVariant::Date:
+        return compared(a.toDate(), b.toDate());
+    case QVariant::Time:
+        return compared(a.toTime(), b.toTime());
+    case QVariant::DateTime:
+        return compared(a.toDateTime(), b.toDateTime());
+    default:
+        return 0;
+    }
+}
+
+/******************************************************************/
+
+bool DbFanOut::isMergeType(QVariant::Type type)
+{
+    switch (type) {
+    case QVariant::Bool:
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double:
+    case QVariant::Date:
+    case QVariant::Time:
+    case QVariant::DateTime:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/******************************************************************/
+
+bool DbFanOut::rowLess(const Row &a, const Row &b, const QVector<DbSortKey> &keys)
+{
+    for (const auto &key : keys) {
+        const QVariant &valueA = a.at(key.column);
+        const QVariant &valueB = b.at(key.column);
+        if (valueA.isNull() || valueB.isNull()) {
+            if (valueA.isNull() == valueB.isNull()) continue;
+            return valueA.isNull() == key.nullsFirst;
+        }
+        const int cmp = compareValues(valueA, valueB, key.type);
+        if (cmp) return key.descending ? cmp > 0 : cmp < 0;
+    }
+    return false;
+}
+
+/******************************************************************/
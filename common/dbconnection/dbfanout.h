@@ -0,0 +1,135 @@
+#ifndef DBFANOUT_H
+#define DBFANOUT_H
+
+#include <QCoreApplication>
+#include <QVariantMap>
+#include <QStringList>
+#include <QVector>
+#include <QAtomicInt>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+class QSemaphore;
+class QSqlRecord;
+QT_END_NAMESPACE
+
+/******************************************************************/
+
+struct DbShardResult
+{
+    QString label;
+    qint64  latencyMs = -1;  ///< until the first row could be read
+    qint64  totalMs   = -1;
+    qint64  rows      = 0;
+    QString error;
+};
+
+/******************************************************************/
+
+struct DbSortKey
+{
+    int            column     = 0;
+    QVariant::Type type       = QVariant::Invalid;  ///< of the field in the result
+    bool           descending = false;
+    bool           nullsFirst = false;
+};
+
+/******************************************************************/
+
+struct DbFanOutResult
+{
+    QStringList fields;
+    QVector<QVector<QVariant>> rows;
+    QVector<int> shards;              ///< shard of every row
+    QVector<DbShardResult> shardResults;
+    bool    merged    = false;        ///< rows are ordered by the ORDER BY of the query
+    bool    truncated = false;
+    QString note;                     ///< why an ordered merge was not possible
+};
+
+/******************************************************************/
+/**
+ * @brief One query executed on many connections
+ *
+ * Every target runs the query on its own clone of the connection, at most
+ * parallelism of them at the same time. The rows are combined in the
+ * order of the targets. With an ordered merge all targets stream their
+ * sorted rows in batches and a k-way merge on the columns of the top
+ * level ORDER BY picks the smallest head row; only the execution is
+ * bounded then, as every target has to deliver until the merge ends. Only
+ * numbers, dates and times are merged; the collation of text keys is not
+ * known, such results are concatenated.
+ */
+class DbFanOut
+{
+    Q_DECLARE_TR_FUNCTIONS(DbFanOut)
+
+public:
+    typedef QVector<QVariant> Row;
+    typedef QVector<Row> Batch;
+
+    enum {
+        MaxRows      = 100000,  ///< rows of all targets together
+        BatchRows    = 256,
+        QueueBatches = 4        ///< per target of an ordered merge
+    };
+
+    DbFanOut(const QString &sql, const QVariantMap &bindings);
+
+    void addTarget(const QString &label, const QString &connectionName);
+
+    void setParallelism(int parallelism) {
+        m_Parallelism = qMax(1, parallelism);
+    }
+
+    void setOrderedMerge(bool merge) {
+        m_OrderedMerge = merge;
+    }
+
+    int targetCount() const {
+        return m_Targets.size();
+    }
+
+    /// runs in the calling (worker) thread
+    DbFanOutResult run(const QAtomicInt *canceled, QAtomicInt *shardsDone, QAtomicInteger<qint64> *rows) const;
+
+    /**
+     * The columns of the top level ORDER BY of sql in record; an empty
+     * result with err set if there is no ORDER BY, a term is not a plain
+     * column name or position, or a column is neither a number nor a date.
+     */
+    static QVector<DbSortKey> sortKeys(const QString &sql, const QSqlRecord &record, bool nullsLargest,
+                                       QString *err);
+
+private:
+    struct Target {
+        QString label;
+        QString connectionName;
+        QString driverName;
+    };
+
+    typedef std::function<bool (const Batch &batch)> BatchSink;
+
+    void runShard(int shard, const BatchSink &sink, const QAtomicInt *canceled, QSemaphore *executing,
+                  QSqlRecord *record, DbShardResult *result) const;
+    void concatenate(DbFanOutResult *result, const QAtomicInt *canceled, QAtomicInt *shardsDone,
+                     QAtomicInteger<qint64> *rows) const;
+    void merge(DbFanOutResult *result, const QAtomicInt *canceled, QAtomicInt *shardsDone,
+               QAtomicInteger<qint64> *rows) const;
+
+private: // static
+    static int compareValues(const QVariant &a, const QVariant &b, QVariant::Type type);
+    /// a type compared the same way by every server
+    static bool isMergeType(QVariant::Type type);
+    static bool rowLess(const Row &a, const Row &b, const QVector<DbSortKey> &keys);
+
+private:
+    QString         m_Sql;
+    QVariantMap     m_Bindings;
+    QVector<Target> m_Targets;
+    int             m_Parallelism  = 4;
+    bool            m_OrderedMerge = false;
+};
+
+#endif // DBFANOUT_H
@@ -0,0 +1,76 @@
+#include "dbfanoutmodel.h"
+
+/******************************************************************/
+
+DbFanOutModel::DbFanOutModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+/******************************************************************/
+
+QVariant DbFanOutModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return section == 0 ? tr("Connection") : d.result.fields.value(section - 1);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+/******************************************************************/
+
+int DbFanOutModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return d.result.rows.size();
+}
+
+/******************************************************************/
+
+int DbFanOutModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || d.result.fields.isEmpty())
+        return 0;
+
+    return d.result.fields.size() + 1;
+}
+
+/******************************************************************/
+
+QVariant DbFanOutModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= d.result.rows.size())
+        return QVariant();
+
+    if (role != Qt::DisplayRole && role != Qt::EditRole)
+        return QVariant();
+
+    if (index.column() == 0) {
+        return d.labels.value(d.result.shards.at(index.row()));
+    }
+    return d.result.rows.at(index.row()).value(index.column() - 1);
+}
+
+/******************************************************************/
+
+void DbFanOutModel::setResult(const DbFanOutResult &result)
+{
+    beginResetModel();
+    d.result = result;
+    d.labels.clear();
+    for (const auto &shard : result.shardResults) {
+        d.labels << shard.label;
+    }
+    endResetModel();
+}
+
+/******************************************************************/
+
+void DbFanOutModel::clear()
+{
+    setResult(DbFanOutResult());
+}
+
+/******************************************************************/
@@ -0,0 +1,43 @@
+#ifndef DBFANOUTMODEL_H
+#define DBFANOUTMODEL_H
+
+#include "dbfanout.h"
+
+#include <QAbstractTableModel>
+
+/******************************************************************/
+/**
+ * @brief Combined rows of a fan-out query
+ *
+ * The first column names the connection every row was read from, the
+ * fields of the query follow.
+ */
+class DbFanOutModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+    struct DbFanOutModelPrivate {
+        QStringList    labels;  ///< of the shards
+        DbFanOutResult result;
+    };
+
+public:
+    explicit DbFanOutModel(QObject *parent = nullptr);
+
+    // Header:
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Basic functionality:
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void setResult(const DbFanOutResult &result);
+    void clear();
+
+private:
+    DbFanOutModelPrivate d;
+};
+
+#endif // DBFANOUTMODEL_H
@@ -0,0 +1,253 @@
+#include "dbhistory.h"
+
+#include <QStandardPaths>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+
+#include <QSqlQuery>
+#include <QSqlError>
+
+#include <QDebug>
+
+#define HISTORY_CONNECTION "QtSqlView_history"
+
+/******************************************************************/
+
+DbHistory::DbHistory()
+{
+}
+
+/******************************************************************/
+
+bool DbHistory::open()
+{
+    if (m_Db.isOpen()) return true;
+
+    if (!QSqlDatabase::isDriverAvailable("QSQLITE")) {
+        qWarning() << "Query history is disabled: QSQLITE driver is not available";
+        return false;
+    }
+
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+
+    m_Db = QSqlDatabase::addDatabase("QSQLITE", HISTORY_CONNECTION);
+    m_Db.setDatabaseName(dir + "/history.sqlite");
+    if (!m_Db.open()) {
+        qWarning() << "Could not open query history:" << m_Db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_Db);
+    query.exec("CREATE TABLE IF NOT EXISTS history ("
+               " id INTEGER PRIMARY KEY AUTOINCREMENT,"
+               " executed TEXT NOT NULL,"
+               " connection TEXT,"
+               " sql TEXT,"
+               " fingerprint TEXT,"
+               " binds TEXT,"
+               " prepare_us INTEGER,"
+               " exec_us INTEGER,"
+               " fetch_us INTEGER,"
+               " rows INTEGER,"
+               " affected INTEGER,"
+               " bytes INTEGER,"
+               " error TEXT)");
+    query.exec("CREATE INDEX IF NOT EXISTS history_fingerprint ON history (fingerprint, executed)");
+    query.exec("CREATE INDEX IF NOT EXISTS history_executed ON history (executed)");
+    query.exec("CREATE TABLE IF NOT EXISTS plans ("
+               " id INTEGER PRIMARY KEY AUTOINCREMENT,"
+               " executed TEXT NOT NULL,"
+               " connection TEXT,"
+               " sql TEXT,"
+               " fingerprint TEXT,"
+               " plan TEXT)");
+    query.exec("CREATE INDEX IF NOT EXISTS plans_fingerprint ON plans (fingerprint, executed)");
+    return true;
+}
+
+/******************************************************************/
+
+void DbHistory::record(const DbHistoryEntry &entry)
+{
+    if (!m_Db.isOpen()) return;
+
+    QSqlQuery query(m_Db);
+    query.prepare("INSERT INTO history (executed, connection, sql, fingerprint, binds,"
+                  " prepare_us, exec_us, fetch_us, rows, affected, bytes, error)"
+                  " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    query.addBindValue(entry.executed.toString("yyyy-MM-ddThh:mm:ss.zzz"));
+    query.addBindValue(entry.connection);
+    query.addBindValue(entry.sql);
+    query.addBindValue(fingerprint(entry.sql));
+    query.addBindValue(entry.binds.isEmpty()
+                       ? QString()
+                       : QString::fromUtf8(QJsonDocument(QJsonObject::fromVariantMap(entry.binds))
+                                           .toJson(QJsonDocument::Compact)));
+    query.addBindValue(entry.prepareUs);
+    query.addBindValue(entry.execUs);
+    query.addBindValue(entry.fetchUs);
+    query.addBindValue(entry.rows);
+    query.addBindValue(entry.affected);
+    query.addBindValue(entry.bytes);
+    query.addBindValue(entry.error);
+    if (!query.exec()) {
+        qWarning() << "Could not write query history:" << query.lastError().text();
+    }
+}
+
+/******************************************************************/
+
+void DbHistory::recordPlan(const QString &connection, const QString &sql, const QJsonObject &plan)
+{
+    if (!m_Db.isOpen()) return;
+
+    QSqlQuery query(m_Db);
+    query.prepare("INSERT INTO plans (executed, connection, sql, fingerprint, plan)"
+                  " VALUES (?, ?, ?, ?, ?)");
+    query.addBindValue(QDateTime::currentDateTime().toString("yyyy-MM-ddThh:mm:ss.zzz"));
+    query.addBindValue(connection);
+    query.addBindValue(sql);
+    query.addBindValue(fingerprint(sql));
+    query.addBindValue(QString::fromUtf8(QJsonDocument(plan).toJson(QJsonDocument::Compact)));
+    if (!query.exec()) {
+        qWarning() << "Could not write query plan:" << query.lastError().text();
+    }
+}
+
+/******************************************************************/
+
+QList<DbHistoryPlan> DbHistory::plans(const QString &fingerprint, int limit) const
+{
+    QList<DbHistoryPlan> result;
+    if (!m_Db.isOpen()) return result;
+
+    QSqlQuery query(m_Db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT executed, connection, plan FROM plans"
+                  " WHERE fingerprint = ? ORDER BY id DESC LIMIT " + QString::number(limit));
+    query.addBindValue(fingerprint);
+    if (!query.exec()) return result;
+
+    while (query.next()) {
+        DbHistoryPlan plan;
+        plan.executed   = QDateTime::fromString(query.value(0).toString(), "yyyy-MM-ddThh:mm:ss.zzz");
+        plan.connection = query.value(1).toString();
+        plan.plan       = QJsonDocument::fromJson(query.value(2).toString().toUtf8()).object();
+        result << plan;
+    }
+    return result;
+}
+
+/******************************************************************/
+//! strips comments, replaces string and numeric literals by '?' and normalizes case and whitespace
+QString DbHistory::fingerprint(const QString &sql)
+{
+    auto isWordChar = [](QChar ch) {
+        return ch.isLetterOrNumber() || ch == '_' || ch == '$' || ch == ':';
+    };
+
+    QString result;
+    result.reserve(sql.size());
+
+    const int n = sql.size();
+    int i = 0;
+    bool space = false;
+    while (i < n) {
+        const QChar ch = sql.at(i);
+
+        // comments
+        if (ch == '-' && i + 1 < n && sql.at(i + 1) == '-') {
+            while (i < n && sql.at(i) != '\n') ++i;
+            space = true;
+            continue;
+        }
+        if (ch == '/' && i + 1 < n && sql.at(i + 1) == '*') {
+            const int end = sql.indexOf("*/", i + 2);
+            i = end < 0 ? n : end + 2;
+            space = true;
+            continue;
+        }
+        if (ch.isSpace()) {
+            space = true;
+            ++i;
+            continue;
+        }
+
+        if (space && !result.isEmpty()) {
+            result.append(' ');
+        }
+        space = false;
+
+        // string literal, '' is an escaped quote
+        if (ch == '\'') {
+            ++i;
+            while (i < n) {
+                if (sql.at(i) == '\'') {
+                    if (i + 1 < n && sql.at(i + 1) == '\'') {
+                        i += 2;
+                        continue;
+                    }
+                    break;
+                }
+                ++i;
+            }
+            ++i;
+            result.append('?');
+            continue;
+        }
+
+        // quoted identifier is kept as is
+        if (ch == '"' || ch == '`') {
+            int end = sql.indexOf(ch, i + 1);
+            if (end < 0) end = n - 1;
+            result.append(sql.midRef(i, end - i + 1));
+            i = end + 1;
+            continue;
+        }
+
+        // numeric literal, digits inside identifiers are kept
+        if (ch.isDigit() && (result.isEmpty() || !isWordChar(result.at(result.size() - 1)))) {
+            while (i < n && (sql.at(i).isLetterOrNumber() || sql.at(i) == '.')) ++i;
+            result.append('?');
+            continue;
+        }
+
+        result.append(ch.toLower());
+        ++i;
+    }
+
+    // IN lists of any length are the same statement
+    static const QRegularExpression list("\\(\\?(?:\\s*,\\s*\\?)+\\)");
+    result.replace(list, "(?)");
+    return result;
+}
+
+/******************************************************************/
+
+qint64 DbHistory::valueBytes(const QVariant &value)
+{
+    if (value.isNull()) return 0;
+
+    switch (value.type()) {
+    case QVariant::String:
+        // the shared string is not converted, two bytes per UTF-16 unit
+        return value.toString().size() * 2;
+    case QVariant::ByteArray:
+        return value.toByteArray().size();
+    case QVariant::Bool:
+        return 1;
+    case QVariant::Int:
+    case QVariant::UInt:
+        return 4;
+    case QVariant::Date:
+        return 4;
+    default:
+        break;
+    }
+    return 8;
+}
+
+/******************************************************************/
@@ -0,0 +1,75 @@
+#ifndef DBHISTORY_H
+#define DBHISTORY_H
+
+#include <QSqlDatabase>
+#include <QDateTime>
+#include <QVariantMap>
+#include <QJsonObject>
+
+/******************************************************************/
+
+struct DbHistoryEntry
+{
+    QDateTime   executed;     ///< start of the execution
+    QString     connection;   ///< connection label
+    QString     sql;          ///< SQL text as executed
+    QVariantMap binds;        ///< bind values
+    qint64      prepareUs = 0;
+    qint64      execUs    = 0;
+    qint64      fetchUs   = 0;
+    qint64      rows      = -1; ///< rows returned, -1 for not a select
+    qint64      affected  = -1; ///< rows affected, -1 for a select
+    qint64      bytes     = 0;  ///< bytes of the fetched values
+    QString     error;
+};
+
+/******************************************************************/
+
+struct DbHistoryPlan
+{
+    QDateTime   executed;
+    QString     connection;
+    QJsonObject plan;         ///< DbPlanNode::toJson()
+};
+
+/******************************************************************/
+/**
+ * @brief Local SQLite store of executed user queries
+ *
+ * Every entry keeps a fingerprint of the SQL (literals replaced by '?')
+ * so executions of the same statement can be grouped and compared.
+ */
+class DbHistory
+{
+public:
+    DbHistory();
+
+    /// opens (and creates) the history database, false if QSQLITE is not available
+    bool open();
+
+    bool isOpen() const {
+        return m_Db.isOpen();
+    }
+
+    QSqlDatabase database() const {
+        return m_Db;
+    }
+
+    void record(const DbHistoryEntry &entry);
+
+    void recordPlan(const QString &connection, const QString &sql, const QJsonObject &plan);
+
+    /// stored plans of the statement fingerprint, latest first
+    QList<DbHistoryPlan> plans(const QString &fingerprint, int limit = 20) const;
+
+public: // static
+    static QString fingerprint(const QString &sql);
+
+    /// approximate size of a fetched value
+    static qint64 valueBytes(const QVariant &value);
+
+private:
+    QSqlDatabase m_Db;
+};
+
+#endif // DBHISTORY_H
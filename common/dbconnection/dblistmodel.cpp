@@ -131,6 +131,12 @@ QVariant DbListModel::data(const QModelIndex &index, int role) const
         } else if (role == Qt::DecorationRole) {
             static QIcon dbicon(":/img/database.png");
             return dbicon;
+        } else if (role == Qt::ToolTipRole) {
+            return tr("Prepared statements: %1 of %2 cached, %3 hits, %4 misses")
+                    .arg(dbc->querycache.size())
+                    .arg(dbc->querycache.capacity())
+                    .arg(dbc->querycache.hits())
+                    .arg(dbc->querycache.misses());
         }
     } else if (const DbTable *dbt = qobject_cast<const DbTable*>(obj)) {
         if (role == Qt::DisplayRole) {
@@ -0,0 +1,377 @@
+#include "dbplan.h"
+
+#include "dbdialect.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+
+#include <QSqlQuery>
+#include <QSqlDriver>
+#include <QSqlField>
+#include <QSqlError>
+
+/******************************************************************/
+
+double DbPlanNode::selfWeight() const
+{
+    double result = weight();
+    if (result < 0) return -1;
+
+    for (const auto &child : children) {
+        if (child.weight() > 0) {
+            result -= child.weight();
+        }
+    }
+    return qMax(0.0, result);
+}
+
+/******************************************************************/
+
+QJsonObject DbPlanNode::toJson() const
+{
+    QJsonObject obj;
+    obj.insert("name", name);
+    obj.insert("detail", detail);
+    obj.insert("cost", cost);
+    obj.insert("rows", rows);
+    obj.insert("actualMs", actualMs);
+    obj.insert("actualRows", actualRows);
+    obj.insert("loops", loops);
+    obj.insert("fullScan", fullScan);
+
+    QJsonArray list;
+    for (const auto &child : children) {
+        list.append(child.toJson());
+    }
+    obj.insert("children", list);
+    return obj;
+}
+
+/******************************************************************/
+
+DbPlanNode DbPlanNode::fromJson(const QJsonObject &obj)
+{
+    DbPlanNode node;
+    node.name       = obj.value("name").toString();
+    node.detail     = obj.value("detail").toString();
+    node.cost       = obj.value("cost").toDouble(-1);
+    node.rows       = obj.value("rows").toDouble(-1);
+    node.actualMs   = obj.value("actualMs").toDouble(-1);
+    node.actualRows = obj.value("actualRows").toDouble(-1);
+    node.loops      = obj.value("loops").toDouble(-1);
+    node.fullScan   = obj.value("fullScan").toBool();
+
+    const QJsonArray list = obj.value("children").toArray();
+    for (const auto &child : list) {
+        node.children.append(fromJson(child.toObject()));
+    }
+    return node;
+}
+
+/******************************************************************/
+
+bool DbPlan::isSupported(const QString &driver)
+{
+    return !explainSql(driver, "SELECT 1").isEmpty();
+}
+
+/******************************************************************/
+
+QString DbPlan::explainSql(const QString &driver, const QString &sql)
+{
+    switch (Db::dialect(driver)) {
+    case Db::PostgreSql:
+        return "EXPLAIN (ANALYZE, FORMAT JSON) " + sql;
+    case Db::MySqlSql:
+        return "EXPLAIN FORMAT=JSON " + sql;
+    case Db::SqliteSql:
+        return "EXPLAIN QUERY PLAN " + sql;
+    case Db::OracleSql:
+    case Db::GenericSql:
+        break;
+    }
+    return QString();
+}
+
+/******************************************************************/
+
+struct SqlitePlanRow {
+    int id;
+    int parent;
+    QString detail;
+};
+
+static void sqlitePlanChildren(const QVector<SqlitePlanRow> &rows, int parent, DbPlanNode *node)
+{
+    for (const auto &row : rows) {
+        if (row.parent != parent || row.id == parent) continue;
+        DbPlanNode child;
+        child.name     = row.detail;
+        child.fullScan = row.detail.startsWith("SCAN") && !row.detail.contains("INDEX");
+        sqlitePlanChildren(rows, row.id, &child);
+        node->children.append(child);
+    }
+}
+
+/******************************************************************/
+
+bool DbPlan::explain(const QSqlDatabase &db, const QString &sql, const QVariantMap &bindings,
+                     DbPlanNode *root, QString *err)
+{
+    const QString driver = db.driverName();
+    const QString text = explainSql(driver, inlineBindings(db, sql, bindings));
+    if (text.isEmpty()) {
+        *err = QString("EXPLAIN is not supported for %1 connections").arg(driver);
+        return false;
+    }
+
+    // ANALYZE runs the statement, its changes must not stay
+    const Db::Dialect dialect = Db::dialect(driver);
+    QSqlDatabase conn = db;
+    const bool rollback = dialect == Db::PostgreSql;
+    if (rollback && postgresInTransaction(conn)) {
+        *err = "EXPLAIN ANALYZE runs the statement and rolls it back, "
+               "it is not run inside an open transaction";
+        return false;
+    }
+    if (rollback && (!conn.driver()->hasFeature(QSqlDriver::Transactions) || !conn.transaction())) {
+        *err = QString("EXPLAIN ANALYZE runs the statement and rolls it back, "
+                       "but no transaction could be started\n%1").arg(conn.lastError().text());
+        return false;
+    }
+
+    QSqlQuery query(conn);
+    query.setForwardOnly(true);
+    bool ok = query.exec(text);
+    if (!ok) {
+        *err = QString("%1\n%2").arg(query.lastError().driverText(),
+                                     query.lastError().databaseText());
+    }
+
+    if (ok && dialect == Db::SqliteSql) {
+        QVector<SqlitePlanRow> rows;
+        while (query.next()) {
+            rows << SqlitePlanRow{query.value(0).toInt(), query.value(1).toInt(), query.value(3).toString()};
+        }
+        *root = DbPlanNode();
+        root->name = "QUERY PLAN";
+        sqlitePlanChildren(rows, 0, root);
+    } else if (ok) {
+        QString json;
+        while (query.next()) {
+            json += query.value(0).toString();
+        }
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &parseError);
+        if (parseError.error != QJsonParseError::NoError) {
+            *err = QString("Could not parse the plan: %1").arg(parseError.errorString());
+            ok = false;
+        } else if (dialect == Db::PostgreSql && doc.array().isEmpty()) {
+            *err = "The server returned an empty plan";
+            ok = false;
+        } else if (dialect == Db::PostgreSql) {
+            *root = fromPostgres(doc.array().first().toObject().value("Plan").toObject());
+        } else {
+            *root = fromMySql("query_block", doc.object().value("query_block").toObject());
+        }
+    }
+
+    query.finish();
+    if (rollback) {
+        conn.rollback();
+    }
+    return ok;
+}
+
+/******************************************************************/
+//! replaces named bindings outside of quotes by literals, EXPLAIN can not be prepared by every server
+QString DbPlan::inlineBindings(const QSqlDatabase &db, const QString &sql, const QVariantMap &bindings)
+{
+    const bool backslashEscapes = Db::dialect(db.driverName()) == Db::MySqlSql;
+
+    QString result;
+    result.reserve(sql.size());
+
+    QChar quote;
+    int i = 0;
+    while (i < sql.size()) {
+        const QChar ch = sql.at(i);
+        if (!quote.isNull()) {
+            result.append(ch);
+            if (backslashEscapes && ch == QLatin1Char('\\') && i + 1 < sql.size()) {
+                result.append(sql.at(++i));
+            } else if (ch == quote) {
+                quote = QChar();
+            }
+            ++i;
+            continue;
+        }
+        if (ch == QLatin1Char('\'') || ch == QLatin1Char('"') || ch == QLatin1Char('`')) {
+            quote = ch;
+        } else if (ch == QLatin1Char(':') && sql.mid(i, 2) == "::") {
+            // PostgreSQL cast
+            result.append("::");
+            i += 2;
+            continue;
+        } else if (ch == QLatin1Char(':')) {
+            int end = i + 1;
+            while (end < sql.size() && (sql.at(end).isLetterOrNumber() || sql.at(end) == QLatin1Char('_'))) {
+                ++end;
+            }
+            const QString name = sql.mid(i, end - i);
+            if (end > i + 1 && bindings.contains(name)) {
+                const QVariant value = bindings.value(name);
+                QSqlField field(QString(), value.type());
+                field.setValue(value);
+                result += db.driver()->formatValue(field);
+                i = end;
+                continue;
+            }
+        }
+        result.append(ch);
+        ++i;
+    }
+    return result;
+}
+
+/******************************************************************/
+//! statement and transaction start only differ in a transaction block opened before
+bool DbPlan::postgresInTransaction(const QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    if (!query.exec("SELECT statement_timestamp() <> transaction_timestamp()") || !query.next()) {
+        return true;
+    }
+    return query.value(0).toBool();
+}
+
+/******************************************************************/
+
+DbPlanNode DbPlan::fromPostgres(const QJsonObject &plan)
+{
+    DbPlanNode node;
+    node.name     = plan.value("Node Type").toString();
+    node.fullScan = node.name == "Seq Scan";
+
+    QStringList detail;
+    if (plan.contains("Join Type")) {
+        detail << plan.value("Join Type").toString();
+    }
+    if (plan.contains("Relation Name")) {
+        QString relation = plan.value("Relation Name").toString();
+        const QString alias = plan.value("Alias").toString();
+        if (!alias.isEmpty() && alias != relation) {
+            relation += " " + alias;
+        }
+        detail << relation;
+    }
+    if (plan.contains("Index Name")) {
+        detail << "using " + plan.value("Index Name").toString();
+    }
+    const QStringList conditions = QStringList() << "Index Cond" << "Hash Cond" << "Merge Cond"
+                                                 << "Join Filter" << "Recheck Cond" << "Filter";
+    for (const auto &key : conditions) {
+        if (plan.contains(key)) {
+            detail << key + ": " + plan.value(key).toString();
+        }
+    }
+    const QStringList keyLists = QStringList() << "Sort Key" << "Group Key";
+    for (const auto &key : keyLists) {
+        if (plan.contains(key)) {
+            QStringList keys;
+            const QJsonArray list = plan.value(key).toArray();
+            for (const auto &item : list) {
+                keys << item.toString();
+            }
+            detail << key + ": " + keys.join(", ");
+        }
+    }
+    node.detail = detail.join("; ");
+
+    node.cost = plan.value("Total Cost").toDouble(-1);
+    node.rows = plan.value("Plan Rows").toDouble(-1);
+    if (plan.contains("Actual Total Time")) {
+        node.loops      = plan.value("Actual Loops").toDouble(1);
+        node.actualRows = plan.value("Actual Rows").toDouble(-1);
+        // actual time is an average per loop
+        node.actualMs   = plan.value("Actual Total Time").toDouble() * qMax(1.0, node.loops);
+    }
+
+    const QJsonArray children = plan.value("Plans").toArray();
+    for (const auto &child : children) {
+        node.children.append(fromPostgres(child.toObject()));
+    }
+    return node;
+}
+
+/******************************************************************/
+
+DbPlanNode DbPlan::fromMySql(const QString &key, const QJsonObject &obj)
+{
+    DbPlanNode node;
+    node.name = key;
+
+    QStringList detail;
+    const QJsonObject costInfo = obj.value("cost_info").toObject();
+    if (key == "table") {
+        node.name     = "table " + obj.value("table_name").toString();
+        node.fullScan = obj.value("access_type").toString() == "ALL";
+        detail << obj.value("access_type").toString();
+        if (obj.contains("key")) {
+            detail << "using " + obj.value("key").toString();
+        }
+        if (obj.contains("attached_condition")) {
+            detail << obj.value("attached_condition").toString();
+        }
+        node.rows = obj.value("rows_examined_per_scan").toDouble(-1);
+        if (costInfo.contains("read_cost")) {
+            node.cost = costInfo.value("read_cost").toString().toDouble()
+                      + costInfo.value("eval_cost").toString().toDouble();
+        }
+    } else if (costInfo.contains("query_cost")) {
+        node.cost = costInfo.value("query_cost").toString().toDouble();
+    }
+    if (obj.value("using_filesort").toBool()) {
+        detail << "filesort";
+    }
+    if (obj.value("using_temporary_table").toBool()) {
+        detail << "temporary table";
+    }
+    if (obj.contains("message")) {
+        detail << obj.value("message").toString();
+    }
+    detail.removeAll(QString());
+    node.detail = detail.join("; ");
+
+    for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
+        if (it.key() == "cost_info") continue;
+
+        if (it.value().isObject()) {
+            node.children.append(fromMySql(it.key(), it.value().toObject()));
+        } else if (it.value().isArray()) {
+            const QJsonArray list = it.value().toArray();
+            for (const auto &item : list) {
+                if (!item.isObject()) continue;
+                // nested_loop items are wrapped like {"table": {...}}
+                const QJsonObject itemObj = item.toObject();
+                if (itemObj.size() == 1 && itemObj.constBegin().value().isObject()) {
+                    node.children.append(fromMySql(itemObj.constBegin().key(), itemObj.constBegin().value().toObject()));
+                } else {
+                    node.children.append(fromMySql(it.key(), itemObj));
+                }
+            }
+        }
+    }
+
+    // operations without an own cost cost as much as their inputs
+    if (node.cost < 0 && !node.children.isEmpty()) {
+        double total = 0;
+        for (const auto &child : qAsConst(node.children)) {
+            total += qMax(0.0, child.cost);
+        }
+        node.cost = total;
+    }
+    return node;
+}
+
+/******************************************************************/
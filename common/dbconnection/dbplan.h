@@ -0,0 +1,58 @@
+#ifndef DBPLAN_H
+#define DBPLAN_H
+
+#include <QSqlDatabase>
+#include <QJsonObject>
+#include <QVariantMap>
+
+/******************************************************************/
+
+struct DbPlanNode
+{
+    QString name;              ///< node type
+    QString detail;            ///< relation, index and conditions
+    double  cost       = -1;   ///< estimated cost, children included
+    double  rows       = -1;   ///< estimated rows
+    double  actualMs   = -1;   ///< actual time of all loops, children included
+    double  actualRows = -1;   ///< actual rows per loop
+    double  loops      = -1;
+    bool    fullScan   = false;
+    QList<DbPlanNode> children;
+
+    /// actual time if the plan was analyzed, otherwise the estimated cost
+    double weight() const {
+        return actualMs >= 0 ? actualMs : cost;
+    }
+
+    /// weight of the node without its children
+    double selfWeight() const;
+
+    QJsonObject toJson() const;
+    static DbPlanNode fromJson(const QJsonObject &obj);
+};
+
+/******************************************************************/
+/**
+ * @brief Runs EXPLAIN for the dialect of a connection and parses the plan
+ *
+ * PostgreSQL plans are analyzed (the statement runs inside a rolled back
+ * transaction), MySQL and SQLite plans carry estimates only.
+ */
+class DbPlan
+{
+public:
+    static bool isSupported(const QString &driver);
+
+    static QString explainSql(const QString &driver, const QString &sql);
+
+    static bool explain(const QSqlDatabase &db, const QString &sql, const QVariantMap &bindings,
+                        DbPlanNode *root, QString *err);
+
+private:
+    static QString inlineBindings(const QSqlDatabase &db, const QString &sql, const QVariantMap &bindings);
+    static bool postgresInTransaction(const QSqlDatabase &db);
+    static DbPlanNode fromPostgres(const QJsonObject &plan);
+    static DbPlanNode fromMySql(const QString &key, const QJsonObject &obj);
+};
+
+#endif // DBPLAN_H
@@ -0,0 +1,321 @@
+#include "dbplanmodel.h"
+
+#include <QColor>
+#include <QFont>
+#include <QIcon>
+
+#include <cmath>
+
+/******************************************************************/
+
+enum {
+    NodeColumn,
+    DetailColumn,
+    CostColumn,
+    RowsColumn,
+    ActualRowsColumn,
+    LoopsColumn,
+    TimeColumn,
+    SelfColumn,
+    ShareColumn,
+    BaselineColumn,
+    ChangeColumn
+};
+
+enum {
+    HotSharePercent    = 10, ///< nodes above this share of the plan are highlighted
+    ChangeWarnPercent  = 10
+};
+
+/******************************************************************/
+
+DbPlanModel::DbPlanModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+    d.header << tr("Node")
+             << tr("Detail")
+             << tr("Cost")
+             << tr("Rows")
+             << tr("Actual rows")
+             << tr("Loops")
+             << tr("Time ms")
+             << tr("Self ms")
+             << tr("Share")
+             << tr("Baseline")
+             << tr("Change");
+}
+
+/******************************************************************/
+
+QVariant DbPlanModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return d.header.value(section);
+    }
+    return QVariant();
+}
+
+/******************************************************************/
+
+QModelIndex DbPlanModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent))
+        return QModelIndex();
+
+    if (!parent.isValid()) {
+        return createIndex(row, column, quintptr(0));
+    }
+
+    const Item &item = d.items.at(int(parent.internalId()));
+    return createIndex(row, column, quintptr(item.children.at(row)));
+}
+
+/******************************************************************/
+
+QModelIndex DbPlanModel::parent(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return QModelIndex();
+
+    const int parent = d.items.at(int(index.internalId())).parent;
+    if (parent < 0)
+        return QModelIndex();
+
+    return createIndex(d.items.at(parent).row, 0, quintptr(parent));
+}
+
+/******************************************************************/
+
+int DbPlanModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid())
+        return d.items.isEmpty() ? 0 : 1;
+
+    if (parent.column() > 0)
+        return 0;
+
+    return d.items.at(int(parent.internalId())).children.size();
+}
+
+/******************************************************************/
+
+int DbPlanModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return d.hasBaseline ? ChangeColumn + 1 : ShareColumn + 1;
+}
+
+/******************************************************************/
+
+QVariant DbPlanModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    const int idx = int(index.internalId());
+    const Item &item = d.items.at(idx);
+    const double share = d.total > 0 ? item.node->selfWeight() * 100 / d.total : 0;
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return dataValue(item, index.column());
+    case Qt::ToolTipRole: {
+        QStringList tips;
+        tips << item.node->name;
+        if (!item.node->detail.isEmpty()) tips << item.node->detail;
+        if (item.node->fullScan) tips << tr("Full scan");
+        if (d.hasBaseline && !item.base) tips << tr("Not in the baseline plan");
+        return tips.join("\n");
+    }
+    case Qt::DecorationRole:
+        if (index.column() == NodeColumn && item.node->fullScan) {
+            static QIcon warning = QIcon::fromTheme("dialog-warning");
+            return warning;
+        }
+        break;
+    case Qt::BackgroundRole:
+        if (share >= HotSharePercent) {
+            return QColor(255, 96, 0, int(40 + share * 1.8));
+        }
+        break;
+    case Qt::FontRole:
+        if (idx == d.hottest) {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        break;
+    case Qt::ForegroundRole:
+        if (d.hasBaseline && !item.base) {
+            return QColor(Qt::blue);
+        }
+        if (index.column() == ChangeColumn && item.base && item.base->weight() > 0) {
+            const double change = (item.node->weight() - item.base->weight()) * 100 / item.base->weight();
+            if (change > ChangeWarnPercent) return QColor(Qt::red);
+            if (change < -ChangeWarnPercent) return QColor(Qt::darkGreen);
+        }
+        break;
+    case Qt::TextAlignmentRole:
+        if (index.column() > DetailColumn) {
+            return int(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        break;
+    }
+
+    return QVariant();
+}
+
+/******************************************************************/
+
+void DbPlanModel::setPlan(const DbPlanNode &plan)
+{
+    beginResetModel();
+    d.plan = plan;
+    d.hasBaseline = false;
+    d.baseline = DbPlanNode();
+    rebuild();
+    endResetModel();
+}
+
+/******************************************************************/
+
+void DbPlanModel::setBaseline(const DbPlanNode &baseline)
+{
+    beginResetModel();
+    d.baseline = baseline;
+    d.hasBaseline = true;
+    rebuild();
+    endResetModel();
+}
+
+/******************************************************************/
+
+void DbPlanModel::clearBaseline()
+{
+    beginResetModel();
+    d.baseline = DbPlanNode();
+    d.hasBaseline = false;
+    rebuild();
+    endResetModel();
+}
+
+/******************************************************************/
+
+void DbPlanModel::clear()
+{
+    beginResetModel();
+    d.plan = DbPlanNode();
+    d.baseline = DbPlanNode();
+    d.hasBaseline = false;
+    d.items.clear();
+    d.total = 0;
+    d.hottest = -1;
+    endResetModel();
+}
+
+/******************************************************************/
+
+void DbPlanModel::rebuild()
+{
+    d.items.clear();
+    d.total = 0;
+    d.hottest = -1;
+    if (d.plan.name.isEmpty()) return;
+
+    const DbPlanNode *base = d.hasBaseline && d.baseline.name == d.plan.name ? &d.baseline : Q_NULLPTR;
+    addItem(&d.plan, base, -1, 0);
+
+    d.total = d.plan.weight();
+    double hottest = 0;
+    for (int i = 0; i < d.items.size(); ++i) {
+        const double self = d.items.at(i).node->selfWeight();
+        if (self > hottest) {
+            hottest = self;
+            d.hottest = i;
+        }
+    }
+}
+
+/******************************************************************/
+//! appends the node and its subtree, children are matched to the baseline by type and detail
+int DbPlanModel::addItem(const DbPlanNode *node, const DbPlanNode *base, int parent, int row)
+{
+    const int idx = d.items.size();
+    Item item;
+    item.node   = node;
+    item.base   = base;
+    item.parent = parent;
+    item.row    = row;
+    d.items.append(item);
+
+    QVector<bool> used(base ? base->children.size() : 0, false);
+    for (int i = 0; i < node->children.size(); ++i) {
+        const DbPlanNode &child = node->children.at(i);
+        const DbPlanNode *match = Q_NULLPTR;
+        for (int pass = 0; base && pass < 2 && !match; ++pass) {
+            for (int j = 0; j < base->children.size(); ++j) {
+                const DbPlanNode &candidate = base->children.at(j);
+                if (used.at(j) || candidate.name != child.name) continue;
+                if (pass == 0 && candidate.detail != child.detail) continue;
+                used[j] = true;
+                match = &candidate;
+                break;
+            }
+        }
+        const int childIdx = addItem(&child, match, idx, i);
+        d.items[idx].children.append(childIdx);
+    }
+    return idx;
+}
+
+/******************************************************************/
+
+QVariant DbPlanModel::dataValue(const Item &item, int column) const
+{
+    const DbPlanNode *node = item.node;
+    switch (column) {
+    case NodeColumn:
+        return node->name;
+    case DetailColumn:
+        return node->detail;
+    case CostColumn:
+        return number(node->cost);
+    case RowsColumn:
+        return number(node->rows);
+    case ActualRowsColumn:
+        return number(node->actualRows);
+    case LoopsColumn:
+        return number(node->loops);
+    case TimeColumn:
+        return number(node->actualMs);
+    case SelfColumn:
+        return node->actualMs < 0 ? QString() : number(node->selfWeight());
+    case ShareColumn:
+        if (d.total > 0 && node->selfWeight() >= 0) {
+            return QString("%1 %").arg(node->selfWeight() * 100 / d.total, 0, 'f', 1);
+        }
+        break;
+    case BaselineColumn:
+        if (item.base) {
+            return number(item.base->weight());
+        }
+        break;
+    case ChangeColumn:
+        if (item.base && item.base->weight() > 0) {
+            const double change = (node->weight() - item.base->weight()) * 100 / item.base->weight();
+            return QString::asprintf("%+.1f %%", change);
+        }
+        break;
+    }
+    return QVariant();
+}
+
+/******************************************************************/
+
+QString DbPlanModel::number(double value)
+{
+    if (value < 0) return QString();
+    return QString::number(value, 'f', std::floor(value) == value ? 0 : 2);
+}
+
+/******************************************************************/
@@ -0,0 +1,77 @@
+#ifndef DBPLANMODEL_H
+#define DBPLANMODEL_H
+
+#include "dbplan.h"
+
+#include <QAbstractItemModel>
+
+/******************************************************************/
+/**
+ * @brief Tree of plan nodes
+ *
+ * Nodes that take a large share of the plan weight are highlighted.
+ * With a baseline plan every node shows the weight of the matching
+ * baseline node and the change; nodes not found in the baseline are
+ * marked.
+ */
+class DbPlanModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+    struct Item {
+        const DbPlanNode *node = Q_NULLPTR;
+        const DbPlanNode *base = Q_NULLPTR; ///< matching node of the baseline plan
+        int parent = -1;
+        int row    = 0;
+        QVector<int> children;
+    };
+
+    struct DbPlanModelPrivate {
+        DbPlanNode    plan;
+        DbPlanNode    baseline;
+        bool          hasBaseline = false;
+        QVector<Item> items;       ///< depth first, the root is item 0
+        double        total   = 0; ///< weight of the root
+        int           hottest = -1;
+        QStringList   header;
+    };
+
+public:
+    explicit DbPlanModel(QObject *parent = nullptr);
+
+    // Header:
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Basic functionality:
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    const DbPlanNode &plan() const {
+        return d.plan;
+    }
+
+    void setPlan(const DbPlanNode &plan);
+
+    void setBaseline(const DbPlanNode &baseline);
+    void clearBaseline();
+
+    void clear();
+
+private:
+    void rebuild();
+    int addItem(const DbPlanNode *node, const DbPlanNode *base, int parent, int row);
+    QVariant dataValue(const Item &item, int column) const;
+
+private: // static
+    static QString number(double value);
+
+private:
+    DbPlanModelPrivate d;
+};
+
+#endif // DBPLANMODEL_H
@@ -0,0 +1,248 @@
+#include "dbprofile.h"
+
+#include <QThread>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+
+#include <algorithm>
+#include <cmath>
+
+enum {
+    ProgressRows = 1024 ///< rows between updates of the progress counter
+};
+
+/******************************************************************/
+
+DbColumnProfiler::DbColumnProfiler()
+    : m_Registers(1 << HllBits, 0)
+    , m_Random(0x5eed)
+{
+    m_Top.reserve(TopCapacity);
+    m_Sample.reserve(SampleSize);
+}
+
+/******************************************************************/
+
+void DbColumnProfiler::add(const QVariant &value)
+{
+    ++m_Rows;
+    if (value.isNull()) {
+        ++m_Nulls;
+        return;
+    }
+
+    const QString text = value.toString();
+    addDistinct(hash(text));
+    addTop(text.left(MaxTextSize));
+
+    if (m_Rows - m_Nulls == 1 || text < m_TextMin) m_TextMin = text.left(MaxTextSize);
+    if (m_Rows - m_Nulls == 1 || text > m_TextMax) m_TextMax = text.left(MaxTextSize);
+
+    bool ok = false;
+    const double number = value.toDouble(&ok);
+    if (ok && std::isfinite(number)) {
+        addNumber(number);
+    }
+}
+
+/******************************************************************/
+
+DbColumnProfile DbColumnProfiler::result() const
+{
+    DbColumnProfile result;
+    result.rows     = m_Rows;
+    result.nulls    = m_Nulls;
+    result.numbers  = m_Numbers;
+    result.distinct = m_Rows > m_Nulls ? estimateDistinct() : 0;
+
+    // numeric bounds only make sense if every value is a number
+    if (m_Numbers && m_Numbers == m_Rows - m_Nulls) {
+        result.min = QString::number(m_NumMin, 'g', 15);
+        result.max = QString::number(m_NumMax, 'g', 15);
+    } else {
+        result.min = m_TextMin;
+        result.max = m_TextMax;
+    }
+
+    for (auto it = m_Top.constBegin(); it != m_Top.constEnd(); ++it) {
+        result.top.append(qMakePair(it.key(), it.value().count));
+    }
+    std::sort(result.top.begin(), result.top.end(), [](const QPair<QString, qint64> &a, const QPair<QString, qint64> &b){
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+    });
+    if (result.top.size() > TopReported) {
+        result.top.resize(TopReported);
+    }
+
+    if (!m_Sample.isEmpty()) {
+        result.histMin = m_NumMin;
+        result.histMax = m_NumMax;
+        const int bins = m_NumMax > m_NumMin ? int(HistogramBins) : 1;
+        QVector<qint64> counts(bins, 0);
+        const double width = (m_NumMax - m_NumMin) / bins;
+        for (double value : m_Sample) {
+            const int bin = width > 0 ? int((value - m_NumMin) / width) : 0;
+            ++counts[qBound(0, bin, bins - 1)];
+        }
+        // scale the sample counts to all numeric values
+        const double scale = double(m_Numbers) / m_Sample.size();
+        result.histogram.resize(bins);
+        for (int i = 0; i < bins; ++i) {
+            result.histogram[i] = qRound64(counts.at(i) * scale);
+        }
+    }
+    return result;
+}
+
+/******************************************************************/
+
+DbColumnProfile DbColumnProfiler::run(const QString &connectionName, const QString &sql, const QVariantMap &bindings,
+                                      int column, qint64 limit,
+                                      const QAtomicInt *canceled, QAtomicInteger<qint64> *rowsRead)
+{
+    DbColumnProfile result;
+    // a connection can only be used by the thread that opened it
+    const QString name = QString("%1_profile_%2")
+            .arg(connectionName)
+            .arg(quintptr(QThread::currentThreadId()));
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(connectionName, name);
+        if (!db.open()) {
+            result.error = db.lastError().text();
+        } else {
+            DbColumnProfiler profiler;
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            bool ok = query.prepare(sql);
+            if (ok) {
+                for (auto it = bindings.constBegin(); it != bindings.constEnd(); ++it) {
+                    query.bindValue(it.key(), it.value());
+                }
+                ok = query.exec();
+            }
+            if (!ok) {
+                result.error = query.lastError().text();
+            } else {
+                bool stopped = false;
+                while ((!limit || profiler.m_Rows < limit) && query.next()) {
+                    profiler.add(query.value(column));
+                    if (profiler.m_Rows % ProgressRows == 0) {
+                        if (rowsRead) rowsRead->storeRelaxed(profiler.m_Rows);
+                        if (canceled && canceled->loadRelaxed()) {
+                            stopped = true;
+                            break;
+                        }
+                    }
+                }
+                result = profiler.result();
+                result.partial = stopped;
+                if (!stopped && query.lastError().isValid()) {
+                    result.error = query.lastError().text();
+                }
+                if (rowsRead) rowsRead->storeRelaxed(profiler.m_Rows);
+            }
+            query.finish();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+    return result;
+}
+
+/******************************************************************/
+//! FNV-1a with the MurmurHash3 finalizer, HyperLogLog needs well mixed high bits
+quint64 DbColumnProfiler::hash(const QString &text)
+{
+    quint64 h = Q_UINT64_C(14695981039346656037);
+    const ushort *data = text.utf16();
+    for (int i = 0; i < text.size(); ++i) {
+        h ^= data[i];
+        h *= Q_UINT64_C(1099511628211);
+    }
+    h ^= h >> 33;
+    h *= Q_UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= Q_UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+    return h;
+}
+
+/******************************************************************/
+
+void DbColumnProfiler::addDistinct(quint64 hash)
+{
+    const int idx = int(hash >> (64 - HllBits));
+    const quint64 rest = hash << HllBits;
+    const int rank = rest ? int(qCountLeadingZeroBits(rest)) + 1 : 64 - HllBits + 1;
+    if (rank > m_Registers.at(idx)) {
+        m_Registers[idx] = char(rank);
+    }
+}
+
+/******************************************************************/
+//! space-saving: an unknown value replaces the smallest counter
+void DbColumnProfiler::addTop(const QString &text)
+{
+    auto it = m_Top.find(text);
+    if (it != m_Top.end()) {
+        ++it.value().count;
+        return;
+    }
+
+    if (m_Top.size() < TopCapacity) {
+        m_Top.insert(text, Counter{1, 0});
+        return;
+    }
+
+    auto smallest = m_Top.begin();
+    for (auto i = m_Top.begin(); i != m_Top.end(); ++i) {
+        if (i.value().count < smallest.value().count) {
+            smallest = i;
+        }
+    }
+    const qint64 count = smallest.value().count;
+    m_Top.erase(smallest);
+    m_Top.insert(text, Counter{count + 1, count});
+}
+
+/******************************************************************/
+//! keeps the exact bounds and a uniform reservoir sample
+void DbColumnProfiler::addNumber(double number)
+{
+    if (!m_Numbers || number < m_NumMin) m_NumMin = number;
+    if (!m_Numbers || number > m_NumMax) m_NumMax = number;
+    ++m_Numbers;
+
+    if (m_Sample.size() < SampleSize) {
+        m_Sample.append(number);
+        return;
+    }
+    const quint64 slot = m_Random.generate64() % quint64(m_Numbers);
+    if (slot < quint64(SampleSize)) {
+        m_Sample[int(slot)] = number;
+    }
+}
+
+/******************************************************************/
+
+double DbColumnProfiler::estimateDistinct() const
+{
+    const double m = m_Registers.size();
+    double sum = 0;
+    int zeros = 0;
+    for (char rank : m_Registers) {
+        sum += std::ldexp(1.0, -int(rank));
+        if (!rank) ++zeros;
+    }
+
+    const double alpha = 0.7213 / (1 + 1.079 / m);
+    const double estimate = alpha * m * m / sum;
+    // linear counting is more accurate for small cardinalities
+    if (estimate <= 2.5 * m && zeros) {
+        return m * std::log(m / zeros);
+    }
+    return estimate;
+}
+
+/******************************************************************/
@@ -0,0 +1,97 @@
+#ifndef DBPROFILE_H
+#define DBPROFILE_H
+
+#include <QVariantMap>
+#include <QVector>
+#include <QPair>
+#include <QHash>
+#include <QAtomicInt>
+#include <QRandomGenerator>
+
+/******************************************************************/
+
+struct DbColumnProfile
+{
+    qint64  rows    = 0;
+    qint64  nulls   = 0;
+    qint64  numbers = 0;      ///< numeric values
+    QString min;
+    QString max;
+    double  distinct = 0;     ///< HyperLogLog estimate
+    QVector<QPair<QString, qint64>> top; ///< most frequent values, counts may be overestimated
+    double  histMin = 0;
+    double  histMax = 0;
+    QVector<qint64> histogram; ///< equal width bins of numeric values, estimated from a sample
+    bool    partial = false;  ///< canceled before the end
+    QString error;
+
+    double nullRatio() const {
+        return rows ? double(nulls) / rows : 0;
+    }
+};
+
+/******************************************************************/
+/**
+ * @brief Streaming profile of a column in bounded memory
+ *
+ * Distinct values are estimated by HyperLogLog (16384 registers, about
+ * 1% error), frequent values by a space-saving sketch and the histogram
+ * is built from a reservoir sample of the numeric values.
+ */
+class DbColumnProfiler
+{
+public:
+    enum {
+        HllBits      = 14,
+        TopCapacity  = 64,    ///< counters of the space-saving sketch
+        TopReported  = 10,
+        SampleSize   = 10000, ///< reservoir for the histogram
+        HistogramBins = 20,
+        MaxTextSize  = 200    ///< longer values are cut in the sketch
+    };
+
+    DbColumnProfiler();
+
+    void add(const QVariant &value);
+
+    DbColumnProfile result() const;
+
+public: // static
+    /**
+     * @brief Streams a column of sql through a forward-only query
+     *
+     * Runs in the calling (worker) thread on its own clone of the connection,
+     * reading stops after limit rows unless limit is 0.
+     */
+    static DbColumnProfile run(const QString &connectionName, const QString &sql, const QVariantMap &bindings,
+                               int column, qint64 limit,
+                               const QAtomicInt *canceled, QAtomicInteger<qint64> *rowsRead);
+
+    static quint64 hash(const QString &text);
+
+private:
+    void addDistinct(quint64 hash);
+    void addTop(const QString &text);
+    void addNumber(double number);
+    double estimateDistinct() const;
+
+private:
+    struct Counter {
+        qint64 count;
+        qint64 error;
+    };
+
+    qint64                  m_Rows    = 0;
+    qint64                  m_Nulls   = 0;
+    qint64                  m_Numbers = 0;
+    QString                 m_TextMin;
+    QString                 m_TextMax;
+    double                  m_NumMin  = 0;
+    double                  m_NumMax  = 0;
+    QByteArray              m_Registers;
+    QHash<QString, Counter> m_Top;
+    QVector<double>         m_Sample;
+    QRandomGenerator        m_Random;
+};
+
+#endif // DBPROFILE_H
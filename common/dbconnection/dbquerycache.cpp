@@ -0,0 +1,104 @@
+#include "dbquerycache.h"
+
+#include <QRegularExpression>
+
+/******************************************************************/
+
+DbQueryCache::DbQueryCache(int capacity)
+    : m_Cache(capacity)
+    , m_Hits(0)
+    , m_Misses(0)
+{
+}
+
+/******************************************************************/
+
+QSqlQuery DbQueryCache::prepare(const QSqlDatabase &db, const QString &sql, bool *ok)
+{
+    const QString key = normalize(sql);
+
+    if (QSqlQuery *cached = m_Cache.object(key)) {
+        ++m_Hits;
+        if (ok) *ok = true;
+        return *cached;
+    }
+
+    ++m_Misses;
+    QSqlQuery query(db);
+    const bool prepared = query.prepare(sql);
+    if (prepared) {
+        m_Cache.insert(key, new QSqlQuery(query));
+    }
+    if (ok) *ok = prepared;
+    return query;
+}
+
+/******************************************************************/
+
+void DbQueryCache::clear()
+{
+    m_Cache.clear();
+    m_Hits = 0;
+    m_Misses = 0;
+}
+
+/******************************************************************/
+//! trims the text and collapses whitespace outside of quoted text and comments
+QString DbQueryCache::normalize(const QString &sql)
+{
+    static const QRegularExpression dollarTag("\\G\\$(?:[A-Za-z_][A-Za-z0-9_]*)?\\$");
+
+    const QString text = sql.trimmed();
+    QString result;
+    result.reserve(text.size());
+
+    bool space = false;
+    int i = 0;
+    while (i < text.size()) {
+        const QChar ch = text.at(i);
+        if (ch.isSpace()) {
+            space = true;
+            ++i;
+            continue;
+        }
+        if (space) {
+            result.append(QLatin1Char(' '));
+            space = false;
+        }
+
+        // quoted text and comments are kept as they are
+        int end = -1;
+        const QStringRef rest = text.midRef(i);
+        if (rest.startsWith(QLatin1String("--"))) {
+            // the line break ends the comment, it is not collapsed
+            end = text.indexOf(QLatin1Char('\n'), i);
+            end = end < 0 ? text.size() : end + 1;
+        } else if (rest.startsWith(QLatin1String("/*"))) {
+            end = text.indexOf(QLatin1String("*/"), i + 2);
+            end = end < 0 ? text.size() : end + 2;
+        } else if (ch == QLatin1Char('\'') || ch == QLatin1Char('"') || ch == QLatin1Char('`')) {
+            end = text.indexOf(ch, i + 1);
+            end = end < 0 ? text.size() : end + 1;
+        } else if (ch == QLatin1Char('[')) {
+            end = text.indexOf(QLatin1Char(']'), i + 1);
+            end = end < 0 ? text.size() : end + 1;
+        } else if (ch == QLatin1Char('$')) {
+            const QRegularExpressionMatch tag = dollarTag.match(text, i);
+            if (tag.hasMatch()) {
+                end = text.indexOf(tag.captured(), i + tag.capturedLength());
+                end = end < 0 ? text.size() : end + tag.capturedLength();
+            }
+        }
+
+        if (end < 0) {
+            result.append(ch);
+            ++i;
+        } else {
+            result.append(text.midRef(i, end - i));
+            i = end;
+        }
+    }
+    return result;
+}
+
+/******************************************************************/
@@ -0,0 +1,57 @@
+#ifndef DBQUERYCACHE_H
+#define DBQUERYCACHE_H
+
+#include <QCache>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+/******************************************************************/
+/**
+ * @brief LRU cache of prepared statements of one database connection
+ *
+ * Statements are keyed by the normalized SQL text, so running the same
+ * query again only rebinds the values and executes the prepared statement.
+ */
+class DbQueryCache
+{
+public:
+    enum { DefaultCapacity = 32 };
+
+    explicit DbQueryCache(int capacity = DefaultCapacity);
+
+    /// returns prepared query for sql, ok is false if prepare failed
+    QSqlQuery prepare(const QSqlDatabase &db, const QString &sql, bool *ok = Q_NULLPTR);
+
+    /// drop all cached statements (must be called before the database is closed)
+    void clear();
+
+    int capacity() const {
+        return m_Cache.maxCost();
+    }
+
+    void setCapacity(int capacity) {
+        m_Cache.setMaxCost(capacity);
+    }
+
+    int size() const {
+        return m_Cache.size();
+    }
+
+    int hits() const {
+        return m_Hits;
+    }
+
+    int misses() const {
+        return m_Misses;
+    }
+
+public: // static
+    static QString normalize(const QString &sql);
+
+private:
+    QCache<QString, QSqlQuery> m_Cache;
+    int m_Hits;
+    int m_Misses;
+};
+
+#endif // DBQUERYCACHE_H
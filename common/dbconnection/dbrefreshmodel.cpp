@@ -0,0 +1,406 @@
+#include "dbrefreshmodel.h"
+
+#include <QtConcurrent>
+#include <QColor>
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlRecord>
+#include <QSqlQuery>
+#include <QSqlError>
+
+/******************************************************************/
+
+static bool sameValue(const QVariant &a, const QVariant &b)
+{
+    return a.isNull() == b.isNull() && a == b;
+}
+
+/******************************************************************/
+
+DbRefreshModel::DbRefreshModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+    connect(&d.timer, &QTimer::timeout,
+            this, &DbRefreshModel::refresh);
+    connect(&d.watcher, &QFutureWatcher<DbRefreshResult>::finished,
+            this, &DbRefreshModel::applyResult);
+
+    // a connection can only be used by the thread that opened it
+    d.pool.setMaxThreadCount(1);
+    d.pool.setExpiryTimeout(-1);
+}
+
+/******************************************************************/
+
+DbRefreshModel::~DbRefreshModel()
+{
+    d.timer.stop();
+    d.watcher.waitForFinished();
+    closeWorker();
+    d.pool.waitForDone();
+}
+
+/******************************************************************/
+
+QVariant DbRefreshModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return d.fields.value(section);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+/******************************************************************/
+
+int DbRefreshModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return d.rows.size();
+}
+
+/******************************************************************/
+
+int DbRefreshModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return d.fields.size();
+}
+
+/******************************************************************/
+
+QVariant DbRefreshModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= d.rows.size())
+        return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return d.rows.at(index.row()).value(index.column());
+    case Qt::BackgroundRole: {
+        const QBitArray &marks = d.marks.at(index.row());
+        if (index.column() < marks.size() && marks.testBit(index.column())) {
+            return QColor(255, 224, 96, 120);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+/******************************************************************/
+
+void DbRefreshModel::setQuery(const QString &connectionName, const QString &sql, const QVariantMap &bindings)
+{
+    if (connectionName != d.connectionName) {
+        closeWorker();
+    }
+    d.connectionName = connectionName;
+    d.sql = sql;
+    d.bindings = bindings;
+    d.skipped = 0;
+    d.error.clear();
+
+    beginResetModel();
+    d.fields.clear();
+    d.rows.clear();
+    d.marks.clear();
+    endResetModel();
+}
+
+/******************************************************************/
+
+void DbRefreshModel::setRows(const QStringList &fields, const QVector<Row> &rows)
+{
+    beginResetModel();
+    d.fields = fields;
+    d.rows = rows;
+    d.marks = QVector<QBitArray>(d.rows.size());
+    endResetModel();
+}
+
+/******************************************************************/
+
+void DbRefreshModel::setKeyColumns(const QVector<int> &columns)
+{
+    d.keyColumns = columns;
+}
+
+/******************************************************************/
+
+void DbRefreshModel::setInterval(int seconds)
+{
+    d.timer.setInterval(qMax(1, seconds) * 1000);
+}
+
+/******************************************************************/
+
+void DbRefreshModel::start()
+{
+    if (d.sql.isEmpty()) return;
+
+    refresh();
+    d.timer.start();
+}
+
+/******************************************************************/
+
+void DbRefreshModel::stop()
+{
+    d.timer.stop();
+    closeWorker();
+}
+
+/******************************************************************/
+
+void DbRefreshModel::refresh()
+{
+    // a slow query must not pile up runs
+    if (d.watcher.isRunning()) {
+        ++d.skipped;
+        return;
+    }
+
+    if (d.workerName.isEmpty()) {
+        d.workerName = QString("%1_refresh_%2")
+                .arg(d.connectionName)
+                .arg(quintptr(this));
+    }
+    const QString connectionName = d.connectionName;
+    const QString workerName = d.workerName;
+    const QString sql = d.sql;
+    const QVariantMap bindings = d.bindings;
+    d.watcher.setFuture(QtConcurrent::run(&d.pool, [connectionName, workerName, sql, bindings]() {
+        return DbRefreshModel::run(connectionName, workerName, sql, bindings);
+    }));
+}
+
+/******************************************************************/
+
+void DbRefreshModel::applyResult()
+{
+    DbRefreshResult result = d.watcher.result();
+    d.refreshedAt = QDateTime::currentDateTime();
+    d.error = result.error;
+    if (!result.error.isEmpty()) {
+        emit refreshed();
+        return;
+    }
+
+    // another shape replaces everything
+    if (result.fields != d.fields) {
+        beginResetModel();
+        d.fields = result.fields;
+        d.rows = result.rows;
+        d.marks = QVector<QBitArray>(d.rows.size());
+        endResetModel();
+        emit refreshed();
+        return;
+    }
+
+    clearMarks();
+
+    // pair every new row with a shown row
+    const int columns = d.fields.size();
+    QVector<int> match(result.rows.size(), -1);
+    QBitArray matched(d.rows.size());
+    if (d.keyColumns.isEmpty()) {
+        for (int j = 0; j < match.size() && j < d.rows.size(); ++j) {
+            match[j] = j;
+            matched.setBit(j);
+        }
+    } else {
+        QHash<QString, int> rowOfKey;
+        rowOfKey.reserve(d.rows.size());
+        for (int i = d.rows.size() - 1; i >= 0; --i) {
+            rowOfKey.insert(keyOf(d.rows.at(i)), i);
+        }
+        for (int j = 0; j < match.size(); ++j) {
+            const int i = rowOfKey.value(keyOf(result.rows.at(j)), -1);
+            if (i >= 0 && !matched.testBit(i)) {
+                match[j] = i;
+                matched.setBit(i);
+            }
+        }
+    }
+
+    // vanished rows leave in runs from the bottom
+    QVector<int> shift(d.rows.size(), 0);
+    int removed = 0;
+    for (int i = 0; i < d.rows.size(); ++i) {
+        if (!matched.testBit(i)) ++removed;
+        shift[i] = removed;
+    }
+    for (int last = d.rows.size() - 1; last >= 0; ) {
+        if (matched.testBit(last)) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !matched.testBit(first - 1)) --first;
+        beginRemoveRows(QModelIndex(), first, last);
+        d.rows.remove(first, last - first + 1);
+        d.marks.remove(first, last - first + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
+
+    // kept rows only take their changed cells
+    QVector<Row> added;
+    QVector<int> position(match.size());  ///< shown row of every result row
+    for (int j = 0; j < match.size(); ++j) {
+        const Row &row = result.rows.at(j);
+        if (match.at(j) < 0) {
+            position[j] = d.rows.size() + added.size();
+            added << row;
+            continue;
+        }
+        const int i = match.at(j) - shift.at(match.at(j));
+        position[j] = i;
+        Row &shown = d.rows[i];
+        for (int c = 0; c < columns; ++c) {
+            if (sameValue(shown.at(c), row.at(c))) continue;
+            shown[c] = row.at(c);
+            if (d.marks.at(i).isEmpty()) d.marks[i].resize(columns);
+            d.marks[i].setBit(c);
+            const QModelIndex cell = index(i, c);
+            emit dataChanged(cell, cell);
+        }
+    }
+
+    if (!added.isEmpty()) {
+        const int first = d.rows.size();
+        beginInsertRows(QModelIndex(), first, first + added.size() - 1);
+        d.rows << added;
+        d.marks.resize(d.rows.size());
+        for (int i = first; i < d.marks.size(); ++i) {
+            d.marks[i].fill(true, columns);
+        }
+        endInsertRows();
+    }
+
+    // moved and new rows take their place in the result
+    bool ordered = true;
+    for (int j = 0; j < position.size() && ordered; ++j) {
+        ordered = position.at(j) == j;
+    }
+    if (!ordered) {
+        emit layoutAboutToBeChanged();
+        QVector<Row> rows(position.size());
+        QVector<QBitArray> marks(position.size());
+        QVector<int> target(position.size());
+        for (int j = 0; j < position.size(); ++j) {
+            rows[j]  = d.rows.at(position.at(j));
+            marks[j] = d.marks.at(position.at(j));
+            target[position.at(j)] = j;
+        }
+        d.rows  = rows;
+        d.marks = marks;
+
+        const QModelIndexList from = persistentIndexList();
+        QModelIndexList to;
+        for (const auto &idx : from) {
+            to << index(target.value(idx.row()), idx.column());
+        }
+        changePersistentIndexList(from, to);
+        emit layoutChanged();
+    }
+
+    emit refreshed();
+}
+
+/******************************************************************/
+
+QString DbRefreshModel::keyOf(const Row &row) const
+{
+    QStringList parts;
+    for (int c : d.keyColumns) {
+        const QVariant value = row.value(c);
+        parts << (value.isNull() ? QStringLiteral("\x01") : value.toString());
+    }
+    return parts.join(QChar(0x1f));
+}
+
+/******************************************************************/
+
+void DbRefreshModel::clearMarks()
+{
+    const int last = d.fields.size() - 1;
+    for (int i = 0; i < d.marks.size(); ++i) {
+        if (d.marks.at(i).isEmpty()) continue;
+        d.marks[i] = QBitArray();
+        emit dataChanged(index(i, 0), index(i, last), {Qt::BackgroundRole});
+    }
+}
+
+/******************************************************************/
+//! the connection is removed by the worker thread after the running refresh
+void DbRefreshModel::closeWorker()
+{
+    if (d.workerName.isEmpty()) return;
+
+    const QString workerName = d.workerName;
+    d.workerName.clear();
+    QtConcurrent::run(&d.pool, [workerName]() {
+        QSqlDatabase::removeDatabase(workerName);
+    });
+}
+
+/******************************************************************/
+
+DbRefreshResult DbRefreshModel::run(const QString &connectionName, const QString &workerName,
+                                    const QString &sql, const QVariantMap &bindings)
+{
+    DbRefreshResult result;
+    QSqlDatabase db = QSqlDatabase::database(workerName, false);
+    if (!db.isValid()) {
+        db = QSqlDatabase::cloneDatabase(connectionName, workerName);
+    }
+    if (!db.isOpen() && !db.open()) {
+        result.error = db.lastError().text();
+        return result;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    bool ok = query.prepare(sql);
+    if (ok) {
+        for (auto it = bindings.constBegin(); it != bindings.constEnd(); ++it) {
+            query.bindValue(it.key(), it.value());
+        }
+        ok = query.exec();
+    }
+    if (!ok) {
+        result.error = query.lastError().text();
+    } else {
+        const QSqlRecord record = query.record();
+        for (int c = 0; c < record.count(); ++c) {
+            result.fields << record.fieldName(c);
+        }
+        while (result.rows.size() < MaxRows && query.next()) {
+            Row row(record.count());
+            for (int c = 0; c < row.size(); ++c) {
+                row[c] = query.value(c);
+            }
+            result.rows << row;
+        }
+        if (query.lastError().isValid()) {
+            result.error = query.lastError().text();
+        }
+    }
+    query.finish();
+
+    // a lost connection is opened again by the next run
+    if (!result.error.isEmpty()) {
+        db.close();
+    }
+    return result;
+}
+
+/******************************************************************/
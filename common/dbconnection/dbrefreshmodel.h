@@ -0,0 +1,129 @@
+#ifndef DBREFRESHMODEL_H
+#define DBREFRESHMODEL_H
+
+#include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QVariantMap>
+#include <QBitArray>
+#include <QDateTime>
+#include <QVector>
+#include <QTimer>
+#include <QThreadPool>
+
+/******************************************************************/
+
+struct DbRefreshResult
+{
+    QStringList fields;
+    QVector<QVector<QVariant>> rows;
+    QString error;
+};
+
+/******************************************************************/
+/**
+ * @brief Query result which is executed again on a timer
+ *
+ * Every run is executed on a clone of the connection, which is opened by
+ * the first run and kept in the single thread of the model's pool until
+ * the refresh stops; a tick is skipped while the previous run is still
+ * in flight. The new
+ * rows are matched with the shown rows by the key columns, or by position
+ * without keys. Only changed cells are written and reported by
+ * dataChanged(), they are highlighted until the next run. Vanished rows
+ * are removed and new rows are inserted, unchanged rows are not touched;
+ * the rows are then rearranged in the order of the result.
+ */
+class DbRefreshModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    typedef QVector<QVariant> Row;
+
+    enum {
+        MaxRows = 100000  ///< rows read by a run
+    };
+
+private:
+    struct DbRefreshModelPrivate {
+        QString          connectionName;
+        QString          sql;
+        QVariantMap      bindings;
+        QVector<int>     keyColumns;  ///< empty matches rows by position
+        QStringList      fields;
+        QVector<Row>     rows;
+        QVector<QBitArray> marks;     ///< cells changed by the last run, empty for untouched rows
+        QTimer           timer;
+        QThreadPool      pool;        ///< one thread, it owns the worker connection
+        QString          workerName;  ///< connection of the worker, empty while none is open
+        QFutureWatcher<DbRefreshResult> watcher;
+        int              skipped = 0;
+        QDateTime        refreshedAt;
+        QString          error;
+    };
+
+public:
+    explicit DbRefreshModel(QObject *parent = nullptr);
+    ~DbRefreshModel();
+
+    // Header:
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Basic functionality:
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /// the query of a named connection, clears the shown rows
+    void setQuery(const QString &connectionName, const QString &sql, const QVariantMap &bindings);
+
+    /// rows shown until the first run, which is compared with them
+    void setRows(const QStringList &fields, const QVector<Row> &rows);
+
+    void setKeyColumns(const QVector<int> &columns);
+
+    void setInterval(int seconds);
+
+    bool isRunning() const {
+        return d.timer.isActive();
+    }
+
+    /// ticks skipped because the previous run was not finished
+    int skippedTicks() const {
+        return d.skipped;
+    }
+
+    QDateTime refreshedAt() const {
+        return d.refreshedAt;
+    }
+
+    QString lastError() const {
+        return d.error;
+    }
+
+public Q_SLOTS:
+    void start();
+    void stop();
+    void refresh();
+
+Q_SIGNALS:
+    void refreshed();
+
+private Q_SLOTS:
+    void applyResult();
+
+private:
+    QString keyOf(const Row &row) const;
+    void clearMarks();
+    void closeWorker();
+
+private: // static
+    static DbRefreshResult run(const QString &connectionName, const QString &workerName,
+                               const QString &sql, const QVariantMap &bindings);
+
+private:
+    DbRefreshModelPrivate d;
+};
+
+#endif // DBREFRESHMODEL_H
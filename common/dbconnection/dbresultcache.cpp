@@ -0,0 +1,205 @@
+#include "dbresultcache.h"
+
+#include "dbconnection.h"
+#include "dbresultmodel.h"
+
+#include <QSettings>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QDir>
+
+enum {
+    CacheMagic   = 0x51524331, // "QRC1"
+    RowMarker    = 1,
+    EndMarker    = 0
+};
+
+/******************************************************************/
+
+DbResultCache::DbResultCache()
+{
+    const DbResultCacheSettings S;
+    QSettings settings;
+    m_Enabled = settings.value(S.ENABLED, false).toBool();
+    m_MaxSize = settings.value(S.MAXSIZE, 256).toLongLong() * 1024 * 1024;
+    m_Ttl     = settings.value(S.TTL, 3600).toInt();
+
+    m_Dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/results";
+}
+
+/******************************************************************/
+
+void DbResultCache::setEnabled(bool enabled)
+{
+    const DbResultCacheSettings S;
+    m_Enabled = enabled;
+    QSettings settings;
+    settings.setValue(S.ENABLED, enabled);
+}
+
+/******************************************************************/
+
+QString DbResultCache::key(const DbConnection *dbc, const QString &sql, const QVariantMap &bindings) const
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << dbc->dbparam->driver()
+        << dbc->dbparam->hostname()
+        << qint32(dbc->dbparam->port())
+        << dbc->dbparam->database()
+        << dbc->dbparam->username()
+        << DbQueryCache::normalize(sql)
+        << bindings;
+    return QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+}
+
+/******************************************************************/
+
+bool DbResultCache::load(const QString &key, DbResultModel *model) const
+{
+    QFileInfo info(fileName(key));
+    if (!info.exists()) return false;
+    if (info.lastModified().secsTo(QDateTime::currentDateTime()) > m_Ttl) {
+        QFile::remove(info.filePath());
+        return false;
+    }
+
+    QFile file(info.filePath());
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    QDateTime cachedAt;
+    QStringList fields;
+    in >> magic;
+    if (magic != CacheMagic) return false;
+    in >> cachedAt >> fields;
+
+    // rows are appended block by block so the model can spill them
+    model->setFields(fields);
+    QVector<DbResultModel::Row> rows;
+    quint8 marker = EndMarker;
+    in >> marker;
+    while (in.status() == QDataStream::Ok && marker == RowMarker) {
+        DbResultModel::Row row(fields.size());
+        for (int c = 0; c < fields.size(); ++c) {
+            in >> row[c];
+        }
+        rows.append(row);
+        if (rows.size() == DbResultModel::BlockRows) {
+            model->appendRows(rows);
+            rows.clear();
+        }
+        in >> marker;
+    }
+    if (in.status() != QDataStream::Ok) {
+        model->clear();
+        return false;
+    }
+
+    model->appendRows(rows);
+    model->setCachedAt(cachedAt);
+    return true;
+}
+
+/******************************************************************/
+
+bool DbResultCache::beginStore(const QString &key, const QStringList &fields)
+{
+    cancelStore();
+    if (!QDir().mkpath(m_Dir)) return false;
+
+    m_Store.reset(new QSaveFile(fileName(key)));
+    if (!m_Store->open(QIODevice::WriteOnly)) {
+        m_Store.reset();
+        return false;
+    }
+
+    m_Out.setDevice(m_Store.data());
+    m_Out.setVersion(QDataStream::Qt_5_6);
+    m_Out << quint32(CacheMagic) << QDateTime::currentDateTime() << fields;
+    return true;
+}
+
+/******************************************************************/
+
+void DbResultCache::storeRow(const QVector<QVariant> &row)
+{
+    if (!m_Store) return;
+
+    m_Out << quint8(RowMarker);
+    for (const auto &value : row) {
+        m_Out << value;
+    }
+
+    // one result may not take more than a quarter of the cache
+    if (m_Store->pos() > m_MaxSize / 4) {
+        cancelStore();
+    }
+}
+
+/******************************************************************/
+
+bool DbResultCache::endStore()
+{
+    if (!m_Store) return false;
+
+    m_Out << quint8(EndMarker);
+    m_Out.setDevice(Q_NULLPTR);
+    const bool ok = m_Store->commit();
+    m_Store.reset();
+    prune();
+    return ok;
+}
+
+/******************************************************************/
+
+void DbResultCache::cancelStore()
+{
+    if (!m_Store) return;
+
+    m_Out.setDevice(Q_NULLPTR);
+    m_Store->cancelWriting();
+    m_Store->commit();
+    m_Store.reset();
+}
+
+/******************************************************************/
+
+void DbResultCache::clear()
+{
+    QDir dir(m_Dir);
+    const auto entries = dir.entryInfoList(QStringList("*.qres"), QDir::Files);
+    for (const auto &entry : entries) {
+        QFile::remove(entry.filePath());
+    }
+}
+
+/******************************************************************/
+
+QString DbResultCache::fileName(const QString &key) const
+{
+    return QString("%1/%2.qres").arg(m_Dir, key);
+}
+
+/******************************************************************/
+//! removes expired results and the oldest ones above the size cap
+void DbResultCache::prune()
+{
+    QDir dir(m_Dir);
+    const auto entries = dir.entryInfoList(QStringList("*.qres"), QDir::Files, QDir::Time);
+    const QDateTime now = QDateTime::currentDateTime();
+
+    qint64 total = 0;
+    for (const auto &entry : entries) {
+        total += entry.size();
+        if (total > m_MaxSize || entry.lastModified().secsTo(now) > m_Ttl) {
+            QFile::remove(entry.filePath());
+        }
+    }
+}
+
+/******************************************************************/
@@ -0,0 +1,82 @@
+#ifndef DBRESULTCACHE_H
+#define DBRESULTCACHE_H
+
+#include <QVariantMap>
+#include <QVector>
+#include <QDataStream>
+#include <QScopedPointer>
+#include <QSaveFile>
+
+class DbConnection;
+class DbResultModel;
+
+/******************************************************************/
+/**
+ * @brief Opt-in on-disk cache of query results
+ *
+ * Results are keyed by the connection parameters, the normalized SQL
+ * text and the bind values. Every result is a binary file in the
+ * application cache directory; files older than ttl() are ignored and
+ * the oldest files are removed when the directory exceeds maxSize().
+ * A result is written while its rows are fetched, between beginStore()
+ * and endStore().
+ */
+class DbResultCache
+{
+    struct DbResultCacheSettings {
+        const QString ENABLED = "resultcache/enabled";
+        const QString MAXSIZE = "resultcache/maxsize";
+        const QString TTL     = "resultcache/ttl";
+    };
+
+public:
+    DbResultCache();
+
+    bool isEnabled() const {
+        return m_Enabled;
+    }
+
+    void setEnabled(bool enabled);
+
+    /// cap of the cache directory in bytes
+    qint64 maxSize() const {
+        return m_MaxSize;
+    }
+
+    /// seconds while a stored result is valid
+    int ttl() const {
+        return m_Ttl;
+    }
+
+    QString key(const DbConnection *dbc, const QString &sql, const QVariantMap &bindings) const;
+
+    /// reads a valid stored result into model
+    bool load(const QString &key, DbResultModel *model) const;
+
+    /// starts to store a result, false if it cannot be written
+    bool beginStore(const QString &key, const QStringList &fields);
+
+    /// appends a row of the stored result, drops the result above the limit
+    void storeRow(const QVector<QVariant> &row);
+
+    /// stores the result if all rows could be written
+    bool endStore();
+
+    void cancelStore();
+
+    void clear();
+
+private:
+    QString fileName(const QString &key) const;
+    void prune();
+
+private:
+    QString m_Dir;
+    bool    m_Enabled;
+    qint64  m_MaxSize;
+    int     m_Ttl;
+    QScopedPointer<QSaveFile> m_Store;  ///< result being written
+    QDataStream               m_Out;
+};
+
+#endif // DBRESULTCACHE_H
@@ -0,0 +1,349 @@
+#include "dbresultmodel.h"
+
+#include <QSettings>
+#include <QStandardPaths>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QSqlRecord>
+#include <QSqlError>
+
+/******************************************************************/
+
+DbResultModel::DbResultModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+    const DbResultModelSettings S;
+    QSettings settings;
+    d.budget = settings.value(S.BUDGET, 512).toLongLong() * 1024 * 1024;
+}
+
+/******************************************************************/
+
+DbResultModel::~DbResultModel()
+{
+    closeSpill();
+}
+
+/******************************************************************/
+
+QVariant DbResultModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        const QString header = d.headers.value(section);
+        return header.isEmpty() ? d.fields.value(section) : header;
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+/******************************************************************/
+
+bool DbResultModel::setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role)
+{
+    if (orientation != Qt::Horizontal || (role != Qt::EditRole && role != Qt::DisplayRole)
+            || section < 0 || section >= d.fields.size()) {
+        return false;
+    }
+
+    while (d.headers.size() < d.fields.size()) {
+        d.headers.append(QString());
+    }
+    d.headers[section] = value.toString();
+    emit headerDataChanged(orientation, section, section);
+    return true;
+}
+
+/******************************************************************/
+
+int DbResultModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return d.rowCount;
+}
+
+/******************************************************************/
+
+int DbResultModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return d.fields.size();
+}
+
+/******************************************************************/
+
+QVariant DbResultModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return blockRows(index.row() / BlockRows).value(index.row() % BlockRows).value(index.column());
+    }
+
+    return QVariant();
+}
+
+/******************************************************************/
+
+bool DbResultModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !d.query.isNull();
+}
+
+/******************************************************************/
+
+void DbResultModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || !d.query) return;
+
+    QElapsedTimer timer;
+    timer.start();
+    const int columns = d.fields.size();
+    QVector<Row> rows;
+    rows.reserve(BlockRows);
+    bool more = true;
+    while (rows.size() < BlockRows && (more = d.query->next())) {
+        Row row(columns);
+        for (int c = 0; c < columns; ++c) {
+            row[c] = d.query->value(c);
+        }
+        rows.append(row);
+    }
+    d.fetchUs += timer.nsecsElapsed() / 1000;
+
+    appendRows(rows);
+    emit rowsFetched(rows);
+    if (!more) {
+        if (d.query->lastError().isValid()) {
+            d.fetchError = d.query->lastError().text();
+        }
+        closeQuery(d.fetchError.isEmpty());
+    }
+}
+
+/******************************************************************/
+
+void DbResultModel::clear()
+{
+    closeQuery(false);
+    beginResetModel();
+    d.fields.clear();
+    d.headers.clear();
+    d.blocks.clear();
+    d.rowCount = 0;
+    d.memory   = 0;
+    d.cachedAt = QDateTime();
+    closeSpill();
+    endResetModel();
+}
+
+/******************************************************************/
+
+void DbResultModel::setFields(const QStringList &fields)
+{
+    closeQuery(false);
+    beginResetModel();
+    d.fields = fields;
+    d.headers.clear();
+    d.blocks.clear();
+    d.rowCount = 0;
+    d.memory   = 0;
+    closeSpill();
+    endResetModel();
+}
+
+/******************************************************************/
+
+void DbResultModel::setQuery(const QSqlQuery &query)
+{
+    const QSqlRecord record = query.record();
+    QStringList fields;
+    for (int c = 0; c < record.count(); ++c) {
+        fields << record.fieldName(c);
+    }
+    setFields(fields);
+    d.query.reset(new QSqlQuery(query));
+    d.fetchUs = 0;
+    d.fetchError.clear();
+}
+
+/******************************************************************/
+
+DbResultModel::Row DbResultModel::row(int idx) const
+{
+    return blockRows(idx / BlockRows).value(idx % BlockRows);
+}
+
+/******************************************************************/
+
+void DbResultModel::appendRows(const QVector<Row> &rows)
+{
+    if (rows.isEmpty()) return;
+
+    beginInsertRows(QModelIndex(), d.rowCount, d.rowCount + rows.size() - 1);
+    for (const auto &row : rows) {
+        if (d.blocks.isEmpty() || d.blocks.last().count == BlockRows) {
+            d.blocks.append(Block());
+            d.blocks.last().rows.reserve(BlockRows);
+        }
+        Block &block = d.blocks.last();
+        const qint64 bytes = rowBytes(row);
+        block.rows.append(row);
+        ++block.count;
+        block.bytes += bytes;
+        d.memory    += bytes;
+    }
+    d.rowCount += rows.size();
+    spillBlocks();
+    endInsertRows();
+}
+
+/******************************************************************/
+
+void DbResultModel::setMemoryBudget(qint64 bytes)
+{
+    const DbResultModelSettings S;
+    d.budget = bytes;
+    QSettings settings;
+    settings.setValue(S.BUDGET, bytes / 1024 / 1024);
+    spillBlocks();
+}
+
+/******************************************************************/
+//! rows of a block, spilled blocks are decoded from the mapped file
+const QVector<DbResultModel::Row> &DbResultModel::blockRows(int idx) const
+{
+    static const QVector<Row> empty;
+    if (idx < 0 || idx >= d.blocks.size()) return empty;
+
+    const Block &block = d.blocks.at(idx);
+    if (block.offset < 0) return block.rows;
+
+    for (int i = 0; i < d.decoded.size(); ++i) {
+        if (d.decoded.at(i).first == idx) {
+            if (i) d.decoded.move(i, 0);
+            return d.decoded.first().second;
+        }
+    }
+
+    // the file grows with every spill, map it again if the block is behind the mapping
+    if (block.offset + block.size > d.mapped) {
+        if (d.map) d.spill->unmap(d.map);
+        d.mapped = d.spill->size();
+        d.map = d.spill->map(0, d.mapped);
+        if (!d.map) {
+            d.mapped = 0;
+            return empty;
+        }
+    }
+
+    const QByteArray data = QByteArray::fromRawData(reinterpret_cast<const char *>(d.map + block.offset),
+                                                    int(block.size));
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_6);
+    QVector<Row> rows(block.count);
+    for (int r = 0; r < block.count; ++r) {
+        in >> rows[r];
+    }
+
+    d.decoded.prepend(qMakePair(idx, rows));
+    while (d.decoded.size() > CachedBlocks) {
+        d.decoded.removeLast();
+    }
+    return d.decoded.first().second;
+}
+
+/******************************************************************/
+//! writes the oldest blocks to the spill file until the rows fit into the budget
+void DbResultModel::spillBlocks()
+{
+    // the last block is still filled
+    while (d.budget > 0 && d.memory > d.budget && d.spilled < d.blocks.size() - 1) {
+        if (!d.spill) {
+            QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+            d.spill.reset(new QTemporaryFile(QStandardPaths::writableLocation(QStandardPaths::TempLocation)
+                                             + "/qtsqlview-XXXXXX.spill"));
+            if (!d.spill->open()) {
+                qWarning("Result rows could not be spilled to %s: %s",
+                         qPrintable(d.spill->fileName()), qPrintable(d.spill->errorString()));
+                d.spill.reset();
+                d.budget = 0;
+                return;
+            }
+        }
+
+        Block &block = d.blocks[d.spilled];
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_6);
+        for (const auto &row : qAsConst(block.rows)) {
+            out << row;
+        }
+
+        const qint64 offset = d.spill->size();
+        if (!d.spill->seek(offset) || d.spill->write(data) != data.size() || !d.spill->flush()) {
+            qWarning("Result rows could not be spilled: %s", qPrintable(d.spill->errorString()));
+            d.budget = 0;
+            return;
+        }
+
+        block.offset = offset;
+        block.size   = data.size();
+        block.rows   = QVector<Row>();
+        d.memory    -= block.bytes;
+        ++d.spilled;
+    }
+}
+
+/******************************************************************/
+
+void DbResultModel::closeSpill()
+{
+    d.decoded.clear();
+    if (d.map) {
+        d.spill->unmap(d.map);
+        d.map = Q_NULLPTR;
+    }
+    d.mapped  = 0;
+    d.spilled = 0;
+    d.spill.reset();
+}
+
+/******************************************************************/
+//! the query is finished, a prepared statement stays prepared for the next execution
+void DbResultModel::closeQuery(bool complete)
+{
+    if (!d.query) return;
+
+    d.query->finish();
+    d.query.reset();
+    emit fetchFinished(complete);
+}
+
+/******************************************************************/
+//! approximate heap usage of a row
+qint64 DbResultModel::rowBytes(const Row &row)
+{
+    qint64 result = sizeof(Row) + row.size() * sizeof(QVariant);
+    for (const auto &value : row) {
+        switch (value.type()) {
+        case QVariant::String:
+            result += value.toString().size() * 2;
+            break;
+        case QVariant::ByteArray:
+            result += value.toByteArray().size();
+            break;
+        default:
+            break;
+        }
+    }
+    return result;
+}
+
+/******************************************************************/
@@ -0,0 +1,148 @@
+#ifndef DBRESULTMODEL_H
+#define DBRESULTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QDateTime>
+#include <QVector>
+#include <QTemporaryFile>
+#include <QScopedPointer>
+#include <QSqlQuery>
+
+/******************************************************************/
+/**
+ * @brief Read-only table of materialized result rows
+ *
+ * Holds the rows of the query tab, fetched block by block from a
+ * forward-only query while the view asks for them, concatenated batch
+ * results and results read back from the result cache.
+ * Rows are kept in blocks; when the rows exceed the memory budget the
+ * oldest blocks are serialized into a temporary spill file, which is
+ * memory-mapped to read them back. A few decoded blocks are cached.
+ */
+class DbResultModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+    struct DbResultModelSettings {
+        const QString BUDGET = "resultmodel/budget";  ///< MB
+    };
+
+public:
+    typedef QVector<QVariant> Row;
+
+    enum {
+        BlockRows    = 1024,
+        CachedBlocks = 4
+    };
+
+private:
+    struct Block {
+        QVector<Row> rows;        ///< empty when spilled
+        int          count  = 0;
+        qint64       bytes  = 0;  ///< estimated memory of the rows
+        qint64       offset = -1; ///< position in the spill file
+        qint64       size   = 0;
+    };
+
+    struct DbResultModelPrivate {
+        QStringList    fields;
+        QStringList    headers;        ///< titles set by setHeaderData, empty for the field name
+        QVector<Block> blocks;
+        int            rowCount = 0;
+        int            spilled  = 0;   ///< blocks in the spill file, always the first ones
+        qint64         memory   = 0;   ///< estimated memory of the rows in blocks
+        qint64         budget   = 0;
+        QDateTime      cachedAt;       ///< time the rows were fetched if read from the cache
+        QScopedPointer<QTemporaryFile> spill;
+        mutable uchar *map    = Q_NULLPTR;
+        mutable qint64 mapped = 0;
+        mutable QList<QPair<int, QVector<Row> > > decoded; ///< most recently used spilled blocks first
+        QScopedPointer<QSqlQuery> query;  ///< open query of the rows not fetched yet
+        qint64         fetchUs = 0;    ///< time spent in reading the rows of the query
+        QString        fetchError;
+    };
+
+public:
+
+    explicit DbResultModel(QObject *parent = nullptr);
+    ~DbResultModel();
+
+    // Header:
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool setHeaderData(int section, Qt::Orientation orientation, const QVariant &value,
+                       int role = Qt::EditRole) override;
+
+    // Basic functionality:
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // Fetch data dynamically:
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    void clear();
+
+    /// rows are read from the executed forward-only query by fetchMore()
+    void setQuery(const QSqlQuery &query);
+
+    qint64 fetchUs() const {
+        return d.fetchUs;
+    }
+
+    /// error of the query while its rows were read
+    QString fetchError() const {
+        return d.fetchError;
+    }
+
+    QStringList fields() const {
+        return d.fields;
+    }
+
+    void setFields(const QStringList &fields);
+
+    Row row(int idx) const;
+
+    void appendRows(const QVector<Row> &rows);
+
+    /// bytes of rows kept in memory before blocks are spilled to disk
+    qint64 memoryBudget() const {
+        return d.budget;
+    }
+
+    void setMemoryBudget(qint64 bytes);
+
+    /// rows which are only in the spill file
+    int spilledRows() const {
+        return d.spilled * BlockRows;
+    }
+
+    QDateTime cachedAt() const {
+        return d.cachedAt;
+    }
+
+    void setCachedAt(const QDateTime &dt) {
+        d.cachedAt = dt;
+    }
+
+Q_SIGNALS:
+    /// rows read from the query and appended
+    void rowsFetched(const QVector<DbResultModel::Row> &rows);
+    /// the query is closed, complete if all of its rows were read
+    void fetchFinished(bool complete);
+
+private:
+    const QVector<Row> &blockRows(int idx) const;
+    void spillBlocks();
+    void closeSpill();
+    void closeQuery(bool complete);
+
+private: // static
+    static qint64 rowBytes(const Row &row);
+
+private:
+    DbResultModelPrivate d;
+};
+
+#endif // DBRESULTMODEL_H
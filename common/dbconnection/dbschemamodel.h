@@ -30,6 +30,11 @@ public:
 
     void setRecord(const QString &driver, const QSqlRecord &rec, const QSqlIndex &idx);
 
+    /// fields of the primary key in index order
+    QStringList indexFields() const {
+        return d.index;
+    }
+
 private:
     QVariant dataValue(int idx, int column) const;
 
@@ -0,0 +1,412 @@
+#include "dbtablediff.h"
+
+#include "dbdialect.h"
+#include "dbworker.h"
+
+#include <QtConcurrent>
+#include <QtEndian>
+#include <QCryptographicHash>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlRecord>
+#include <QSqlIndex>
+#include <QSqlQuery>
+#include <QSqlError>
+
+/******************************************************************/
+//! lexicographic (k1, k2, ...) >= bound or < bound, without row value syntax
+static QString keyPredicate(const QStringList &keys, const DbTableDiff::Row &bound, bool lower, QVariantList *binds)
+{
+    const QString strict = lower ? ">" : "<";
+    QString sql = QString("%1 %2 ?").arg(keys.last(), lower ? ">=" : "<");
+    QVariantList values;
+    values << bound.at(keys.size() - 1);
+    for (int i = keys.size() - 2; i >= 0; --i) {
+        sql = QString("(%1 %2 ? OR (%1 = ? AND %3))").arg(keys.at(i), strict, sql);
+        values.prepend(bound.at(i));
+        values.prepend(bound.at(i));
+    }
+    *binds << values;
+    return sql;
+}
+
+/******************************************************************/
+
+DbTableDiff::DbTableDiff(const QString &sourceConnection, const QString &sourceTable,
+                         const QString &targetConnection, const QString &targetTable)
+{
+    m_Source.connectionName = sourceConnection;
+    m_Source.table          = sourceTable;
+    m_Target.connectionName = targetConnection;
+    m_Target.table          = targetTable;
+    m_Pool.setMaxThreadCount(2);
+}
+
+/******************************************************************/
+
+DbTableDiffResult DbTableDiff::run(const QAtomicInt *canceled, QAtomicInteger<qint64> *progress)
+{
+    m_Canceled = canceled;
+    m_Progress = progress;
+    DbTableDiffResult result;
+
+    // both sides describe their table at the same time
+    QFuture<QString> source = QtConcurrent::run(&m_Pool, [this](){ return describe(&m_Source); });
+    QFuture<QString> target = QtConcurrent::run(&m_Pool, [this](){ return describe(&m_Target); });
+    const QString sourceError = source.result();
+    const QString targetError = target.result();
+    result.error = sourceError.isEmpty() ? targetError : sourceError;
+    if (!result.error.isEmpty()) return result;
+
+    if (m_Source.primaryKey.isEmpty()) {
+        result.error = tr("%1 has no primary key.").arg(m_Source.table);
+        return result;
+    }
+
+    // fields are matched by name without case, the keys come first
+    QVector<int> fields;
+    for (const auto &key : qAsConst(m_Source.primaryKey)) {
+        fields << m_Source.fields.indexOf(key);
+    }
+    for (int i = 0; i < m_Source.fields.size(); ++i) {
+        if (!fields.contains(i)) fields << i;
+    }
+    for (int i : qAsConst(fields)) {
+        int j = 0;
+        while (j < m_Target.fields.size() && m_Target.fields.at(j).compare(m_Source.fields.at(i), Qt::CaseInsensitive)) ++j;
+        if (j == m_Target.fields.size()) {
+            if (result.fields.size() < m_Source.primaryKey.size()) {
+                result.error = tr("Key field %1 is missing in %2.").arg(m_Source.fields.at(i), m_Target.table);
+                return result;
+            }
+            continue;
+        }
+        result.fields << m_Source.fields.at(i);
+        m_Source.columns << m_Source.escaped.at(i);
+        m_Target.columns << m_Target.escaped.at(j);
+    }
+    result.keyCount = m_Source.keyCount = m_Target.keyCount = m_Source.primaryKey.size();
+
+    // server checksums are only comparable within a dialect
+    if (Db::dialect(m_Source.driverName) == Db::dialect(m_Target.driverName)) {
+        m_Source.hashSql = Db::rangeHashSql(m_Source.driverName, m_Source.columns);
+        m_Target.hashSql = Db::rangeHashSql(m_Target.driverName, m_Target.columns);
+    }
+    result.serverHash = !m_Source.hashSql.isEmpty();
+
+    result.error = sampleBounds(m_Source, &m_Bounds, &result.sourceRows, canceled);
+    if (!result.error.isEmpty()) return result;
+
+    const int leaves = m_Bounds.size() + 1;
+    QVector<Range> chunks;
+    for (int first = 0; first < leaves; first += ChunkLeaves) {
+        chunks << Range{first, qMin(first + ChunkLeaves, leaves)};
+    }
+    result.chunks = chunks.size();
+
+    QVector<Range> mismatched;
+    if (!hashRanges(chunks, &mismatched, &result.error)) return result;
+
+    // only the leaves of mismatching chunks are checksummed again
+    QVector<Range> leafRanges;
+    QVector<Range> mismatchedLeaves;
+    for (const auto &chunk : qAsConst(mismatched)) {
+        if (chunk.last - chunk.first == 1) {
+            mismatchedLeaves << chunk;
+            continue;
+        }
+        for (int leaf = chunk.first; leaf < chunk.last; ++leaf) {
+            leafRanges << Range{leaf, leaf + 1};
+        }
+    }
+    if (!leafRanges.isEmpty() && !hashRanges(leafRanges, &mismatchedLeaves, &result.error)) return result;
+
+    result.mismatched = mismatchedLeaves.size();
+    compareLeaves(mismatchedLeaves, &result, &result.error);
+    if (canceled && canceled->loadRelaxed()) result.partial = true;
+    return result;
+}
+
+/******************************************************************/
+
+bool DbTableDiff::hashRanges(const QVector<Range> &ranges, QVector<Range> *mismatched, QString *err)
+{
+    QVector<Checksum> sourceSums;
+    QVector<Checksum> targetSums;
+    QFuture<QString> source = QtConcurrent::run(&m_Pool, [&](){
+        return checksums(m_Source, m_Bounds, ranges, &sourceSums, m_Canceled, m_Progress);
+    });
+    QFuture<QString> target = QtConcurrent::run(&m_Pool, [&](){
+        return checksums(m_Target, m_Bounds, ranges, &targetSums, m_Canceled, Q_NULLPTR);
+    });
+    // both sides write into the locals, so both are awaited
+    const QString sourceError = source.result();
+    const QString targetError = target.result();
+    *err = sourceError.isEmpty() ? targetError : sourceError;
+    if (!err->isEmpty()) return false;
+
+    // a canceled side returns fewer sums
+    const int count = qMin(sourceSums.size(), targetSums.size());
+    for (int i = 0; i < count; ++i) {
+        if (!(sourceSums.at(i) == targetSums.at(i))) *mismatched << ranges.at(i);
+    }
+    return true;
+}
+
+/******************************************************************/
+
+bool DbTableDiff::compareLeaves(const QVector<Range> &leaves, DbTableDiffResult *result, QString *err)
+{
+    // one leaf at a time, the rows behind MaxDiffRows differences are not fetched
+    for (const auto &leaf : leaves) {
+        if (m_Canceled && m_Canceled->loadRelaxed()) return true;
+
+        const QVector<Range> ranges(1, leaf);
+        QVector<Row> sourceRows;
+        QVector<Row> targetRows;
+        QFuture<QString> source = QtConcurrent::run(&m_Pool, [&](){
+            return fetchRows(m_Source, m_Bounds, ranges, &sourceRows, m_Canceled);
+        });
+        QFuture<QString> target = QtConcurrent::run(&m_Pool, [&](){
+            return fetchRows(m_Target, m_Bounds, ranges, &targetRows, m_Canceled);
+        });
+        // both sides write into the locals, so both are awaited
+        const QString sourceError = source.result();
+        const QString targetError = target.result();
+        *err = sourceError.isEmpty() ? targetError : sourceError;
+        if (!err->isEmpty()) return false;
+
+        if (!compareRows(sourceRows, targetRows, result)) {
+            result->partial = true;
+            return true;
+        }
+    }
+    return true;
+}
+
+/******************************************************************/
+//! rows are matched by the text of their keys, the servers may sort differently
+bool DbTableDiff::compareRows(const QVector<Row> &sourceRows, const QVector<Row> &targetRows,
+                              DbTableDiffResult *result)
+{
+    const int keyCount = result->keyCount;
+    QHash<QString, int> targetOfKey;
+    targetOfKey.reserve(targetRows.size());
+    for (int i = 0; i < targetRows.size(); ++i) {
+        targetOfKey.insert(keyText(targetRows.at(i), keyCount), i);
+    }
+
+    QBitArray matched(targetRows.size());
+    for (const auto &row : sourceRows) {
+        const int i = targetOfKey.value(keyText(row, keyCount), -1);
+        DbRowDiff diff;
+        diff.source = row;
+        if (i < 0) {
+            diff.kind = DbRowDiff::Missing;
+        } else {
+            matched.setBit(i);
+            const Row &other = targetRows.at(i);
+            diff.changed.resize(row.size());
+            for (int c = keyCount; c < row.size(); ++c) {
+                if (valueText(row.at(c)) != valueText(other.at(c))) diff.changed.setBit(c);
+            }
+            if (diff.changed.count(true) == 0) continue;
+            diff.target = other;
+        }
+        if (result->rows.size() == MaxDiffRows) return false;
+        result->rows << diff;
+    }
+
+    for (int i = 0; i < targetRows.size(); ++i) {
+        if (matched.testBit(i)) continue;
+        if (result->rows.size() == MaxDiffRows) return false;
+        DbRowDiff diff;
+        diff.kind = DbRowDiff::Extra;
+        diff.target = targetRows.at(i);
+        result->rows << diff;
+    }
+    return true;
+}
+
+/******************************************************************/
+
+QString DbTableDiff::describe(Side *side)
+{
+    return Db::withClone(side->connectionName, "diff", [side](QSqlDatabase &db) -> QString {
+        const QSqlRecord record = db.record(side->table);
+        if (record.isEmpty()) {
+            return tr("Table %1 not found.").arg(side->table);
+        }
+        const QSqlDriver *driver = db.driver();
+        side->driverName = db.driverName();
+        side->from = Db::escapedName(driver, side->table, QSqlDriver::TableName);
+        for (int i = 0; i < record.count(); ++i) {
+            side->fields << record.fieldName(i);
+            side->escaped << Db::escapedName(driver, record.fieldName(i), QSqlDriver::FieldName);
+        }
+        const QSqlIndex primaryKey = db.primaryIndex(side->table);
+        for (int i = 0; i < primaryKey.count(); ++i) {
+            side->primaryKey << primaryKey.fieldName(i);
+        }
+        return QString();
+    });
+}
+
+/******************************************************************/
+//! keeps the key of every LeafRows-th row, the keys are streamed in order
+QString DbTableDiff::sampleBounds(const Side &side, QVector<Row> *bounds, qint64 *rows, const QAtomicInt *canceled)
+{
+    return Db::withClone(side.connectionName, "diff", [&](QSqlDatabase &db) -> QString {
+        const QString keys = side.columns.mid(0, side.keyCount).join(", ");
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        if (!query.exec(QString("SELECT %1 FROM %2 ORDER BY %1").arg(keys, side.from))) {
+            return query.lastError().text();
+        }
+        qint64 count = 0;
+        while (query.next()) {
+            if (count && count % LeafRows == 0) {
+                if (canceled && canceled->loadRelaxed()) break;
+                Row bound(side.keyCount);
+                for (int c = 0; c < bound.size(); ++c) {
+                    bound[c] = query.value(c);
+                }
+                *bounds << bound;
+            }
+            ++count;
+        }
+        *rows = count;
+        const QString err = query.lastError().isValid() ? query.lastError().text() : QString();
+        query.finish();
+        return err;
+    });
+}
+
+/******************************************************************/
+
+QString DbTableDiff::checksums(const Side &side, const QVector<Row> &bounds, const QVector<Range> &ranges,
+                               QVector<Checksum> *sums, const QAtomicInt *canceled, QAtomicInteger<qint64> *progress)
+{
+    return Db::withClone(side.connectionName, "diff", [&](QSqlDatabase &db) -> QString {
+        const bool server = !side.hashSql.isEmpty();
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        for (const auto &range : ranges) {
+            if (canceled && canceled->loadRelaxed()) break;
+
+            QVariantList binds;
+            query.prepare(rangeSql(side, server ? side.hashSql : side.columns.join(", "), bounds, range, &binds));
+            for (const auto &value : qAsConst(binds)) {
+                query.addBindValue(value);
+            }
+            if (!query.exec()) {
+                return query.lastError().text();
+            }
+
+            Checksum sum;
+            if (server) {
+                if (query.next()) {
+                    sum.count = query.value(0).toLongLong();
+                    sum.hash  = query.value(1).toString();
+                }
+            } else {
+                // the sum of the row hashes does not depend on the order of the rows
+                quint64 total = 0;
+                const int columns = side.columns.size();
+                while (query.next()) {
+                    QStringList texts;
+                    for (int c = 0; c < columns; ++c) {
+                        texts << valueText(query.value(c));
+                    }
+                    const QByteArray hash = QCryptographicHash::hash(texts.join(QChar(0x1f)).toUtf8(),
+                                                                     QCryptographicHash::Md5);
+                    total += qFromBigEndian<quint64>(hash.constData());
+                    ++sum.count;
+                }
+                sum.hash = QString::number(total);
+            }
+            query.finish();
+            *sums << sum;
+            if (progress) progress->fetchAndAddRelaxed(1);
+        }
+        return QString();
+    });
+}
+
+/******************************************************************/
+
+QString DbTableDiff::fetchRows(const Side &side, const QVector<Row> &bounds, const QVector<Range> &ranges,
+                               QVector<Row> *rows, const QAtomicInt *canceled)
+{
+    return Db::withClone(side.connectionName, "diff", [&](QSqlDatabase &db) -> QString {
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        for (const auto &range : ranges) {
+            if (canceled && canceled->loadRelaxed()) break;
+
+            QVariantList binds;
+            query.prepare(rangeSql(side, side.columns.join(", "), bounds, range, &binds));
+            for (const auto &value : qAsConst(binds)) {
+                query.addBindValue(value);
+            }
+            if (!query.exec()) {
+                return query.lastError().text();
+            }
+            while (query.next()) {
+                Row row(side.columns.size());
+                for (int c = 0; c < row.size(); ++c) {
+                    row[c] = query.value(c);
+                }
+                *rows << row;
+            }
+            query.finish();
+        }
+        return QString();
+    });
+}
+
+/******************************************************************/
+
+QString DbTableDiff::rangeSql(const Side &side, const QString &select, const QVector<Row> &bounds, const Range &range,
+                              QVariantList *binds)
+{
+    const QStringList keys = side.columns.mid(0, side.keyCount);
+    QStringList where;
+    if (range.first > 0) {
+        where << keyPredicate(keys, bounds.at(range.first - 1), true, binds);
+    }
+    if (range.last <= bounds.size()) {
+        where << keyPredicate(keys, bounds.at(range.last - 1), false, binds);
+    }
+    QString sql = QString("SELECT %1 FROM %2").arg(select, side.from);
+    if (!where.isEmpty()) {
+        sql += " WHERE " + where.join(" AND ");
+    }
+    return sql;
+}
+
+/******************************************************************/
+
+QString DbTableDiff::keyText(const Row &row, int keyCount)
+{
+    QStringList texts;
+    for (int c = 0; c < keyCount; ++c) {
+        texts << valueText(row.at(c));
+    }
+    return texts.join(QChar(0x1f));
+}
+
+/******************************************************************/
+//! values of different drivers are compared by their text
+QString DbTableDiff::valueText(const QVariant &value)
+{
+    if (value.isNull()) {
+        return QStringLiteral("\\N");
+    }
+    if (value.type() == QVariant::ByteArray) {
+        return QString::fromLatin1(value.toByteArray().toHex());
+    }
+    return value.toString();
+}
+
+/******************************************************************/
@@ -0,0 +1,130 @@
+#ifndef DBTABLEDIFF_H
+#define DBTABLEDIFF_H
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QThreadPool>
+#include <QBitArray>
+#include <QVariant>
+#include <QVector>
+#include <QAtomicInt>
+
+/******************************************************************/
+
+struct DbRowDiff
+{
+    enum Kind {
+        Missing,  ///< only in the source
+        Extra,    ///< only in the target
+        Changed
+    };
+
+    Kind kind = Changed;
+    QVector<QVariant> source;  ///< compared columns, empty for Extra
+    QVector<QVariant> target;  ///< compared columns, empty for Missing
+    QBitArray changed;         ///< differing columns of a Changed row
+};
+
+/******************************************************************/
+
+struct DbTableDiffResult
+{
+    QStringList fields;        ///< compared source fields, the key fields first
+    int     keyCount   = 0;
+    qint64  sourceRows = 0;
+    int     chunks     = 0;    ///< ranges of the first pass
+    int     mismatched = 0;    ///< leaf ranges whose rows were fetched
+    bool    serverHash = false;
+    QVector<DbRowDiff> rows;
+    bool    partial    = false; ///< canceled or more than MaxDiffRows differences
+    QString error;
+};
+
+/******************************************************************/
+/**
+ * @brief Row level comparison of a table on two connections
+ *
+ * The source keys are streamed once to cut the table into leaf ranges of
+ * LeafRows rows. Both sides then checksum chunks of ChunkLeaves leaves in
+ * parallel, each on its own clone of its connection; only the leaves of
+ * mismatching chunks are checksummed again and only the rows of
+ * mismatching leaves are fetched and compared, leaf by leaf until
+ * MaxDiffRows differences are found. Checksums are computed by
+ * the servers if both have the same dialect with a hash function,
+ * otherwise the rows are hashed while they are streamed.
+ */
+class DbTableDiff
+{
+    Q_DECLARE_TR_FUNCTIONS(DbTableDiff)
+
+public:
+    typedef QVector<QVariant> Row;
+
+    enum {
+        LeafRows    = 1000,
+        ChunkLeaves = 64,
+        MaxDiffRows = 10000
+    };
+
+    DbTableDiff(const QString &sourceConnection, const QString &sourceTable,
+                const QString &targetConnection, const QString &targetTable);
+
+    /// runs in the calling (worker) thread, progress counts the checksummed ranges
+    DbTableDiffResult run(const QAtomicInt *canceled, QAtomicInteger<qint64> *progress);
+
+private:
+    struct Side {
+        QString     connectionName;
+        QString     driverName;
+        QString     table;
+        QString     from;        ///< escaped table
+        QStringList fields;
+        QStringList escaped;     ///< escaped fields
+        QStringList primaryKey;
+        QStringList columns;     ///< escaped compared fields, the keys first
+        int         keyCount = 0;
+        QString     hashSql;     ///< empty hashes on the client
+    };
+
+    struct Range {
+        int first;               ///< leaf
+        int last;                ///< leaf after the range
+    };
+
+    struct Checksum {
+        qint64  count = 0;
+        QString hash;
+
+        bool operator==(const Checksum &other) const {
+            return count == other.count && hash == other.hash;
+        }
+    };
+
+    bool hashRanges(const QVector<Range> &ranges, QVector<Range> *mismatched, QString *err);
+    bool compareLeaves(const QVector<Range> &leaves, DbTableDiffResult *result, QString *err);
+
+private: // static
+    /// false if the differences reached MaxDiffRows
+    static bool compareRows(const QVector<Row> &sourceRows, const QVector<Row> &targetRows,
+                            DbTableDiffResult *result);
+    static QString describe(Side *side);
+    static QString sampleBounds(const Side &side, QVector<Row> *bounds, qint64 *rows, const QAtomicInt *canceled);
+    static QString checksums(const Side &side, const QVector<Row> &bounds, const QVector<Range> &ranges,
+                             QVector<Checksum> *sums, const QAtomicInt *canceled, QAtomicInteger<qint64> *progress);
+    static QString fetchRows(const Side &side, const QVector<Row> &bounds, const QVector<Range> &ranges,
+                             QVector<Row> *rows, const QAtomicInt *canceled);
+    static QString rangeSql(const Side &side, const QString &select, const QVector<Row> &bounds, const Range &range,
+                            QVariantList *binds);
+    static QString keyText(const Row &row, int keyCount);
+    static QString valueText(const QVariant &value);
+
+private:
+    Side m_Source;
+    Side m_Target;
+    QVector<Row> m_Bounds;       ///< first key of every leaf but the first
+    const QAtomicInt *m_Canceled = Q_NULLPTR;
+    QAtomicInteger<qint64> *m_Progress = Q_NULLPTR;
+    QThreadPool m_Pool;          ///< one thread per side
+};
+
+#endif // DBTABLEDIFF_H
@@ -0,0 +1,457 @@
+#include "dbtablemodel.h"
+
+#include "dbdialect.h"
+
+#include <QSettings>
+
+#include <QSqlField>
+#include <QSqlIndex>
+#include <QSqlError>
+
+/******************************************************************/
+
+DbTableModel::DbTableModel(QObject *parent, QSqlDatabase db)
+    : QSqlTableModel(parent, db)
+{
+    m_LazyEnabled = lazyDefault();
+    m_FailedRow = -1;
+}
+
+/******************************************************************/
+
+void DbTableModel::setTable(const QString &tableName)
+{
+    QSqlTableModel::setTable(tableName);
+
+    m_Lazy.clear();
+    m_TableRecord = database().record(tableName);
+
+    // truncated values can only be read again by primary key
+    const QSqlIndex pk = primaryKey();
+    if (pk.isEmpty()) return;
+    if (Db::previewSql(database().driverName(), "x", false, PreviewChars).isEmpty()) return;
+
+    for (int i = 0; i < m_TableRecord.count(); ++i) {
+        const QSqlField field = m_TableRecord.field(i);
+        if (pk.contains(field.name())) continue;
+        if (field.type() == QVariant::ByteArray
+                || (field.type() == QVariant::String && (field.length() <= 0 || field.length() > LargeLength))) {
+            m_Lazy.insert(i);
+        }
+    }
+}
+
+/******************************************************************/
+
+Qt::ItemFlags DbTableModel::flags(const QModelIndex &index) const
+{
+    Qt::ItemFlags result = QSqlTableModel::flags(index);
+    if (isTruncated(index)) {
+        result &= ~Qt::ItemIsEditable;
+    }
+    return result;
+}
+
+/******************************************************************/
+
+void DbTableModel::setLazyEnabled(bool enabled)
+{
+    m_LazyEnabled = enabled;
+    setLazyDefault(enabled);
+}
+
+/******************************************************************/
+
+bool DbTableModel::lazyDefault()
+{
+    const DbTableModelSettings S;
+    QSettings settings;
+    return settings.value(S.LAZY, false).toBool();
+}
+
+/******************************************************************/
+
+void DbTableModel::setLazyDefault(bool enabled)
+{
+    const DbTableModelSettings S;
+    QSettings settings;
+    settings.setValue(S.LAZY, enabled);
+}
+
+/******************************************************************/
+
+bool DbTableModel::isTruncated(const QModelIndex &index) const
+{
+    if (!index.isValid() || !isLazy(index.column()) || isDirty(index)) return false;
+
+    const QVariant value = QSqlTableModel::data(index, Qt::EditRole);
+    if (value.isNull()) return false;
+    if (m_TableRecord.field(index.column()).type() == QVariant::ByteArray) return true;
+    return value.toString().size() > PreviewChars;
+}
+
+/******************************************************************/
+
+QVariant DbTableModel::fetchValue(const QModelIndex &index, QString *err) const
+{
+    if (!isTruncated(index)) {
+        return data(index, Qt::EditRole);
+    }
+
+    const QSqlDriver *driver = database().driver();
+    const QSqlRecord key = primaryValues(index.row());
+    QStringList where;
+    for (int i = 0; i < key.count(); ++i) {
+        where << QString("%1 = ?").arg(Db::escapedName(driver, key.fieldName(i), QSqlDriver::FieldName));
+    }
+
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT %1 FROM %2 WHERE %3")
+                  .arg(Db::escapedName(driver, m_TableRecord.fieldName(index.column()), QSqlDriver::FieldName),
+                       Db::escapedName(driver, tableName(), QSqlDriver::TableName),
+                       where.join(" AND ")));
+    for (int i = 0; i < key.count(); ++i) {
+        query.addBindValue(key.value(i));
+    }
+    if (!query.exec()) {
+        if (err) *err = query.lastError().text();
+        return QVariant();
+    }
+    if (!query.next()) {
+        if (err) *err = tr("The row does not exist any more.");
+        return QVariant();
+    }
+    return query.value(0);
+}
+
+/******************************************************************/
+
+int DbTableModel::submitBatchSize()
+{
+    const DbTableModelSettings S;
+    QSettings settings;
+    return qMax(1, settings.value(S.BATCH, int(BatchRows)).toInt());
+}
+
+/******************************************************************/
+
+bool DbTableModel::submitBatched(int batchSize, QString *err)
+{
+    m_FailedRow = -1;
+    if (primaryKey().isEmpty()) {
+        // rows without a key are matched by all their values
+        if (submitAll()) return true;
+        if (err) *err = lastError().text();
+        return false;
+    }
+
+    const QVector<PendingBatch> batches = pendingBatches(qMax(1, batchSize));
+    int total = 0;
+    for (const auto &batch : batches) {
+        total += batch.rows.size();
+    }
+
+    QSqlDatabase db = database();
+    const bool useTransactions = db.driver()->hasFeature(QSqlDriver::Transactions);
+    if (useTransactions && !db.transaction()) {
+        if (err) *err = db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    int done = 0;
+    for (int i = 0; i < batches.size(); ++i) {
+        if (!execBatch(query, batches.at(i))) {
+            if (err) *err = query.lastError().text();
+            if (useTransactions) {
+                db.rollback();
+                m_FailedRow = locateFailure(batches, i);
+            } else {
+                m_FailedRow = batches.at(i).rows.first();
+            }
+            return false;
+        }
+        done += batches.at(i).rows.size();
+        emit submitProgress(done, total);
+    }
+
+    if (useTransactions && !db.commit()) {
+        if (err) *err = db.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    // like submitAll(), the committed rows are read again
+    if (!select()) {
+        if (err) *err = lastError().text();
+        return false;
+    }
+    return true;
+}
+
+/******************************************************************/
+
+DbTableFilter DbTableModel::compileFilter(const QStringList &texts) const
+{
+    static const QStringList operators = QStringList() << ">=" << "<=" << "<>" << "!=" << "=" << ">" << "<";
+
+    DbTableFilter result;
+    const QSqlDriver *driver = database().driver();
+    QStringList conditions;
+    for (int c = 0; c < texts.size() && c < m_TableRecord.count(); ++c) {
+        const QString text = texts.at(c).trimmed();
+        if (text.isEmpty()) continue;
+
+        const QSqlField field = m_TableRecord.field(c);
+        const QString name = Db::escapedName(driver, field.name(), QSqlDriver::FieldName);
+        if (text.compare("NULL", Qt::CaseInsensitive) == 0) {
+            conditions << QString("%1 IS NULL").arg(name);
+            continue;
+        }
+        if (text.compare("!NULL", Qt::CaseInsensitive) == 0) {
+            conditions << QString("%1 IS NOT NULL").arg(name);
+            continue;
+        }
+
+        QString op;
+        QString value = text;
+        for (const auto &candidate : operators) {
+            if (text.startsWith(candidate)) {
+                op = candidate == "!=" ? QString("<>") : candidate;
+                value = text.mid(candidate.size()).trimmed();
+                break;
+            }
+        }
+
+        const bool isText = field.type() == QVariant::String;
+        if (op.isEmpty() && (isText || value.contains('*') || value.contains('%'))) {
+            if (!isText) {
+                result.invalidColumn = c;
+                result.error = tr("Patterns need a text column.");
+                return result;
+            }
+            QString pattern = QString(value).replace('*', '%');
+            if (!pattern.contains('%')) {
+                pattern = '%' + pattern + '%';
+            }
+            QSqlField literal(field.name(), QVariant::String);
+            literal.setValue(pattern);
+            conditions << QString("%1 LIKE %2").arg(name, driver->formatValue(literal));
+            // only a fixed prefix can seek in an index
+            if (!pattern.startsWith('%')) {
+                result.seekFields << field.name();
+            }
+            continue;
+        }
+
+        QVariant typed(value);
+        if (!isText && !typed.convert(int(field.type()))) {
+            result.invalidColumn = c;
+            result.error = tr("%1 is not a valid value of %2.").arg(value, field.name());
+            return result;
+        }
+        QSqlField literal(field.name(), field.type());
+        literal.setValue(typed);
+        conditions << QString("%1 %2 %3").arg(name, op.isEmpty() ? QString("=") : op, driver->formatValue(literal));
+        if (op != "<>") {
+            result.seekFields << field.name();
+        }
+    }
+
+    result.sql = conditions.join(" AND ");
+    return result;
+}
+
+/******************************************************************/
+
+QString DbTableModel::selectStatement() const
+{
+    if (!hasLazyColumns()) {
+        return QSqlTableModel::selectStatement();
+    }
+
+    const QSqlDriver *driver = database().driver();
+    const QString driverName = database().driverName();
+    QStringList fields;
+    for (int i = 0; i < m_TableRecord.count(); ++i) {
+        const QString name = Db::escapedName(driver, m_TableRecord.fieldName(i), QSqlDriver::FieldName);
+        if (m_Lazy.contains(i)) {
+            const bool binary = m_TableRecord.field(i).type() == QVariant::ByteArray;
+            fields << QString("%1 AS %2").arg(Db::previewSql(driverName, name, binary, PreviewChars), name);
+        } else {
+            fields << name;
+        }
+    }
+
+    QString stmt = QString("SELECT %1 FROM %2")
+            .arg(fields.join(", "), Db::escapedName(driver, tableName(), QSqlDriver::TableName));
+    if (!filter().isEmpty()) {
+        stmt += " WHERE " + filter();
+    }
+    const QString orderBy = orderByClause();
+    if (!orderBy.isEmpty()) {
+        stmt += ' ' + orderBy;
+    }
+    return stmt;
+}
+
+/******************************************************************/
+
+QVector<DbTableModel::PendingBatch> DbTableModel::pendingBatches(int batchSize) const
+{
+    const QSqlDriver *driver = database().driver();
+    const QString table = Db::escapedName(driver, tableName(), QSqlDriver::TableName);
+    const QSqlIndex pk = primaryKey();
+    QStringList keyNames, where;
+    for (int i = 0; i < pk.count(); ++i) {
+        keyNames << Db::escapedName(driver, pk.fieldName(i), QSqlDriver::FieldName);
+        where << QString("%1 = ?").arg(keyNames.last());
+    }
+    const QString whereSql = where.join(" AND ");
+
+    QVector<PendingBatch> updates, inserts;
+    QVector<int> deleted;
+    QVector<QVariantList> deletedKeys;
+    QHash<QString, int> open; // statement -> batch being filled
+    auto add = [&open, batchSize](QVector<PendingBatch> &list, const QString &sql, int row, const QVariantList &values) {
+        auto it = open.find(sql);
+        if (it == open.end() || list.at(it.value()).rows.size() >= batchSize) {
+            PendingBatch batch;
+            batch.sql = sql;
+            batch.values.resize(values.size());
+            list << batch;
+            it = open.insert(sql, list.size() - 1);
+        }
+        PendingBatch &batch = list[it.value()];
+        batch.rows << row;
+        for (int i = 0; i < values.size(); ++i) {
+            batch.values[i] << values.at(i);
+        }
+    };
+    auto keyValues = [this](int row) {
+        const QSqlRecord key = primaryValues(row);
+        QVariantList values;
+        for (int i = 0; i < key.count(); ++i) {
+            values << key.value(i);
+        }
+        return values;
+    };
+
+    const int rows = rowCount();
+    const int columns = columnCount();
+    for (int row = 0; row < rows; ++row) {
+        // the vertical header tells inserted and deleted rows
+        const QString op = QSqlTableModel::headerData(row, Qt::Vertical, Qt::DisplayRole).toString();
+        if (op == QLatin1String("!")) {
+            deleted << row;
+            deletedKeys << keyValues(row);
+            continue;
+        }
+
+        const bool inserted = op == QLatin1String("*");
+        bool dirty = inserted;
+        for (int c = 0; !dirty && c < columns; ++c) {
+            dirty = isDirty(index(row, c));
+        }
+        if (!dirty) continue;
+
+        // only edited fields are generated
+        const QSqlRecord rec = record(row);
+        QStringList fields;
+        QVariantList values;
+        for (int c = 0; c < rec.count(); ++c) {
+            if (!rec.isGenerated(c)) continue;
+            fields << Db::escapedName(driver, rec.fieldName(c), QSqlDriver::FieldName);
+            values << rec.value(c);
+        }
+        if (fields.isEmpty()) continue;
+
+        if (inserted) {
+            QStringList marks;
+            for (int i = 0; i < fields.size(); ++i) {
+                marks << "?";
+            }
+            add(inserts, QString("INSERT INTO %1 (%2) VALUES (%3)").arg(table, fields.join(", "), marks.join(", ")),
+                row, values);
+        } else {
+            add(updates, QString("UPDATE %1 SET %2 = ? WHERE %3").arg(table, fields.join(" = ?, "), whereSql),
+                row, values + keyValues(row));
+        }
+    }
+
+    // deleted rows go first, so that updated and inserted rows may reuse their keys
+    QVector<PendingBatch> deletes;
+    const int keys = pk.count();
+    const int chunk = qMax(1, qMin(batchSize, Db::SetParams / keys));
+    for (int first = 0; first < deleted.size(); first += chunk) {
+        const int count = qMin(chunk, deleted.size() - first);
+        PendingBatch batch;
+        batch.sql = QString("DELETE FROM %1 WHERE %2").arg(table, Db::keySetSql(keyNames, count));
+        batch.rowSql = QString("DELETE FROM %1 WHERE %2").arg(table, whereSql);
+        batch.values.resize(keys);
+        for (int r = first; r < first + count; ++r) {
+            batch.rows << deleted.at(r);
+            for (int k = 0; k < keys; ++k) {
+                batch.values[k] << deletedKeys.at(r).at(k);
+            }
+        }
+        deletes << batch;
+    }
+
+    return deletes + updates + inserts;
+}
+
+/******************************************************************/
+//! execBatch() does not tell the failed row, so the batch is repeated row by row in a transaction which is rolled back
+int DbTableModel::locateFailure(const QVector<PendingBatch> &batches, int failed) const
+{
+    const PendingBatch &batch = batches.at(failed);
+    int row = batch.rows.first();
+    if (batch.rows.size() == 1) return row;
+
+    QSqlDatabase db = database();
+    if (!db.transaction()) return row;
+
+    QSqlQuery query(db);
+    bool replayed = true;
+    for (int i = 0; i < failed && replayed; ++i) {
+        replayed = execBatch(query, batches.at(i));
+    }
+    if (replayed && query.prepare(batch.rowSql.isEmpty() ? batch.sql : batch.rowSql)) {
+        for (int r = 0; r < batch.rows.size(); ++r) {
+            for (int v = 0; v < batch.values.size(); ++v) {
+                query.bindValue(v, batch.values.at(v).at(r));
+            }
+            if (!query.exec()) {
+                row = batch.rows.at(r);
+                break;
+            }
+        }
+    }
+
+    db.rollback();
+    return row;
+}
+
+/******************************************************************/
+
+bool DbTableModel::execBatch(QSqlQuery &query, const PendingBatch &batch)
+{
+    if (!query.prepare(batch.sql)) return false;
+    if (!batch.rowSql.isEmpty()) {
+        // one statement with the values of all rows
+        for (int r = 0; r < batch.rows.size(); ++r) {
+            for (const auto &values : batch.values) {
+                query.addBindValue(values.at(r));
+            }
+        }
+        return query.exec();
+    }
+    for (const auto &values : batch.values) {
+        query.addBindValue(values);
+    }
+    return query.execBatch();
+}
+
+/******************************************************************/
@@ -0,0 +1,139 @@
+#ifndef DBTABLEMODEL_H
+#define DBTABLEMODEL_H
+
+#include <QSqlTableModel>
+#include <QSqlRecord>
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QSet>
+#include <QVector>
+
+/******************************************************************/
+
+struct DbTableFilter
+{
+    QString     sql;            ///< condition for setFilter()
+    QStringList seekFields;     ///< fields compared by equality, range or prefix
+    int         invalidColumn = -1;
+    QString     error;
+};
+
+/******************************************************************/
+/**
+ * @brief Editable table model which can leave large values on the server
+ *
+ * With lazy large values enabled, binary columns and text columns without
+ * a small declared length are selected as a short preview with the length
+ * of the value (see Db::previewSql). Truncated cells are read-only, the
+ * full value is fetched by primary key with fetchValue(). Tables without
+ * a primary key are always selected completely.
+ *
+ * submitBatched() writes the pending changes as prepared batches inside
+ * one transaction instead of one auto-committed statement per row;
+ * deleted rows are removed by sets of primary keys.
+ */
+class DbTableModel : public QSqlTableModel
+{
+    Q_OBJECT
+
+    struct DbTableModelSettings {
+        const QString LAZY  = "datatable/lazylargevalues";
+        const QString BATCH = "datatable/submitbatch";
+    };
+
+    struct PendingBatch {
+        QString              sql;
+        QString              rowSql; ///< statement for one row, if sql covers all rows at once
+        QVector<int>         rows;
+        QVector<QVariantList> values; ///< bind values by placeholder of rowSql or sql
+    };
+
+public:
+    enum {
+        PreviewChars = 256,
+        LargeLength  = 4000,  ///< declared text length from which a column is lazy
+        BatchRows    = 500    ///< default rows of a submit batch
+    };
+
+    explicit DbTableModel(QObject *parent = nullptr, QSqlDatabase db = QSqlDatabase());
+
+    void setTable(const QString &tableName) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    bool isLazyEnabled() const {
+        return m_LazyEnabled;
+    }
+
+    /// takes effect with the next select(), the choice is kept for new models
+    void setLazyEnabled(bool enabled);
+
+    static bool lazyDefault();
+    static void setLazyDefault(bool enabled);
+
+    bool hasLazyColumns() const {
+        return m_LazyEnabled && !m_Lazy.isEmpty();
+    }
+
+    bool isLazy(int column) const {
+        return m_LazyEnabled && m_Lazy.contains(column);
+    }
+
+    /// the cell shows a preview instead of the value
+    bool isTruncated(const QModelIndex &index) const;
+
+    /// the complete value of the cell, read from the server if it is truncated
+    QVariant fetchValue(const QModelIndex &index, QString *err = Q_NULLPTR) const;
+
+    /// rows of a submit batch, read from the settings
+    static int submitBatchSize();
+
+    /**
+     * @brief Writes all pending changes in one transaction
+     *
+     * Deleted, updated and inserted rows are grouped by their changed
+     * columns and executed as prepared batches of batchSize rows. On the
+     * first error everything is rolled back, failedRow() tells the row and
+     * the changes stay pending. Tables without a primary key use submitAll().
+     */
+    bool submitBatched(int batchSize, QString *err = Q_NULLPTR);
+
+    /// the row which failed in the last submitBatched(), or -1
+    int failedRow() const {
+        return m_FailedRow;
+    }
+
+    /**
+     * @brief Condition of filter texts by column
+     *
+     * A text is a comparison (=, <>, !=, <, <=, >, >= value), NULL or
+     * !NULL, a pattern with * or %, or else a substring of a text column
+     * and the value of other columns. Values are converted to the field
+     * type and written as literals by the driver.
+     */
+    DbTableFilter compileFilter(const QStringList &texts) const;
+
+    /// select of all columns with the current filter and sort order
+    QString fullSelectStatement() const {
+        return QSqlTableModel::selectStatement();
+    }
+
+signals:
+    void submitProgress(int done, int total);
+
+protected:
+    QString selectStatement() const override;
+
+private:
+    QVector<PendingBatch> pendingBatches(int batchSize) const;
+    int locateFailure(const QVector<PendingBatch> &batches, int failed) const;
+
+    static bool execBatch(QSqlQuery &query, const PendingBatch &batch);
+
+private:
+    bool       m_LazyEnabled;
+    QSqlRecord m_TableRecord; ///< field types as declared in the table
+    QSet<int>  m_Lazy;
+    int        m_FailedRow;
+};
+
+#endif // DBTABLEMODEL_H
@@ -0,0 +1,274 @@
+#include "dbtailmodel.h"
+
+#include "dbdialect.h"
+
+#include <QSettings>
+
+#include <QSqlQuery>
+#include <QSqlIndex>
+#include <QSqlField>
+#include <QSqlError>
+
+#include <algorithm>
+
+/******************************************************************/
+
+DbTailModel::DbTailModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+    const DbTailModelSettings S;
+    QSettings settings;
+    d.ring.resize(qMax(1, settings.value(S.ROWS, int(TailRows)).toInt()));
+    d.timer.setInterval(qMax(100, settings.value(S.INTERVAL, int(IntervalMs)).toInt()));
+
+    connect(&d.timer, &QTimer::timeout,
+            this, &DbTailModel::fetchNew);
+}
+
+/******************************************************************/
+
+DbTailModel::~DbTailModel()
+{
+    stop();
+}
+
+/******************************************************************/
+
+QVariant DbTailModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return d.record.fieldName(section);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+/******************************************************************/
+
+int DbTailModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return d.count;
+}
+
+/******************************************************************/
+
+int DbTailModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return d.record.count();
+}
+
+/******************************************************************/
+
+QVariant DbTailModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= d.count)
+        return QVariant();
+
+    if (role == Qt::DisplayRole || role == Qt::EditRole) {
+        return d.ring.at((d.first + index.row()) % d.ring.size()).value(index.column());
+    }
+    return QVariant();
+}
+
+/******************************************************************/
+
+bool DbTailModel::setTable(QSqlDatabase db, const QString &table, QString *err)
+{
+    stop();
+
+    beginResetModel();
+    d.db = db;
+    d.table = table;
+    d.record = db.record(table);
+    d.tailColumn = tailColumn(d.record, db.primaryIndex(table));
+    d.last = QVariant();
+    d.first = 0;
+    d.count = 0;
+    d.error.clear();
+    endResetModel();
+
+    if (d.tailColumn < 0) {
+        if (err) *err = tr("%1 has no integer primary key or timestamp column to follow.").arg(table);
+        return false;
+    }
+    return true;
+}
+
+/******************************************************************/
+
+void DbTailModel::clear()
+{
+    stop();
+
+    beginResetModel();
+    for (int i = 0; i < d.count; ++i) {
+        d.ring[(d.first + i) % d.ring.size()] = Row();
+    }
+    d.first = 0;
+    d.count = 0;
+    endResetModel();
+}
+
+/******************************************************************/
+
+int DbTailModel::tailColumn(const QSqlRecord &record, const QSqlIndex &primaryKey)
+{
+    if (primaryKey.count() == 1) {
+        const int column = record.indexOf(primaryKey.fieldName(0));
+        switch (record.field(column).type()) {
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+            return column;
+        default:
+            break;
+        }
+    }
+    for (int i = 0; i < record.count(); ++i) {
+        if (record.field(i).type() == QVariant::DateTime) return i;
+    }
+    return -1;
+}
+
+/******************************************************************/
+
+void DbTailModel::start()
+{
+    if (d.tailColumn < 0 || isRunning()) return;
+
+    // a trigger may NOTIFY the channel named like the table
+    QSqlDriver *driver = d.db.driver();
+    if (Db::dialect(d.db.driverName()) == Db::PostgreSql && driver->hasFeature(QSqlDriver::EventNotifications)) {
+        const QString channel = d.table.toLower();
+        if (driver->subscribeToNotification(channel)) {
+            d.channel = channel;
+            connect(driver, QOverload<const QString &, QSqlDriver::NotificationSource, const QVariant &>::of(&QSqlDriver::notification),
+                    this, &DbTailModel::notified);
+        }
+    }
+
+    fetchNew();
+    d.timer.start();
+}
+
+/******************************************************************/
+
+void DbTailModel::stop()
+{
+    d.timer.stop();
+    if (!d.channel.isEmpty()) {
+        QSqlDriver *driver = d.db.driver();
+        disconnect(driver, Q_NULLPTR, this, Q_NULLPTR);
+        driver->unsubscribeFromNotification(d.channel);
+        d.channel.clear();
+    }
+}
+
+/******************************************************************/
+
+void DbTailModel::fetchNew()
+{
+    if (d.tailColumn < 0) return;
+
+    const QSqlDriver *driver = d.db.driver();
+    QStringList fields;
+    for (int i = 0; i < d.record.count(); ++i) {
+        fields << Db::escapedName(driver, d.record.fieldName(i), QSqlDriver::FieldName);
+    }
+    const QString table = Db::escapedName(driver, d.table, QSqlDriver::TableName);
+    const QString tail = fields.at(d.tailColumn);
+    const int capacity = d.ring.size();
+
+    QSqlQuery query(d.db);
+    query.setForwardOnly(true);
+    QVector<Row> rows;
+    if (d.last.isNull()) {
+        // the first tick reads the most recent rows, NULLs sort first in DESC
+        // on some servers and would leave no value to continue from
+        query.prepare(Db::limitSql(d.db.driverName(),
+                                   QString("SELECT %1 FROM %2 WHERE %3 IS NOT NULL ORDER BY %3 DESC")
+                                   .arg(fields.join(", "), table, tail),
+                                   capacity));
+        if (query.exec()) {
+            while (rows.size() < capacity && query.next()) {
+                rows << readRow(query);
+            }
+            std::reverse(rows.begin(), rows.end());
+        }
+    } else {
+        query.prepare(Db::limitSql(d.db.driverName(),
+                                   QString("SELECT %1 FROM %2 WHERE %3 > ? ORDER BY %3").arg(fields.join(", "), table, tail),
+                                   capacity));
+        query.addBindValue(d.last);
+        if (query.exec()) {
+            while (rows.size() < capacity && query.next()) {
+                rows << readRow(query);
+            }
+        }
+    }
+
+    d.error = query.lastError().isValid() ? query.lastError().text() : QString();
+    appendRows(rows);
+}
+
+/******************************************************************/
+
+void DbTailModel::notified(const QString &name)
+{
+    if (name == d.channel) {
+        fetchNew();
+    }
+}
+
+/******************************************************************/
+
+void DbTailModel::appendRows(QVector<Row> rows)
+{
+    if (rows.isEmpty()) return;
+
+    const int capacity = d.ring.size();
+    if (rows.size() > capacity) {
+        rows.remove(0, rows.size() - capacity);
+    }
+    d.last = rows.last().value(d.tailColumn);
+
+    // the oldest rows leave the ring first
+    const int overflow = d.count + rows.size() - capacity;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        for (int i = 0; i < overflow; ++i) {
+            d.ring[(d.first + i) % capacity] = Row();
+        }
+        d.first = (d.first + overflow) % capacity;
+        d.count -= overflow;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), d.count, d.count + rows.size() - 1);
+    for (const auto &row : qAsConst(rows)) {
+        d.ring[(d.first + d.count) % capacity] = row;
+        ++d.count;
+    }
+    endInsertRows();
+
+    emit rowsAppended(rows.size());
+}
+
+/******************************************************************/
+
+DbTailModel::Row DbTailModel::readRow(const QSqlQuery &query) const
+{
+    Row row(d.record.count());
+    for (int c = 0; c < row.size(); ++c) {
+        row[c] = query.value(c);
+    }
+    return row;
+}
+
+/******************************************************************/
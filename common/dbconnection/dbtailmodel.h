@@ -0,0 +1,114 @@
+#ifndef DBTAILMODEL_H
+#define DBTAILMODEL_H
+
+#include <QAbstractTableModel>
+#include <QSqlDatabase>
+#include <QSqlRecord>
+#include <QSqlDriver>
+#include <QVector>
+#include <QTimer>
+
+class QSqlQuery;
+class QSqlIndex;
+
+/******************************************************************/
+/**
+ * @brief Read-only tail of an append-only table
+ *
+ * Remembers the highest value of the tail column, an integer primary key
+ * or else the first timestamp column, and on every tick selects only the
+ * rows above it. New rows are appended at the bottom; the model keeps a
+ * ring of the most recent rows, older rows leave at the top. On
+ * PostgreSQL a NOTIFY on the channel named like the table triggers a tick
+ * at once.
+ */
+class DbTailModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+    struct DbTailModelSettings {
+        const QString ROWS     = "datatable/tailrows";
+        const QString INTERVAL = "datatable/tailinterval";  ///< ms
+    };
+
+public:
+    typedef QVector<QVariant> Row;
+
+    enum {
+        TailRows   = 10000,
+        IntervalMs = 2000
+    };
+
+private:
+    struct DbTailModelPrivate {
+        QSqlDatabase db;
+        QString      table;
+        QSqlRecord   record;
+        int          tailColumn = -1;
+        QVariant     last;          ///< highest tail value seen
+        QVector<Row> ring;
+        int          first    = 0;  ///< ring position of row 0
+        int          count    = 0;
+        QTimer       timer;
+        QString      channel;       ///< subscribed notification
+        QString      error;
+    };
+
+public:
+    explicit DbTailModel(QObject *parent = nullptr);
+    ~DbTailModel();
+
+    // Header:
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Basic functionality:
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /// the table needs an integer primary key or a timestamp column
+    bool setTable(QSqlDatabase db, const QString &table, QString *err = Q_NULLPTR);
+
+    /// stops following and drops the rows
+    void clear();
+
+    QSqlRecord record() const {
+        return d.record;
+    }
+
+    QString tailField() const {
+        return d.record.fieldName(d.tailColumn);
+    }
+
+    bool isRunning() const {
+        return d.timer.isActive();
+    }
+
+    QString lastError() const {
+        return d.error;
+    }
+
+    /// column of record to follow, or -1
+    static int tailColumn(const QSqlRecord &record, const QSqlIndex &primaryKey);
+
+public Q_SLOTS:
+    void start();
+    void stop();
+    void fetchNew();
+
+Q_SIGNALS:
+    void rowsAppended(int count);
+
+private Q_SLOTS:
+    void notified(const QString &name);
+
+private:
+    void appendRows(QVector<Row> rows);
+    Row readRow(const QSqlQuery &query) const;
+
+private:
+    DbTailModelPrivate d;
+};
+
+#endif // DBTAILMODEL_H
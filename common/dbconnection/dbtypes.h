@@ -1,7 +1,11 @@
 #ifndef DBTYPES_H
 #define DBTYPES_H
 
+#include "dbdialect.h"
+
 #include <QString>
+#include <QVariant>
+#include <QSqlField>
 
 namespace Db {
 
@@ -406,6 +410,66 @@ inline QString typeNameById(const QString &driver, int t) {
     return QString("Type %1").arg(t);
 }
 
+/******************************************************************/
+//! column type for values of field in the dialect of driver, used for tables created by a copy
+inline QString columnTypeSql(const QString &driver, const QSqlField &field) {
+    const Dialect target = dialect(driver);
+    const int length = field.length();
+    switch (field.type()) {
+    case QVariant::Bool:
+        return target == OracleSql ? "NUMBER(1)" : target == SqliteSql ? "INTEGER" : "BOOLEAN";
+    case QVariant::Int:
+    case QVariant::UInt:
+        return target == OracleSql ? "NUMBER(10)" : "INTEGER";
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+        return target == OracleSql ? "NUMBER(19)" : target == SqliteSql ? "INTEGER" : "BIGINT";
+    case QVariant::Double:
+        // NUMERIC(p,0) integers and keys are exact too, only an unknown precision is a float
+        if (length > 0 && field.precision() >= 0) {
+            return QString(target == OracleSql ? "NUMBER(%1,%2)" : "NUMERIC(%1,%2)").arg(length).arg(field.precision());
+        }
+        switch (target) {
+        case OracleSql:  return "BINARY_DOUBLE";
+        case PostgreSql: return "DOUBLE PRECISION";
+        case SqliteSql:  return "REAL";
+        default:         return "DOUBLE";
+        }
+    case QVariant::Date:
+        return target == SqliteSql ? "TEXT" : "DATE";
+    case QVariant::Time:
+        return target == OracleSql ? "TIMESTAMP" : target == SqliteSql ? "TEXT" : "TIME";
+    case QVariant::DateTime:
+        return target == MySqlSql ? "DATETIME" : target == SqliteSql ? "TEXT" : "TIMESTAMP";
+    case QVariant::ByteArray:
+        return target == PostgreSql ? "BYTEA" : target == MySqlSql ? "LONGBLOB" : "BLOB";
+    default:
+        break;
+    }
+    if (target == SqliteSql) return "TEXT";
+    if (length > 0 && length <= 4000) {
+        return QString(target == OracleSql ? "VARCHAR2(%1)" : "VARCHAR(%1)").arg(length);
+    }
+    return target == OracleSql ? "CLOB" : target == MySqlSql ? "LONGTEXT" : "TEXT";
+}
+
+/******************************************************************/
+//! value of another driver for a field of type, NULL becomes NULL of type
+inline QVariant convertValue(const QVariant &value, QVariant::Type type) {
+    if (type == QVariant::Invalid || value.type() == type) return value;
+    if (value.isNull()) return QVariant(type);
+
+    // Oracle and SQLite keep flags as numbers or letters
+    if (type == QVariant::Bool && value.type() == QVariant::String) {
+        const QString text = value.toString().trimmed().toLower();
+        if (text == "1" || text == "y" || text == "t" || text == "yes" || text == "true") return true;
+        if (text == "0" || text == "n" || text == "f" || text == "no" || text == "false") return false;
+    }
+    QVariant result = value;
+    // values which cannot be converted are passed on for the server to cast
+    return result.convert(int(type)) ? result : value;
+}
+
 } // namespace Db
 
 #endif // DBTYPES_H
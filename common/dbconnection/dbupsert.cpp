@@ -0,0 +1,296 @@
+#include "dbupsert.h"
+
+#include "dbdialect.h"
+
+#include <QSqlQuery>
+#include <QSqlIndex>
+#include <QSqlError>
+#include <QHash>
+
+/******************************************************************/
+
+DbUpsert::DbUpsert(QSqlDatabase db, const QString &table, QObject *parent)
+    : QObject(parent)
+{
+    d.db = db;
+    d.table = table;
+    d.record = db.record(table);
+}
+
+/******************************************************************/
+
+bool DbUpsert::setRows(const QStringList &fields, const QVector<QStringList> &rows, QString *err)
+{
+    d.fields.clear();
+    d.keyColumns.clear();
+    d.rows = rows;
+    d.states.fill(New, rows.size());
+
+    for (const auto &field : fields) {
+        const int i = d.record.indexOf(field);
+        if (i < 0) {
+            if (err) *err = tr("%1 is not a field of %2.").arg(field, d.table);
+            return false;
+        }
+        d.fields << d.record.fieldName(i);
+    }
+
+    const QSqlIndex pk = d.db.primaryIndex(d.table);
+    if (pk.isEmpty()) {
+        if (err) *err = tr("The table %1 has no primary key.").arg(d.table);
+        return false;
+    }
+    for (int k = 0; k < pk.count(); ++k) {
+        int column = -1;
+        for (int c = 0; c < d.fields.size() && column < 0; ++c) {
+            if (d.fields.at(c).compare(pk.fieldName(k), Qt::CaseInsensitive) == 0) {
+                column = c;
+            }
+        }
+        if (column < 0) {
+            if (err) *err = tr("The primary key field %1 is missing.").arg(pk.fieldName(k));
+            return false;
+        }
+        d.keyColumns << column;
+    }
+    return true;
+}
+
+/******************************************************************/
+
+bool DbUpsert::classify(QString *err)
+{
+    d.states.fill(New, d.rows.size());
+    const int keys = d.keyColumns.size();
+    if (!keys) return true;
+
+    // every key is looked up once, pasted rows with the same key share the state
+    QHash<QString, QVector<int>> byKey;
+    QVector<int> firsts;
+    for (int r = 0; r < d.rows.size(); ++r) {
+        QVector<int> &rows = byKey[keyText(r)];
+        if (rows.isEmpty()) firsts << r;
+        rows << r;
+    }
+
+    const QSqlDriver *driver = d.db.driver();
+    QStringList columns;
+    for (const auto &field : qAsConst(d.fields)) {
+        columns << Db::escapedName(driver, field, QSqlDriver::FieldName);
+    }
+    QStringList keyNames;
+    for (int k : qAsConst(d.keyColumns)) {
+        keyNames << columns.at(k);
+    }
+    const QString table = Db::escapedName(driver, d.table, QSqlDriver::TableName);
+
+    QSqlQuery query(d.db);
+    query.setForwardOnly(true);
+    const int chunk = qMax(1, Db::SetParams / keys);
+    for (int first = 0; first < firsts.size(); first += chunk) {
+        const int count = qMin(chunk, firsts.size() - first);
+        query.prepare(QString("SELECT %1 FROM %2 WHERE %3")
+                      .arg(columns.join(", "), table, Db::keySetSql(keyNames, count)));
+        int position = 0;
+        for (int i = first; i < first + count; ++i) {
+            for (int k : qAsConst(d.keyColumns)) {
+                query.bindValue(position++, d.rows.at(firsts.at(i)).value(k));
+            }
+        }
+        if (!query.exec()) {
+            if (err) *err = query.lastError().text();
+            return false;
+        }
+
+        while (query.next()) {
+            QStringList key;
+            for (int k : qAsConst(d.keyColumns)) {
+                key << query.value(k).toString();
+            }
+            const auto it = byKey.constFind(key.join(QChar(0x1f)));
+            if (it == byKey.constEnd()) continue;
+            for (int row : it.value()) {
+                State state = Unchanged;
+                for (int c = 0; c < d.fields.size() && state == Unchanged; ++c) {
+                    if (!sameValue(query.value(c), d.rows.at(row).value(c))) {
+                        state = Changed;
+                    }
+                }
+                d.states[row] = state;
+            }
+        }
+    }
+    return true;
+}
+
+/******************************************************************/
+
+int DbUpsert::count(State state) const
+{
+    return d.states.count(state);
+}
+
+/******************************************************************/
+
+bool DbUpsert::hasUpsert() const
+{
+    return !Db::upsertSql(d.db.driverName(), "t", QStringList() << "k", QStringList() << "k").isEmpty();
+}
+
+/******************************************************************/
+
+bool DbUpsert::apply(int batchSize, QString *err)
+{
+    d.failedRow = -1;
+    batchSize = qMax(1, batchSize);
+
+    QVector<int> targets, added, changed;
+    for (int r = 0; r < d.states.size(); ++r) {
+        if (d.states.at(r) == Unchanged) continue;
+        targets << r;
+        if (d.states.at(r) == New) {
+            added << r;
+        } else {
+            changed << r;
+        }
+    }
+    const int total = targets.size();
+    if (!total) return true;
+
+    const QSqlDriver *driver = d.db.driver();
+    const QString table = Db::escapedName(driver, d.table, QSqlDriver::TableName);
+    QStringList columns, keys, marks;
+    QVector<int> all, nonKeys;
+    for (int c = 0; c < d.fields.size(); ++c) {
+        columns << Db::escapedName(driver, d.fields.at(c), QSqlDriver::FieldName);
+        marks << "?";
+        all << c;
+        if (d.keyColumns.contains(c)) {
+            keys << columns.last();
+        } else {
+            nonKeys << c;
+        }
+    }
+
+    const bool useTransactions = d.db.driver()->hasFeature(QSqlDriver::Transactions);
+    if (useTransactions && !d.db.transaction()) {
+        if (err) *err = d.db.lastError().text();
+        return false;
+    }
+
+    int done = 0;
+    bool ok = true;
+    const QString upsert = Db::upsertSql(d.db.driverName(), table, columns, keys);
+    if (!upsert.isEmpty()) {
+        ok = execBatches(upsert, targets, all, batchSize, done, total, err);
+    } else {
+        ok = execBatches(QString("INSERT INTO %1 (%2) VALUES (%3)").arg(table, columns.join(", "), marks.join(", ")),
+                         added, all, batchSize, done, total, err);
+        if (ok && !changed.isEmpty() && !nonKeys.isEmpty()) {
+            QStringList sets, where;
+            for (int c : qAsConst(nonKeys)) {
+                sets << QString("%1 = ?").arg(columns.at(c));
+            }
+            for (int c : qAsConst(d.keyColumns)) {
+                where << QString("%1 = ?").arg(columns.at(c));
+            }
+            ok = execBatches(QString("UPDATE %1 SET %2 WHERE %3").arg(table, sets.join(", "), where.join(" AND ")),
+                             changed, nonKeys + d.keyColumns, batchSize, done, total, err);
+        }
+    }
+
+    if (!ok) {
+        if (useTransactions) d.db.rollback();
+        return false;
+    }
+    if (useTransactions && !d.db.commit()) {
+        if (err) *err = d.db.lastError().text();
+        d.db.rollback();
+        return false;
+    }
+    return true;
+}
+
+/******************************************************************/
+
+QString DbUpsert::keyText(int row) const
+{
+    QStringList key;
+    for (int k : d.keyColumns) {
+        key << d.rows.at(row).value(k);
+    }
+    return key.join(QChar(0x1f));
+}
+
+/******************************************************************/
+
+QVariant DbUpsert::bindValue(int row, int column) const
+{
+    const QString text = d.rows.at(row).value(column);
+    if (text.isEmpty()) {
+        return QVariant(QVariant::String);
+    }
+    return text;
+}
+
+/******************************************************************/
+
+bool DbUpsert::execBatches(const QString &sql, const QVector<int> &rows, const QVector<int> &columns,
+                           int batchSize, int &done, int total, QString *err)
+{
+    if (rows.isEmpty()) return true;
+
+    QSqlQuery query(d.db);
+    if (!query.prepare(sql)) {
+        if (err) *err = query.lastError().text();
+        d.failedRow = rows.first();
+        return false;
+    }
+
+    for (int first = 0; first < rows.size(); first += batchSize) {
+        const int last = qMin(first + batchSize, rows.size());
+        for (int i = 0; i < columns.size(); ++i) {
+            QVariantList values;
+            for (int r = first; r < last; ++r) {
+                values << bindValue(rows.at(r), columns.at(i));
+            }
+            query.bindValue(i, values);
+        }
+        if (!query.execBatch()) {
+            if (err) *err = query.lastError().text();
+            d.failedRow = rows.at(first);
+            return false;
+        }
+        done += last - first;
+        emit progress(done, total);
+    }
+    return true;
+}
+
+/******************************************************************/
+
+bool DbUpsert::sameValue(const QVariant &value, const QString &text)
+{
+    if (text.isEmpty()) {
+        return value.isNull() || value.toString().isEmpty();
+    }
+    if (value.isNull()) return false;
+
+    switch (value.type()) {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double: {
+        // "1.50" and 1.5 are the same number
+        bool ok = false;
+        const double number = text.toDouble(&ok);
+        return ok && number == value.toDouble();
+    }
+    default:
+        break;
+    }
+    return value.toString() == text;
+}
+
+/******************************************************************/
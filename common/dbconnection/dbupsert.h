@@ -0,0 +1,84 @@
+#ifndef DBUPSERT_H
+#define DBUPSERT_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QSqlRecord>
+#include <QSqlDriver>
+#include <QStringList>
+#include <QVector>
+
+/******************************************************************/
+/**
+ * @brief Pasted rows written into a table by primary key
+ *
+ * The rows are compared with the table in sets of keys and classified as
+ * new, changed or unchanged. apply() writes the new and changed rows as
+ * prepared batches in one transaction, with the driver's upsert statement
+ * (see Db::upsertSql) or separate inserts and updates otherwise. Empty
+ * texts are written as NULL.
+ */
+class DbUpsert : public QObject
+{
+    Q_OBJECT
+
+    struct DbUpsertPrivate {
+        QSqlDatabase        db;
+        QString             table;
+        QSqlRecord          record;
+        QStringList         fields;     ///< table fields of the pasted columns
+        QVector<int>        keyColumns; ///< pasted columns of the primary key
+        QVector<QStringList> rows;
+        QVector<int>        states;
+        int                 failedRow = -1;
+    };
+
+public:
+    enum State {
+        New,
+        Changed,
+        Unchanged
+    };
+
+    DbUpsert(QSqlDatabase db, const QString &table, QObject *parent = Q_NULLPTR);
+
+    /// fields name the table field of every pasted column, all primary key fields are required
+    bool setRows(const QStringList &fields, const QVector<QStringList> &rows, QString *err = Q_NULLPTR);
+
+    /// reads the pasted keys from the table and compares the rows
+    bool classify(QString *err = Q_NULLPTR);
+
+    State state(int row) const {
+        return State(d.states.value(row, New));
+    }
+
+    int count(State state) const;
+
+    /// the driver has a native upsert statement
+    bool hasUpsert() const;
+
+    /// writes the new and changed rows, everything is rolled back on the first error
+    bool apply(int batchSize, QString *err = Q_NULLPTR);
+
+    /// first row of the batch which failed in the last apply(), or -1
+    int failedRow() const {
+        return d.failedRow;
+    }
+
+signals:
+    void progress(int done, int total);
+
+private:
+    QString keyText(int row) const;
+    QVariant bindValue(int row, int column) const;
+    bool execBatches(const QString &sql, const QVector<int> &rows, const QVector<int> &columns,
+                     int batchSize, int &done, int total, QString *err);
+
+private: // static
+    static bool sameValue(const QVariant &value, const QString &text);
+
+private:
+    DbUpsertPrivate d;
+};
+
+#endif // DBUPSERT_H
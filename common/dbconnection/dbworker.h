@@ -0,0 +1,45 @@
+#ifndef DBWORKER_H
+#define DBWORKER_H
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QThread>
+
+#include <functional>
+
+namespace Db {
+
+typedef std::function<QString (QSqlDatabase &db)> WorkerTask;
+
+/******************************************************************/
+/**
+ * @brief Runs task on its own clone of a connection
+ *
+ * A connection can only be used by the thread that opened it, so worker
+ * threads open a clone named after purpose and the thread, which is
+ * removed again afterwards. Returns the error of opening the clone or the
+ * error returned by task.
+ */
+inline QString withClone(const QString &connectionName, const QString &purpose, const WorkerTask &task) {
+    QString err;
+    const QString name = QString("%1_%2_%3")
+            .arg(connectionName, purpose)
+            .arg(quintptr(QThread::currentThreadId()));
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(connectionName, name);
+        if (!db.open()) {
+            err = db.lastError().text();
+        } else {
+            err = task(db);
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+    return err;
+}
+
+/******************************************************************/
+
+} // namespace Db
+
+#endif // DBWORKER_H
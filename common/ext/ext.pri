@@ -3,23 +3,45 @@ DEPENDPATH += $$PWD
 
 HEADERS += \
     $$PWD/booleancheckboxdelegate.h \
+    $$PWD/xboundedqueue.h \
     $$PWD/xclickablelabel.h \
     $$PWD/xcolorselector.h \
+    $$PWD/xcolumnformatter.h \
     $$PWD/xcombobox.h \
     $$PWD/xcsvmodel.h \
     $$PWD/xdateedit.h \
     $$PWD/xdatetimeedit.h \
+    $$PWD/xfilterrow.h \
+    $$PWD/xfindbar.h \
+    $$PWD/xfinddelegate.h \
+    $$PWD/xfindindex.h \
+    $$PWD/xformatdelegate.h \
+    $$PWD/xgzipwriter.h \
     $$PWD/xguiutils.h \
+    $$PWD/xsortfiltermodel.h \
     $$PWD/xpropertyhelper.h \
+    $$PWD/xselectionstats.h \
+    $$PWD/xtablesizer.h \
+    $$PWD/xtablemimedata.h \
     $$PWD/xtextedit.h \
     $$PWD/xtexttemplate.h \
     $$PWD/xutils.h
 
 SOURCES += \
     $$PWD/xcolorselector.cpp \
+    $$PWD/xcolumnformatter.cpp \
     $$PWD/xcombobox.cpp \
     $$PWD/xcsvmodel.cpp \
     $$PWD/xdateedit.cpp \
     $$PWD/xdatetimeedit.cpp \
+    $$PWD/xfilterrow.cpp \
+    $$PWD/xfindbar.cpp \
+    $$PWD/xfindindex.cpp \
+    $$PWD/xformatdelegate.cpp \
+    $$PWD/xgzipwriter.cpp \
+    $$PWD/xselectionstats.cpp \
+    $$PWD/xsortfiltermodel.cpp \
+    $$PWD/xtablesizer.cpp \
+    $$PWD/xtablemimedata.cpp \
     $$PWD/xtextedit.cpp
 
@@ -0,0 +1,70 @@
+#ifndef XBOUNDEDQUEUE_H
+#define XBOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+
+/******************************************************************/
+/**
+ * @brief Blocking queue of a fixed capacity between two threads
+ *
+ * push() waits while the queue is full, so a fast producer is held back
+ * by a slow consumer. close() ends the exchange from either side: push()
+ * fails at once, pop() still returns the queued items and fails when the
+ * queue is empty.
+ */
+template <typename T>
+class XBoundedQueue
+{
+public:
+    explicit XBoundedQueue(int capacity)
+        : m_Capacity(qMax(1, capacity))
+    {}
+
+    /// false if the queue is closed
+    bool push(const T &item) {
+        QMutexLocker locker(&m_Mutex);
+        while (!m_Closed && m_Items.size() >= m_Capacity) {
+            m_NotFull.wait(&m_Mutex);
+        }
+        if (m_Closed) return false;
+        m_Items.enqueue(item);
+        m_NotEmpty.wakeOne();
+        return true;
+    }
+
+    /// false if the queue is closed and empty
+    bool pop(T *item) {
+        QMutexLocker locker(&m_Mutex);
+        while (!m_Closed && m_Items.isEmpty()) {
+            m_NotEmpty.wait(&m_Mutex);
+        }
+        if (m_Items.isEmpty()) return false;
+        *item = m_Items.dequeue();
+        m_NotFull.wakeOne();
+        return true;
+    }
+
+    void close() {
+        QMutexLocker locker(&m_Mutex);
+        m_Closed = true;
+        m_NotFull.wakeAll();
+        m_NotEmpty.wakeAll();
+    }
+
+    int size() const {
+        QMutexLocker locker(&m_Mutex);
+        return m_Items.size();
+    }
+
+private:
+    mutable QMutex m_Mutex;
+    QWaitCondition m_NotFull;
+    QWaitCondition m_NotEmpty;
+    QQueue<T>      m_Items;
+    int            m_Capacity;
+    bool           m_Closed = false;
+};
+
+#endif // XBOUNDEDQUEUE_H
@@ -0,0 +1,91 @@
+#include "xcolumnformatter.h"
+
+#include <QDateTime>
+
+/******************************************************************/
+
+Qt::Alignment XColumnFormatter::alignment() const
+{
+    switch (m_Kind) {
+    case Integer:
+    case Decimal:
+        return Qt::AlignRight | Qt::AlignVCenter;
+    default:
+        break;
+    }
+    return Qt::AlignLeft | Qt::AlignVCenter;
+}
+
+/******************************************************************/
+
+QString XColumnFormatter::format(const QVariant &value) const
+{
+    if (value.isNull()) return QString();
+
+    bool ok = true;
+    switch (m_Kind) {
+    case Integer: {
+        const qlonglong number = value.toLongLong(&ok);
+        if (ok) return m_Locale.toString(number);
+        break;
+    }
+    case Decimal: {
+        // exact decimals which the driver returns as text stay untouched
+        if (value.type() == QVariant::String) return value.toString();
+        const double number = value.toDouble(&ok);
+        if (ok) {
+            return m_Precision > 0
+                    ? m_Locale.toString(number, 'f', m_Precision)
+                    : m_Locale.toString(number, 'g', 15);
+        }
+        break;
+    }
+    case Date:
+        if (value.canConvert<QDate>()) return m_Locale.toString(value.toDate(), QLocale::ShortFormat);
+        break;
+    case DateTime:
+        if (value.canConvert<QDateTime>()) return m_Locale.toString(value.toDateTime(), QLocale::ShortFormat);
+        break;
+    case Bool:
+        return value.toBool() ? QStringLiteral("true") : QStringLiteral("false");
+    case Bytes: {
+        const QByteArray data = value.toByteArray();
+        QString text = QString::fromLatin1(data.left(BytesShown).toHex(' '));
+        if (data.size() > BytesShown) {
+            text += QStringLiteral("... [%1 bytes]").arg(data.size());
+        }
+        return text;
+    }
+    case Text:
+        break;
+    }
+    return value.toString();
+}
+
+/******************************************************************/
+
+XColumnFormatter XColumnFormatter::forType(QVariant::Type type, int precision)
+{
+    switch (type) {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+        return XColumnFormatter(Integer);
+    case QVariant::Double:
+        return XColumnFormatter(Decimal, precision);
+    case QVariant::Date:
+        return XColumnFormatter(Date);
+    case QVariant::DateTime:
+        return XColumnFormatter(DateTime);
+    case QVariant::Bool:
+        return XColumnFormatter(Bool);
+    case QVariant::ByteArray:
+        return XColumnFormatter(Bytes);
+    default:
+        break;
+    }
+    return XColumnFormatter(Text);
+}
+
+/******************************************************************/
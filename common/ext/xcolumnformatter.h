@@ -0,0 +1,56 @@
+#ifndef XCOLUMNFORMATTER_H
+#define XCOLUMNFORMATTER_H
+
+#include <QVariant>
+#include <QLocale>
+
+/******************************************************************/
+/**
+ * @brief Display text of the values of one column
+ *
+ * The kind is chosen once from the column type, so formatting a cell is
+ * a single switch instead of the type dispatch of QStyledItemDelegate.
+ * Values of an unexpected type are shown with QVariant::toString().
+ */
+class XColumnFormatter
+{
+public:
+    enum Kind {
+        Text,
+        Integer,
+        Decimal,
+        Date,
+        DateTime,
+        Bool,
+        Bytes
+    };
+
+    enum {
+        BytesShown = 32 ///< leading bytes shown as hex
+    };
+
+    XColumnFormatter() {}
+    XColumnFormatter(Kind kind, int precision = -1)
+        : m_Kind(kind), m_Precision(precision) {}
+
+    Kind kind() const {
+        return m_Kind;
+    }
+
+    /// numbers are right aligned
+    Qt::Alignment alignment() const;
+
+    /// null values give a null string
+    QString format(const QVariant &value) const;
+
+public: // static
+    /// precision is the number of decimals of numeric columns, negative if unknown
+    static XColumnFormatter forType(QVariant::Type type, int precision = -1);
+
+private:
+    Kind    m_Kind      = Text;
+    int     m_Precision = -1;
+    QLocale m_Locale;
+};
+
+#endif // XCOLUMNFORMATTER_H
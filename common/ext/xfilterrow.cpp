@@ -0,0 +1,123 @@
+#include "xfilterrow.h"
+
+#include <QTableView>
+#include <QHeaderView>
+#include <QScrollBar>
+#include <QLineEdit>
+
+/******************************************************************/
+
+XFilterRow::XFilterRow(QTableView *view, QWidget *parent)
+    : QWidget(parent)
+{
+    d.view = view;
+    d.timer.setSingleShot(true);
+    d.timer.setInterval(DebounceMs);
+    setFixedHeight(QLineEdit().sizeHint().height());
+
+    connect(&d.timer, &QTimer::timeout,
+            this, &XFilterRow::filterChanged);
+
+    // the edits follow the header sections
+    QHeaderView *header = view->horizontalHeader();
+    connect(header, &QHeaderView::sectionResized,
+            this, &XFilterRow::updateGeometries);
+    connect(header, &QHeaderView::sectionMoved,
+            this, &XFilterRow::updateGeometries);
+    connect(header, &QHeaderView::geometriesChanged,
+            this, &XFilterRow::updateGeometries);
+    connect(view->horizontalScrollBar(), &QScrollBar::valueChanged,
+            this, &XFilterRow::updateGeometries);
+}
+
+/******************************************************************/
+
+QStringList XFilterRow::texts() const
+{
+    QStringList result;
+    for (QLineEdit *edit : d.edits) {
+        result << edit->text().trimmed();
+    }
+    return result;
+}
+
+/******************************************************************/
+
+void XFilterRow::setInvalid(int column, const QString &message)
+{
+    for (int i = 0; i < d.edits.size(); ++i) {
+        QLineEdit *edit = d.edits.at(i);
+        const bool invalid = i == column;
+        edit->setStyleSheet(invalid ? QStringLiteral("QLineEdit { color: red; }") : QString());
+        edit->setToolTip(invalid ? message : tr("Filter: text, *pattern*, =, <>, <, <=, >, >= value, NULL or !NULL"));
+    }
+}
+
+/******************************************************************/
+
+void XFilterRow::rebuild()
+{
+    d.timer.stop();
+    qDeleteAll(d.edits);
+    d.edits.clear();
+
+    const QAbstractItemModel *model = d.view->model();
+    const int columns = model ? model->columnCount() : 0;
+    for (int c = 0; c < columns; ++c) {
+        auto edit = new QLineEdit(this);
+        edit->setPlaceholderText(model->headerData(c, Qt::Horizontal).toString());
+        edit->setClearButtonEnabled(true);
+        connect(edit, &QLineEdit::textChanged, &d.timer, QOverload<>::of(&QTimer::start));
+        connect(edit, &QLineEdit::returnPressed, this, [this](){
+            d.timer.stop();
+            emit filterChanged();
+        });
+        d.edits << edit;
+    }
+    setInvalid(-1);
+    updateGeometries();
+    setVisible(columns > 0);
+}
+
+/******************************************************************/
+
+void XFilterRow::clear()
+{
+    d.timer.stop();
+    for (QLineEdit *edit : qAsConst(d.edits)) {
+        edit->clear();
+    }
+    setInvalid(-1);
+}
+
+/******************************************************************/
+
+void XFilterRow::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateGeometries();
+}
+
+/******************************************************************/
+
+void XFilterRow::updateGeometries()
+{
+    const QHeaderView *header = d.view->horizontalHeader();
+    // header sections start behind the frame and the vertical header of the view
+    const int offset = d.view->viewport()->mapToGlobal(QPoint()).x() - mapToGlobal(QPoint()).x();
+    for (int c = 0; c < d.edits.size(); ++c) {
+        QLineEdit *edit = d.edits.at(c);
+        if (header->isSectionHidden(c)) {
+            edit->hide();
+            continue;
+        }
+        const int x = offset + header->sectionViewportPosition(c);
+        const int width = header->sectionSize(c);
+        // sections scrolled out of the viewport are hidden
+        const bool visible = x + width > offset && x < offset + d.view->viewport()->width();
+        edit->setGeometry(x, 0, width, height());
+        edit->setVisible(visible);
+    }
+}
+
+/******************************************************************/
@@ -0,0 +1,63 @@
+#ifndef XFILTERROW_H
+#define XFILTERROW_H
+
+#include <QWidget>
+#include <QVector>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QTableView;
+class QLineEdit;
+QT_END_NAMESPACE
+
+/******************************************************************/
+/**
+ * @brief Row of filter edits above the columns of a table view
+ *
+ * Every column of the view's model gets a line edit which follows the
+ * position and width of its header section. filterChanged() is emitted
+ * when typing has paused for DebounceMs or at once on Enter, so a filter
+ * is only applied for the last text.
+ */
+class XFilterRow : public QWidget
+{
+    Q_OBJECT
+
+    struct XFilterRowPrivate {
+        QTableView         *view = Q_NULLPTR;
+        QVector<QLineEdit*> edits;  ///< by logical column
+        QTimer              timer;
+    };
+
+public:
+    enum {
+        DebounceMs = 400
+    };
+
+    explicit XFilterRow(QTableView *view, QWidget *parent = Q_NULLPTR);
+
+    /// filter texts by logical column
+    QStringList texts() const;
+
+    /// marks the edit of column as invalid with a tool tip, -1 marks none
+    void setInvalid(int column, const QString &message = QString());
+
+public Q_SLOTS:
+    /// one empty edit per column of the view's current model
+    void rebuild();
+    void clear();
+
+Q_SIGNALS:
+    void filterChanged();
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
+private Q_SLOTS:
+    void updateGeometries();
+
+private:
+    XFilterRowPrivate d;
+};
+
+#endif // XFILTERROW_H
@@ -0,0 +1,283 @@
+#include "xfindbar.h"
+#include "xfinddelegate.h"
+
+#include <QApplication>
+#include <QTableView>
+#include <QLineEdit>
+#include <QLabel>
+#include <QToolButton>
+#include <QHBoxLayout>
+#include <QShortcut>
+#include <QKeyEvent>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+enum {
+    SliceMs = 20 ///< matching time per event loop turn
+};
+
+/******************************************************************/
+
+XFindBar::XFindBar(QTableView *view, QWidget *parent)
+    : QWidget(parent)
+{
+    d.view = view;
+    d.delegate = new XFindDelegate(this);
+    view->setItemDelegate(d.delegate);
+
+    d.timer.setSingleShot(true);
+    d.timer.setInterval(0);
+
+    setupUI();
+    hide();
+
+    connect(&d.timer, &QTimer::timeout,
+            this, &XFindBar::matchNext);
+    connect(&d.index, &XFindIndex::restarted,
+            this, &XFindBar::restartMatching);
+    connect(&d.index, &XFindIndex::progress, this, [this](){
+        if (!d.pattern.isEmpty() && !d.timer.isActive()) {
+            d.timer.start();
+        }
+        updateStatus();
+    });
+
+    auto findShortcut = new QShortcut(QKeySequence::Find, view);
+    findShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(findShortcut, &QShortcut::activated,
+            this, &XFindBar::activate);
+
+    for (QWidget *widget : QList<QWidget*>() << view << this) {
+        auto nextShortcut = new QShortcut(QKeySequence::FindNext, widget);
+        nextShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+        connect(nextShortcut, &QShortcut::activated,
+                this, &XFindBar::findNext);
+        auto prevShortcut = new QShortcut(QKeySequence::FindPrevious, widget);
+        prevShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+        connect(prevShortcut, &QShortcut::activated,
+                this, &XFindBar::findPrevious);
+    }
+}
+
+/******************************************************************/
+
+void XFindBar::activate()
+{
+    show();
+    if (d.index.model() != d.view->model()) {
+        d.index.setModel(d.view->model());
+    }
+    ui_Text->setFocus();
+    ui_Text->selectAll();
+}
+
+/******************************************************************/
+
+void XFindBar::findNext()
+{
+    if (d.matches.isEmpty()) return;
+
+    const QModelIndex current = d.view->currentIndex();
+    int idx = 0;
+    if (current.isValid()) {
+        const Match key = { current.row(), current.column() };
+        auto it = std::upper_bound(d.matches.constBegin(), d.matches.constEnd(), key);
+        idx = it == d.matches.constEnd() ? 0 : int(it - d.matches.constBegin());
+    }
+    selectMatch(idx);
+}
+
+/******************************************************************/
+
+void XFindBar::findPrevious()
+{
+    if (d.matches.isEmpty()) return;
+
+    const QModelIndex current = d.view->currentIndex();
+    int idx = d.matches.size() - 1;
+    if (current.isValid()) {
+        const Match key = { current.row(), current.column() };
+        auto it = std::lower_bound(d.matches.constBegin(), d.matches.constEnd(), key);
+        idx = it == d.matches.constBegin() ? d.matches.size() - 1 : int(it - d.matches.constBegin()) - 1;
+    }
+    selectMatch(idx);
+}
+
+/******************************************************************/
+
+void XFindBar::deactivate()
+{
+    hide();
+    d.timer.stop();
+    d.index.setModel(Q_NULLPTR);
+    d.delegate->setPattern(QString());
+    d.view->viewport()->update();
+    d.view->setFocus();
+}
+
+/******************************************************************/
+
+void XFindBar::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_Escape) {
+        deactivate();
+        return;
+    }
+    QWidget::keyPressEvent(event);
+}
+
+/******************************************************************/
+
+void XFindBar::setPattern(const QString &pattern)
+{
+    d.pattern = pattern;
+    d.hashes = XFindIndex::trigrams(pattern);
+    d.delegate->setPattern(pattern);
+    d.view->viewport()->update();
+
+    if (d.index.model() != d.view->model()) {
+        d.index.setModel(d.view->model());
+    }
+    restartMatching();
+}
+
+/******************************************************************/
+//! checks the rows of candidate blocks until the time slice is used up
+void XFindBar::matchNext()
+{
+    QAbstractItemModel *model = d.index.model();
+    if (!model || d.pattern.isEmpty()) return;
+
+    QElapsedTimer budget;
+    budget.start();
+
+    const bool hadMatches = !d.matches.isEmpty();
+    const int columns = model->columnCount();
+    const int indexed = d.index.indexedRows();
+    while (d.matchedRows < indexed && budget.elapsed() < SliceMs) {
+        const int block = d.matchedRows / XFindIndex::BlockRows;
+        const int end = qMin(indexed, (block + 1) * XFindIndex::BlockRows);
+        if (d.index.mayContain(block, d.hashes)) {
+            for (int r = d.matchedRows; r < end; ++r) {
+                for (int c = 0; c < columns; ++c) {
+                    if (model->index(r, c).data().toString().contains(d.pattern, Qt::CaseInsensitive)) {
+                        d.matches << Match{r, c};
+                    }
+                }
+            }
+        }
+        d.matchedRows = end;
+    }
+
+    if (d.matchedRows < indexed) {
+        d.timer.start();
+    }
+
+    // jump to the first match while typing
+    if (!hadMatches && !d.matches.isEmpty()) {
+        findNext();
+    }
+    updateStatus();
+}
+
+/******************************************************************/
+
+void XFindBar::restartMatching()
+{
+    d.matches.clear();
+    d.matchedRows = 0;
+    d.current = -1;
+    if (!d.pattern.isEmpty()) {
+        d.timer.start();
+    } else {
+        d.timer.stop();
+    }
+    updateStatus();
+}
+
+/******************************************************************/
+
+void XFindBar::setupUI()
+{
+    ui_Text = new QLineEdit(this);
+    ui_Text->setPlaceholderText(tr("Find in results"));
+    ui_Text->setClearButtonEnabled(true);
+
+    auto prevButton = new QToolButton(this);
+    prevButton->setIcon(QIcon::fromTheme("go-up"));
+    prevButton->setToolTip(tr("Previous match (Shift+F3)"));
+    prevButton->setAutoRaise(true);
+
+    auto nextButton = new QToolButton(this);
+    nextButton->setIcon(QIcon::fromTheme("go-down"));
+    nextButton->setToolTip(tr("Next match (F3)"));
+    nextButton->setAutoRaise(true);
+
+    ui_Status = new QLabel(this);
+
+    auto closeButton = new QToolButton(this);
+    closeButton->setIcon(QIcon::fromTheme("window-close"));
+    closeButton->setToolTip(tr("Close (Esc)"));
+    closeButton->setAutoRaise(true);
+
+    auto layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(new QLabel(tr("Find:"), this));
+    layout->addWidget(ui_Text);
+    layout->addWidget(prevButton);
+    layout->addWidget(nextButton);
+    layout->addWidget(ui_Status);
+    layout->addStretch();
+    layout->addWidget(closeButton);
+
+    connect(ui_Text, &QLineEdit::textChanged,
+            this, &XFindBar::setPattern);
+    connect(ui_Text, &QLineEdit::returnPressed, this, [this](){
+        if (QApplication::keyboardModifiers() & Qt::ShiftModifier) {
+            findPrevious();
+        } else {
+            findNext();
+        }
+    });
+    connect(prevButton, &QToolButton::clicked,
+            this, &XFindBar::findPrevious);
+    connect(nextButton, &QToolButton::clicked,
+            this, &XFindBar::findNext);
+    connect(closeButton, &QToolButton::clicked,
+            this, &XFindBar::deactivate);
+}
+
+/******************************************************************/
+
+void XFindBar::selectMatch(int idx)
+{
+    const Match &match = d.matches.at(idx);
+    const QModelIndex index = d.view->model()->index(match.row, match.column);
+    d.current = idx;
+    d.view->setCurrentIndex(index);
+    d.view->scrollTo(index, QAbstractItemView::PositionAtCenter);
+    updateStatus();
+}
+
+/******************************************************************/
+
+void XFindBar::updateStatus()
+{
+    if (d.pattern.isEmpty() || !d.index.model()) {
+        ui_Status->clear();
+        return;
+    }
+
+    QString text = d.current >= 0
+            ? tr("%1 of %2").arg(d.current + 1).arg(d.matches.size())
+            : tr("%1 matches").arg(d.matches.size());
+
+    const int rows = d.index.model()->rowCount();
+    if (d.matchedRows < rows) {
+        text += tr(", searched %1 of %2 rows").arg(d.matchedRows).arg(rows);
+    }
+    ui_Status->setText(text);
+}
+
+/******************************************************************/
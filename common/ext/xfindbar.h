@@ -0,0 +1,78 @@
+#ifndef XFINDBAR_H
+#define XFINDBAR_H
+
+#include "xfindindex.h"
+
+#include <QWidget>
+
+QT_BEGIN_NAMESPACE
+class QTableView;
+class QLineEdit;
+class QLabel;
+QT_END_NAMESPACE
+
+class XFindDelegate;
+
+/******************************************************************/
+/**
+ * @brief Incremental find bar for a table view
+ *
+ * Matching runs in time slices over the blocks of XFindIndex that may
+ * contain the pattern and follows the index while it is still filling.
+ * Matching cells are highlighted by XFindDelegate, the model is not copied.
+ * Ctrl+F on the view opens the bar, Enter/F3 and Shift+Enter/Shift+F3
+ * move to the next and previous match, Esc closes it.
+ */
+class XFindBar : public QWidget
+{
+    Q_OBJECT
+
+    struct Match {
+        int row;
+        int column;
+        bool operator<(const Match &other) const {
+            return row < other.row || (row == other.row && column < other.column);
+        }
+    };
+
+    struct XFindBarPrivate {
+        QTableView    *view = Q_NULLPTR;
+        XFindDelegate *delegate = Q_NULLPTR;
+        XFindIndex     index;
+        QString        pattern;
+        QVector<uint>  hashes;       ///< trigrams of the pattern
+        QVector<Match> matches;      ///< in row major order
+        int            matchedRows = 0;
+        int            current = -1;
+        QTimer         timer;
+    };
+
+public:
+    explicit XFindBar(QTableView *view, QWidget *parent = Q_NULLPTR);
+
+public Q_SLOTS:
+    void activate();
+    void findNext();
+    void findPrevious();
+    void deactivate();
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+
+private Q_SLOTS:
+    void setPattern(const QString &pattern);
+    void matchNext();
+    void restartMatching();
+
+private:
+    void setupUI();
+    void selectMatch(int idx);
+    void updateStatus();
+
+private:
+    QLineEdit *ui_Text;
+    QLabel    *ui_Status;
+    XFindBarPrivate d;
+};
+
+#endif // XFINDBAR_H
@@ -0,0 +1,35 @@
+#ifndef XFINDDELEGATE_H
+#define XFINDDELEGATE_H
+
+#include "xformatdelegate.h"
+
+/// highlights cells containing the find pattern while they are painted,
+/// the raw value is matched like XFindBar and XFindIndex do, not the formatted text
+class XFindDelegate : public XFormatDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit XFindDelegate(QObject *parent = Q_NULLPTR) : XFormatDelegate(parent) {}
+
+    QString pattern() const {
+        return m_Pattern;
+    }
+
+    void setPattern(const QString &pattern) {
+        m_Pattern = pattern;
+    }
+
+protected:
+    void initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const override {
+        XFormatDelegate::initStyleOption(option, index);
+        if (!m_Pattern.isEmpty() && index.data().toString().contains(m_Pattern, Qt::CaseInsensitive)) {
+            option->backgroundBrush = QColor(255, 230, 120);
+        }
+    }
+
+private:
+    QString m_Pattern;
+};
+
+#endif // XFINDDELEGATE_H
@@ -0,0 +1,261 @@
+#include "xfindindex.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+
+/******************************************************************/
+
+static inline uint trigramHash(const QChar *p)
+{
+    return qHash((quint64(p[0].unicode()) << 32) | (quint64(p[1].unicode()) << 16) | p[2].unicode());
+}
+
+/******************************************************************/
+
+XFindIndex::XFindIndex(QObject *parent)
+    : QObject(parent)
+{
+    d.timer.setSingleShot(true);
+    d.timer.setInterval(0);
+    connect(&d.timer, &QTimer::timeout,
+            this, &XFindIndex::indexNext);
+    connect(&d.watcher, &QFutureWatcher<Signatures>::finished,
+            this, &XFindIndex::sliceIndexed);
+}
+
+/******************************************************************/
+
+XFindIndex::~XFindIndex()
+{
+    d.watcher.waitForFinished();
+}
+
+/******************************************************************/
+
+void XFindIndex::setModel(QAbstractItemModel *model)
+{
+    if (d.model == model) return;
+
+    if (d.model) {
+        disconnect(d.model, Q_NULLPTR, this, Q_NULLPTR);
+    }
+    d.model = model;
+
+    if (model) {
+        connect(model, &QAbstractItemModel::modelReset,
+                this, &XFindIndex::restart);
+        connect(model, &QAbstractItemModel::layoutChanged,
+                this, &XFindIndex::restart);
+        connect(model, &QAbstractItemModel::rowsRemoved,
+                this, &XFindIndex::restart);
+        connect(model, &QAbstractItemModel::rowsMoved,
+                this, &XFindIndex::restart);
+        connect(model, &QAbstractItemModel::columnsInserted,
+                this, &XFindIndex::restart);
+        connect(model, &QAbstractItemModel::columnsRemoved,
+                this, &XFindIndex::restart);
+        connect(model, &QAbstractItemModel::rowsInserted,
+                this, &XFindIndex::rowsAdded);
+        connect(model, &QAbstractItemModel::dataChanged,
+                this, &XFindIndex::cellsChanged);
+    }
+
+    restart();
+}
+
+/******************************************************************/
+
+bool XFindIndex::isComplete() const
+{
+    if (!d.model) return true;
+    return !d.watcher.isRunning() && d.indexedRows >= d.model->rowCount();
+}
+
+/******************************************************************/
+
+bool XFindIndex::mayContain(int block, const QVector<uint> &hashes) const
+{
+    if (block >= d.signatures.size() || d.dirty.contains(block)
+            || std::binary_search(d.pendingBlocks.constBegin(), d.pendingBlocks.constEnd(), block)) {
+        return true;
+    }
+
+    const QBitArray &bits = d.signatures.at(block);
+    const uint mask = uint(bits.size() - 1);
+    for (uint hash : hashes) {
+        if (!bits.testBit(int(hash & mask))) return false;
+    }
+    return true;
+}
+
+/******************************************************************/
+
+QVector<uint> XFindIndex::trigrams(const QString &pattern)
+{
+    const QString folded = pattern.toCaseFolded();
+    QVector<uint> result;
+    for (int i = 0; i + 2 < folded.size(); ++i) {
+        result << trigramHash(folded.constData() + i);
+    }
+    return result;
+}
+
+/******************************************************************/
+
+void XFindIndex::restart()
+{
+    ++d.generation;
+    d.signatures.clear();
+    d.dirty.clear();
+    d.indexedRows = 0;
+    emit restarted();
+
+    if (d.model) {
+        d.timer.start();
+    } else {
+        d.timer.stop();
+    }
+}
+
+/******************************************************************/
+//! reads the next slice of cell texts and hashes it on the thread pool, changed blocks go first
+void XFindIndex::indexNext()
+{
+    if (!d.model || d.watcher.isRunning()) return;
+
+    const int rows = d.model->rowCount();
+    const int columns = d.model->columnCount();
+    QVector<QStringList> blocks;
+
+    d.pendingBlocks.clear();
+    for (int block : qAsConst(d.dirty)) {
+        if (block < d.signatures.size()) {
+            d.pendingBlocks << block;
+        }
+    }
+    d.dirty.clear();
+    if (!d.pendingBlocks.isEmpty()) {
+        std::sort(d.pendingBlocks.begin(), d.pendingBlocks.end());
+        for (int block : qAsConst(d.pendingBlocks)) {
+            const int first = block * BlockRows;
+            blocks << cells(first, qMin(rows, first + BlockRows), columns);
+        }
+        d.pendingGeneration = d.generation;
+        d.watcher.setFuture(QtConcurrent::run(&XFindIndex::sign, blocks));
+        return;
+    }
+
+    // the last block may have been partial
+    const int start = d.indexedRows / BlockRows * BlockRows;
+    const int end = qMin(rows, start + SliceRows);
+    if (start >= end) return;
+    d.signatures.resize(start / BlockRows);
+
+    for (int first = start; first < end; first += BlockRows) {
+        blocks << cells(first, qMin(end, first + BlockRows), columns);
+    }
+
+    d.pendingRows = end;
+    d.pendingGeneration = d.generation;
+    d.watcher.setFuture(QtConcurrent::run(&XFindIndex::sign, blocks));
+}
+
+/******************************************************************/
+
+void XFindIndex::sliceIndexed()
+{
+    if (d.pendingGeneration == d.generation) {
+        const Signatures signatures = d.watcher.result();
+        if (d.pendingBlocks.isEmpty()) {
+            d.signatures += signatures;
+            d.indexedRows = d.pendingRows;
+            emit progress(d.indexedRows);
+        } else {
+            for (int i = 0; i < d.pendingBlocks.size(); ++i) {
+                d.signatures[d.pendingBlocks.at(i)] = signatures.at(i);
+            }
+        }
+    }
+    d.pendingBlocks.clear();
+
+    if (d.model && (!d.dirty.isEmpty() || d.indexedRows < d.model->rowCount())) {
+        d.timer.start();
+    }
+}
+
+/******************************************************************/
+
+void XFindIndex::rowsAdded(const QModelIndex &parent, int first)
+{
+    if (parent.isValid()) return;
+
+    if (first < d.indexedRows) {
+        restart();
+    } else if (!d.watcher.isRunning()) {
+        d.timer.start();
+    }
+}
+
+/******************************************************************/
+//! blocks signed or being signed are signed again with the new texts
+void XFindIndex::cellsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    if (topLeft.parent().isValid()) return;
+    if (!roles.isEmpty() && !roles.contains(Qt::DisplayRole)) return;
+
+    const bool slicePending = d.watcher.isRunning() && d.pendingBlocks.isEmpty();
+    const int last = qMin(bottomRight.row(), (slicePending ? d.pendingRows : d.indexedRows) - 1);
+    for (int block = topLeft.row() / BlockRows; block * BlockRows <= last; ++block) {
+        d.dirty.insert(block);
+    }
+    if (!d.dirty.isEmpty() && !d.watcher.isRunning()) {
+        d.timer.start();
+    }
+}
+
+/******************************************************************/
+
+QStringList XFindIndex::cells(int first, int last, int columns) const
+{
+    QStringList result;
+    for (int r = first; r < last; ++r) {
+        for (int c = 0; c < columns; ++c) {
+            result << d.model->index(r, c).data().toString();
+        }
+    }
+    return result;
+}
+
+/******************************************************************/
+//! one bit set per block, about two bits per trigram keep false positives low
+XFindIndex::Signatures XFindIndex::sign(const QVector<QStringList> &blocks)
+{
+    Signatures result;
+    result.reserve(blocks.size());
+
+    QVector<uint> hashes;
+    for (const auto &cells : blocks) {
+        hashes.clear();
+        for (const auto &cell : cells) {
+            const QString folded = cell.toCaseFolded();
+            for (int i = 0; i + 2 < folded.size(); ++i) {
+                hashes << trigramHash(folded.constData() + i);
+            }
+        }
+
+        int size = 64;
+        while (size < hashes.size() * 2) {
+            size *= 2;
+        }
+        QBitArray bits(size);
+        const uint mask = uint(size - 1);
+        for (uint hash : qAsConst(hashes)) {
+            bits.setBit(int(hash & mask));
+        }
+        result << bits;
+    }
+    return result;
+}
+
+/******************************************************************/
@@ -0,0 +1,93 @@
+#ifndef XFINDINDEX_H
+#define XFINDINDEX_H
+
+#include <QObject>
+#include <QPointer>
+#include <QAbstractItemModel>
+#include <QBitArray>
+#include <QVector>
+#include <QSet>
+#include <QTimer>
+#include <QFutureWatcher>
+
+/******************************************************************/
+/**
+ * @brief Trigram signatures of blocks of model rows
+ *
+ * Cell texts are read in slices on the GUI thread, the signatures are
+ * hashed on the thread pool. A signature is a bit set of the case folded
+ * trigrams of all cells of BlockRows rows, so a search only has to look
+ * at the blocks whose signature has every trigram of the pattern.
+ * The index follows rows appended by fetchMore(), signs the blocks of
+ * changed cells again and restarts on resets.
+ */
+class XFindIndex : public QObject
+{
+    Q_OBJECT
+
+    typedef QVector<QBitArray> Signatures;
+
+    struct XFindIndexPrivate {
+        QPointer<QAbstractItemModel> model;
+        Signatures                   signatures;  ///< one per block of rows
+        int                          indexedRows = 0;
+        int                          pendingRows = 0;  ///< end of the slice being hashed
+        int                          generation = 0;   ///< increased on every restart
+        int                          pendingGeneration = 0;
+        QSet<int>                    dirty;          ///< signed blocks whose cells changed
+        QVector<int>                 pendingBlocks;  ///< sorted blocks being signed again, empty for a slice
+        QTimer                       timer;
+        QFutureWatcher<Signatures>   watcher;
+    };
+
+public:
+    enum {
+        BlockRows = 64,
+        SliceRows = 4096
+    };
+
+    explicit XFindIndex(QObject *parent = Q_NULLPTR);
+    ~XFindIndex();
+
+    QAbstractItemModel *model() const {
+        return d.model;
+    }
+
+    /// starts indexing the model, Q_NULLPTR drops the index
+    void setModel(QAbstractItemModel *model);
+
+    int indexedRows() const {
+        return d.indexedRows;
+    }
+
+    bool isComplete() const;
+
+    /// false if no row of the block can contain the pattern of the hashes
+    bool mayContain(int block, const QVector<uint> &hashes) const;
+
+public: // static
+    /// trigram hashes of the pattern, empty if it is shorter than a trigram
+    static QVector<uint> trigrams(const QString &pattern);
+
+Q_SIGNALS:
+    void progress(int indexedRows);
+    void restarted();
+
+private Q_SLOTS:
+    void restart();
+    void indexNext();
+    void sliceIndexed();
+    void rowsAdded(const QModelIndex &parent, int first);
+    void cellsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+
+private:
+    QStringList cells(int first, int last, int columns) const;
+
+private: // static
+    static Signatures sign(const QVector<QStringList> &blocks);
+
+private:
+    XFindIndexPrivate d;
+};
+
+#endif // XFINDINDEX_H
@@ -0,0 +1,94 @@
+#include "xformatdelegate.h"
+
+/******************************************************************/
+
+XFormatDelegate::XFormatDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+/******************************************************************/
+
+void XFormatDelegate::setFormatters(const QAbstractItemModel *model, const QVector<XColumnFormatter> &formatters)
+{
+    if (m_Model != model) {
+        if (m_Model) {
+            disconnect(m_Model, Q_NULLPTR, this, Q_NULLPTR);
+        }
+        m_Model = model;
+        if (model) {
+            // cached texts are stored by row and column
+            connect(model, &QAbstractItemModel::modelReset, this, &XFormatDelegate::clearCache);
+            connect(model, &QAbstractItemModel::layoutChanged, this, &XFormatDelegate::clearCache);
+            connect(model, &QAbstractItemModel::dataChanged, this, &XFormatDelegate::clearCache);
+            connect(model, &QAbstractItemModel::rowsInserted, this, &XFormatDelegate::clearCache);
+            connect(model, &QAbstractItemModel::rowsRemoved, this, &XFormatDelegate::clearCache);
+            connect(model, &QAbstractItemModel::columnsInserted, this, &XFormatDelegate::clearCache);
+            connect(model, &QAbstractItemModel::columnsRemoved, this, &XFormatDelegate::clearCache);
+        }
+    }
+    m_Formatters = formatters;
+    clearCache();
+}
+
+/******************************************************************/
+
+void XFormatDelegate::clearCache()
+{
+    m_Cache.clear();
+}
+
+/******************************************************************/
+//! like QStyledItemDelegate::initStyleOption, but the display text of formatted columns comes from the cache
+void XFormatDelegate::initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const
+{
+    const int column = index.column();
+    if (index.model() != m_Model || column >= m_Formatters.size()
+            || m_Formatters.at(column).kind() == XColumnFormatter::Text) {
+        QStyledItemDelegate::initStyleOption(option, index);
+        return;
+    }
+    const XColumnFormatter &formatter = m_Formatters.at(column);
+
+    QVariant value = index.data(Qt::FontRole);
+    if (value.isValid() && !value.isNull()) {
+        option->font = qvariant_cast<QFont>(value).resolve(option->font);
+        option->fontMetrics = QFontMetrics(option->font);
+    }
+
+    value = index.data(Qt::TextAlignmentRole);
+    option->displayAlignment = value.isValid() && !value.isNull()
+            ? Qt::Alignment(value.toInt())
+            : formatter.alignment();
+
+    value = index.data(Qt::ForegroundRole);
+    if (value.canConvert<QBrush>()) {
+        option->palette.setBrush(QPalette::Text, qvariant_cast<QBrush>(value));
+    }
+
+    option->index = index;
+
+    value = index.data(Qt::CheckStateRole);
+    if (value.isValid() && !value.isNull()) {
+        option->features |= QStyleOptionViewItem::HasCheckIndicator;
+        option->checkState = static_cast<Qt::CheckState>(value.toInt());
+    }
+
+    const quint64 key = (quint64(quint32(index.row())) << 32) | quint32(column);
+    auto it = m_Cache.constFind(key);
+    if (it == m_Cache.constEnd()) {
+        if (m_Cache.size() >= CacheLimit) {
+            m_Cache.clear();
+        }
+        it = m_Cache.insert(key, formatter.format(index.data(Qt::DisplayRole)));
+    }
+    if (!it.value().isNull()) {
+        option->features |= QStyleOptionViewItem::HasDisplay;
+        option->text = it.value();
+    }
+
+    option->backgroundBrush = qvariant_cast<QBrush>(index.data(Qt::BackgroundRole));
+    option->styleObject = Q_NULLPTR;
+}
+
+/******************************************************************/
@@ -0,0 +1,47 @@
+#ifndef XFORMATDELEGATE_H
+#define XFORMATDELEGATE_H
+
+#include "xcolumnformatter.h"
+
+#include <QStyledItemDelegate>
+#include <QPointer>
+#include <QVector>
+#include <QHash>
+
+/******************************************************************/
+/**
+ * @brief Item delegate with typed formatters per column
+ *
+ * Display texts of formatted columns are cached by cell, so repainting
+ * a scrolled window reuses the shared strings instead of converting the
+ * values again. The cache is dropped when the model changes and is
+ * bounded to CacheLimit cells. Columns without a formatter are painted
+ * like by QStyledItemDelegate.
+ */
+class XFormatDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    enum {
+        CacheLimit = 16384
+    };
+
+    explicit XFormatDelegate(QObject *parent = Q_NULLPTR);
+
+    /// formatters by column of model, an empty list switches formatting off
+    void setFormatters(const QAbstractItemModel *model, const QVector<XColumnFormatter> &formatters);
+
+public Q_SLOTS:
+    void clearCache();
+
+protected:
+    void initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const override;
+
+private:
+    QPointer<const QAbstractItemModel> m_Model;
+    QVector<XColumnFormatter>          m_Formatters;
+    mutable QHash<quint64, QString>    m_Cache;  ///< (row, column) -> text
+};
+
+#endif // XFORMATDELEGATE_H
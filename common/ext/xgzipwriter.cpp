@@ -0,0 +1,90 @@
+#include "xgzipwriter.h"
+
+#include <QIODevice>
+#include <QCryptographicHash>
+#include <QtEndian>
+
+/******************************************************************/
+
+XGzipWriter::XGzipWriter(QIODevice *device, int level)
+    : m_Device(device)
+    , m_Level(level)
+{
+    m_Block.reserve(BlockSize);
+}
+
+/******************************************************************/
+
+XGzipWriter::~XGzipWriter()
+{
+    close();
+}
+
+/******************************************************************/
+
+bool XGzipWriter::write(const QByteArray &data)
+{
+    m_Block.append(data);
+    if (m_Block.size() < BlockSize) return true;
+    return writeMember();
+}
+
+/******************************************************************/
+
+bool XGzipWriter::close()
+{
+    if (m_Block.isEmpty()) return true;
+    return writeMember();
+}
+
+/******************************************************************/
+
+bool XGzipWriter::writeMember()
+{
+    // qCompress() returns the length and a zlib stream, gzip takes the raw deflate data between header and adler32
+    const QByteArray zlib = qCompress(m_Block, m_Level);
+    const int rawSize = zlib.size() - 4 - 2 - 4;
+    if (rawSize < 0) return false;
+
+    static const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\x03'};
+    uchar trailer[8];
+    qToLittleEndian<quint32>(crc32(m_Block), trailer);
+    qToLittleEndian<quint32>(quint32(m_Block.size()), trailer + 4);
+
+    const bool ok = m_Device->write(header, sizeof(header)) == sizeof(header)
+            && m_Device->write(zlib.constData() + 6, rawSize) == rawSize
+            && m_Device->write(reinterpret_cast<const char *>(trailer), sizeof(trailer)) == sizeof(trailer);
+    if (m_Hash) {
+        m_Hash->addData(header, sizeof(header));
+        m_Hash->addData(zlib.constData() + 6, rawSize);
+        m_Hash->addData(reinterpret_cast<const char *>(trailer), sizeof(trailer));
+    }
+    m_Block.clear();
+    return ok;
+}
+
+/******************************************************************/
+
+quint32 XGzipWriter::crc32(const QByteArray &data)
+{
+    static quint32 table[256];
+    static const bool initialized = [](){
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return true;
+    }();
+    Q_UNUSED(initialized)
+
+    quint32 crc = 0xffffffffu;
+    for (const char ch : data) {
+        crc = table[(crc ^ uchar(ch)) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+/******************************************************************/
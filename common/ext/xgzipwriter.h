@@ -0,0 +1,53 @@
+#ifndef XGZIPWRITER_H
+#define XGZIPWRITER_H
+
+#include <QByteArray>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+class QCryptographicHash;
+QT_END_NAMESPACE
+
+/******************************************************************/
+/**
+ * @brief Streaming gzip output to a device
+ *
+ * Written data is collected up to BlockSize bytes and every block is
+ * deflated by qCompress() into a gzip member of its own. Readers of gzip
+ * handle the concatenated members as one file, so memory stays bounded
+ * without linking zlib directly.
+ */
+class XGzipWriter
+{
+public:
+    enum {
+        BlockSize = 1 << 20
+    };
+
+    explicit XGzipWriter(QIODevice *device, int level = 6);
+    ~XGzipWriter();
+
+    bool write(const QByteArray &data);
+
+    /// the compressed output is added to hash as well
+    void setHash(QCryptographicHash *hash) {
+        m_Hash = hash;
+    }
+
+    /// writes the pending block, the device stays open
+    bool close();
+
+private:
+    bool writeMember();
+
+private: // static
+    static quint32 crc32(const QByteArray &data);
+
+private:
+    QIODevice *m_Device;
+    int        m_Level;
+    QByteArray m_Block;
+    QCryptographicHash *m_Hash = Q_NULLPTR;
+};
+
+#endif // XGZIPWRITER_H
@@ -0,0 +1,191 @@
+#include "xselectionstats.h"
+
+#include <QElapsedTimer>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <limits>
+
+enum {
+    DebounceMs = 50,     ///< selections change quickly while dragging
+    SliceMs    = 15,
+    ChunkSize  = 65536   ///< values reduced between checks of the cancel flag
+};
+
+/******************************************************************/
+//! four independent accumulators so the compiler can vectorize the loop
+static void reduceChunk(const double *values, int n, double &sum, double &min, double &max)
+{
+    double s[4] = { 0, 0, 0, 0 };
+    double lo[4] = { min, min, min, min };
+    double hi[4] = { max, max, max, max };
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (int k = 0; k < 4; ++k) {
+            const double v = values[i + k];
+            s[k] += v;
+            lo[k] = v < lo[k] ? v : lo[k];
+            hi[k] = v > hi[k] ? v : hi[k];
+        }
+    }
+    for (; i < n; ++i) {
+        s[0] += values[i];
+        lo[0] = values[i] < lo[0] ? values[i] : lo[0];
+        hi[0] = values[i] > hi[0] ? values[i] : hi[0];
+    }
+
+    sum += (s[0] + s[1]) + (s[2] + s[3]);
+    min = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+    max = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+}
+
+/******************************************************************/
+
+static inline quint64 valueHash(const QString &text)
+{
+    return (quint64(qHash(text, 0)) << 32) | qHash(text, 0x9e3779b9U);
+}
+
+/******************************************************************/
+
+XSelectionStats::XSelectionStats(QObject *parent)
+    : QObject(parent)
+{
+    d.timer.setSingleShot(true);
+    connect(&d.timer, &QTimer::timeout,
+            this, &XSelectionStats::decodeNext);
+    connect(&d.watcher, &QFutureWatcher<Result>::finished,
+            this, &XSelectionStats::reduced);
+}
+
+/******************************************************************/
+
+XSelectionStats::~XSelectionStats()
+{
+    cancel();
+    d.watcher.waitForFinished();
+}
+
+/******************************************************************/
+
+void XSelectionStats::setSelection(QAbstractItemModel *model, const QItemSelection &selection)
+{
+    cancel();
+
+    d.model     = model;
+    d.selection = selection;
+    d.total     = 0;
+    for (const auto &range : selection) {
+        d.total += qint64(range.height()) * range.width();
+    }
+
+    if (!model || d.total < 2) {
+        Result result;
+        result.cells = d.total;
+        emit finished(result);
+        return;
+    }
+
+    d.timer.start(DebounceMs);
+}
+
+/******************************************************************/
+
+void XSelectionStats::cancel()
+{
+    d.timer.stop();
+    if (d.canceled) {
+        d.canceled->storeRelaxed(1);
+        d.canceled.reset();
+    }
+    // a finished signal of the old future is not delivered any more
+    d.watcher.setFuture(QFuture<Result>());
+    d.decoded = Decoded();
+    d.range = 0;
+    d.row   = -1;
+}
+
+/******************************************************************/
+//! reads the selected cells until the time slice is used up
+void XSelectionStats::decodeNext()
+{
+    if (!d.model) return;
+
+    QElapsedTimer budget;
+    budget.start();
+
+    while (d.range < d.selection.size() && budget.elapsed() < SliceMs) {
+        const QItemSelectionRange &range = d.selection.at(d.range);
+        if (d.row < 0) {
+            d.row = range.top();
+        }
+        const QModelIndex parent = range.parent();
+        for (int c = range.left(); c <= range.right(); ++c) {
+            const QVariant value = d.model->index(d.row, c, parent).data();
+            ++d.decoded.cells;
+            const QString text = value.toString();
+            if (value.isNull() || text.isEmpty()) continue;
+
+            d.decoded.hashes.append(valueHash(text));
+            bool ok = false;
+            const double number = value.toDouble(&ok);
+            if (ok) {
+                d.decoded.numbers.append(number);
+            }
+        }
+        if (++d.row > range.bottom()) {
+            ++d.range;
+            d.row = -1;
+        }
+    }
+
+    if (d.range < d.selection.size()) {
+        emit progress(int(d.decoded.cells * 100 / d.total));
+        d.timer.start(0);
+        return;
+    }
+
+    d.canceled = QSharedPointer<QAtomicInt>::create(0);
+    d.watcher.setFuture(QtConcurrent::run(&XSelectionStats::reduce, d.decoded, d.canceled));
+    d.decoded = Decoded();
+}
+
+/******************************************************************/
+
+void XSelectionStats::reduced()
+{
+    d.canceled.reset();
+    emit finished(d.watcher.result());
+}
+
+/******************************************************************/
+
+XSelectionStats::Result XSelectionStats::reduce(const Decoded &decoded, QSharedPointer<QAtomicInt> canceled)
+{
+    Result result;
+    result.cells   = decoded.cells;
+    result.count   = decoded.hashes.size();
+    result.numbers = decoded.numbers.size();
+
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    const double *values = decoded.numbers.constData();
+    for (int first = 0; first < decoded.numbers.size(); first += ChunkSize) {
+        if (canceled->loadRelaxed()) return result;
+        reduceChunk(values + first, qMin(int(ChunkSize), decoded.numbers.size() - first),
+                    result.sum, min, max);
+    }
+    if (result.numbers) {
+        result.min = min;
+        result.max = max;
+    }
+
+    if (canceled->loadRelaxed()) return result;
+    QVector<quint64> hashes = decoded.hashes;
+    std::sort(hashes.begin(), hashes.end());
+    result.distinct = std::unique(hashes.begin(), hashes.end()) - hashes.begin();
+    return result;
+}
+
+/******************************************************************/
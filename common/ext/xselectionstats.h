@@ -0,0 +1,84 @@
+#ifndef XSELECTIONSTATS_H
+#define XSELECTIONSTATS_H
+
+#include <QObject>
+#include <QPointer>
+#include <QAbstractItemModel>
+#include <QItemSelection>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QTimer>
+#include <QFutureWatcher>
+
+/******************************************************************/
+/**
+ * @brief Spreadsheet like aggregates of selected cells
+ *
+ * Selected cells are decoded in time slices on the GUI thread into a
+ * double array of the numeric values and 64 bit hashes of all non null
+ * values; sum, min, max and the distinct count are reduced on the thread
+ * pool. A new selection cancels the running calculation.
+ */
+class XSelectionStats : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Result {
+        qint64 cells    = 0;   ///< selected cells
+        qint64 count    = 0;   ///< non empty cells
+        qint64 numbers  = 0;   ///< numeric cells
+        qint64 distinct = 0;   ///< distinct non empty values
+        double sum      = 0;
+        double min      = 0;
+        double max      = 0;
+
+        double avg() const {
+            return numbers ? sum / numbers : 0;
+        }
+    };
+
+private:
+    struct Decoded {
+        QVector<double>  numbers;
+        QVector<quint64> hashes;
+        qint64           cells = 0;
+    };
+
+    struct XSelectionStatsPrivate {
+        QPointer<QAbstractItemModel> model;
+        QItemSelection               selection;
+        int                          range = 0;  ///< decode position
+        int                          row   = -1;
+        qint64                       total = 0;  ///< cells of the selection
+        Decoded                      decoded;
+        QSharedPointer<QAtomicInt>   canceled;   ///< flag of the running reduction
+        QTimer                       timer;
+        QFutureWatcher<Result>       watcher;
+    };
+
+public:
+    explicit XSelectionStats(QObject *parent = Q_NULLPTR);
+    ~XSelectionStats();
+
+    /// restarts the calculation after a short delay
+    void setSelection(QAbstractItemModel *model, const QItemSelection &selection);
+
+    void cancel();
+
+Q_SIGNALS:
+    void progress(int percent);
+    void finished(const XSelectionStats::Result &result);
+
+private Q_SLOTS:
+    void decodeNext();
+    void reduced();
+
+private: // static
+    static Result reduce(const Decoded &decoded, QSharedPointer<QAtomicInt> canceled);
+
+private:
+    XSelectionStatsPrivate d;
+};
+
+#endif // XSELECTIONSTATS_H
@@ -0,0 +1,801 @@
+#include "xsortfiltermodel.h"
+
+#include <QDateTime>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+/******************************************************************/
+
+namespace {
+
+enum {
+    KindSample        = 100,    ///< non null values checked to detect numeric text
+    ParallelThreshold = 100000  ///< rows below are sorted in the calling thread
+};
+
+enum KeyKind {
+    IntKey,
+    DoubleKey,
+    DateKey,
+    StringKey
+};
+
+enum FilterOp {
+    EqualOp,
+    NotEqualOp,
+    LessOp,
+    LessEqualOp,
+    GreaterOp,
+    GreaterEqualOp
+};
+
+/// typed values of one source column, only the vector of kind is filled
+struct ColumnKeys {
+    KeyKind          kind = StringKey;
+    QVector<qint64>  ints;     ///< integers, dates and timestamps as msecs
+    QVector<double>  doubles;
+    QVector<QString> strings;
+    QBitArray        nulls;
+};
+
+/******************************************************************/
+
+KeyKind keyKind(const QVariant &value)
+{
+    switch (int(value.type())) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::Long:
+    case QMetaType::ULong:
+        return IntKey;
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return DoubleKey;
+    case QMetaType::QDate:
+    case QMetaType::QDateTime:
+        return DateKey;
+    }
+    return StringKey;
+}
+
+/******************************************************************/
+
+qint64 dateKey(const QVariant &value)
+{
+    if (value.type() == QVariant::Date) {
+        return QDateTime(value.toDate(), QTime(0, 0)).toMSecsSinceEpoch();
+    }
+    return value.toDateTime().toMSecsSinceEpoch();
+}
+
+/******************************************************************/
+//! reads one column into a typed vector, numeric text (decimals of some drivers) becomes doubles
+ColumnKeys columnKeys(const QAbstractItemModel *model, int column)
+{
+    const int n = model->rowCount();
+
+    ColumnKeys keys;
+    keys.nulls.resize(n);
+
+    bool kindSet = false;
+    bool numericText = true;
+    int sampled = 0;
+    for (int r = 0; r < n && sampled < KindSample; ++r) {
+        const QVariant value = model->index(r, column).data();
+        if (value.isNull()) continue;
+        if (!kindSet) {
+            keys.kind = keyKind(value);
+            kindSet = true;
+        }
+        if (keys.kind != StringKey) break;
+        bool ok = false;
+        value.toString().toDouble(&ok);
+        numericText = numericText && ok;
+        ++sampled;
+    }
+    if (keys.kind == StringKey && sampled > 0 && numericText) {
+        keys.kind = DoubleKey;
+    }
+
+    switch (keys.kind) {
+    case IntKey:
+    case DateKey:
+        keys.ints.resize(n);
+        break;
+    case DoubleKey:
+        keys.doubles.resize(n);
+        break;
+    case StringKey:
+        keys.strings.resize(n);
+        break;
+    }
+
+    for (int r = 0; r < n; ++r) {
+        const QVariant value = model->index(r, column).data();
+        if (value.isNull()) {
+            keys.nulls.setBit(r);
+            continue;
+        }
+        switch (keys.kind) {
+        case IntKey:
+            keys.ints[r] = value.toLongLong();
+            break;
+        case DateKey:
+            keys.ints[r] = dateKey(value);
+            break;
+        case DoubleKey: {
+            bool ok = false;
+            keys.doubles[r] = value.toDouble(&ok);
+            if (!ok) {
+                // text after the sample is not numeric, compare as strings
+                keys.doubles.clear();
+                keys.strings.resize(n);
+                keys.kind = StringKey;
+                r = -1;
+                keys.nulls.fill(false);
+            }
+        }   break;
+        case StringKey:
+            keys.strings[r] = value.toString();
+            break;
+        }
+    }
+    return keys;
+}
+
+/******************************************************************/
+
+template<typename T>
+inline int keyCompare(const T &a, const T &b)
+{
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+inline int keyCompare(const QString &a, const QString &b)
+{
+    return a.compare(b, Qt::CaseInsensitive);
+}
+
+/******************************************************************/
+/// orders source rows by key, NULLs first, equal keys by source row
+template<typename T>
+struct KeyLess {
+    const T         *values;
+    const QBitArray *nulls;
+    bool             descending;
+
+    bool operator()(int a, int b) const {
+        const bool nullA = nulls->testBit(a);
+        const bool nullB = nulls->testBit(b);
+        if (nullA != nullB) {
+            return descending ? nullB : nullA;
+        }
+        if (!nullA) {
+            const int c = keyCompare(values[a], values[b]);
+            if (c != 0) {
+                return descending ? c > 0 : c < 0;
+            }
+        }
+        return a < b;
+    }
+};
+
+/******************************************************************/
+//! sorts chunks on the thread pool and merges them pairwise
+template<typename T>
+void sortPermutation(QVector<int> &permutation, const QVector<T> &values, const QBitArray &nulls, bool descending)
+{
+    const KeyLess<T> less = { values.constData(), &nulls, descending };
+    int *data = permutation.data();
+    const int n = permutation.size();
+    const int chunks = qMax(1, QThread::idealThreadCount());
+
+    if (n < ParallelThreshold || chunks == 1) {
+        std::sort(data, data + n, less);
+        return;
+    }
+
+    QVector<int> bounds;
+    for (int i = 0; i <= chunks; ++i) {
+        bounds << int(qint64(n) * i / chunks);
+    }
+
+    QList<QFuture<void>> futures;
+    for (int i = 0; i < chunks; ++i) {
+        int *first = data + bounds.at(i);
+        int *last  = data + bounds.at(i + 1);
+        futures << QtConcurrent::run([first, last, less]() {
+            std::sort(first, last, less);
+        });
+    }
+    for (auto &future : futures) {
+        future.waitForFinished();
+    }
+
+    for (int width = 1; width < chunks; width *= 2) {
+        for (int i = 0; i + width < chunks; i += 2 * width) {
+            std::inplace_merge(data + bounds.at(i),
+                               data + bounds.at(i + width),
+                               data + bounds.at(qMin(i + 2 * width, chunks)),
+                               less);
+        }
+    }
+}
+
+/******************************************************************/
+
+template<typename T>
+QBitArray matchBits(const QVector<T> &values, const QBitArray &nulls, FilterOp op, const T &operand)
+{
+    QBitArray bits(values.size());
+    for (int r = 0; r < values.size(); ++r) {
+        if (nulls.testBit(r)) continue;
+        const int c = keyCompare(values.at(r), operand);
+        bool match = false;
+        switch (op) {
+        case EqualOp:        match = c == 0; break;
+        case NotEqualOp:     match = c != 0; break;
+        case LessOp:         match = c <  0; break;
+        case LessEqualOp:    match = c <= 0; break;
+        case GreaterOp:      match = c >  0; break;
+        case GreaterEqualOp: match = c >= 0; break;
+        }
+        if (match) bits.setBit(r);
+    }
+    return bits;
+}
+
+} // namespace
+
+/******************************************************************/
+
+XSortFilterModel::XSortFilterModel(QObject *parent)
+    : QAbstractProxyModel(parent)
+{
+}
+
+/******************************************************************/
+
+void XSortFilterModel::setSourceModel(QAbstractItemModel *model)
+{
+    beginResetModel();
+
+    if (sourceModel()) {
+        disconnect(sourceModel(), Q_NULLPTR, this, Q_NULLPTR);
+    }
+    QAbstractProxyModel::setSourceModel(model);
+
+    d = XSortFilterModelPrivate();
+
+    if (model) {
+        connect(model, &QAbstractItemModel::modelAboutToBeReset,
+                this, &XSortFilterModel::sourceAboutToBeReset);
+        connect(model, &QAbstractItemModel::modelReset,
+                this, &XSortFilterModel::sourceReset);
+        connect(model, &QAbstractItemModel::rowsAboutToBeInserted,
+                this, &XSortFilterModel::sourceRowsAboutToBeInserted);
+        connect(model, &QAbstractItemModel::rowsInserted,
+                this, &XSortFilterModel::sourceRowsInserted);
+        connect(model, &QAbstractItemModel::rowsAboutToBeRemoved,
+                this, &XSortFilterModel::sourceRowsAboutToBeRemoved);
+        connect(model, &QAbstractItemModel::rowsRemoved,
+                this, &XSortFilterModel::sourceRowsRemoved);
+        connect(model, &QAbstractItemModel::rowsAboutToBeMoved,
+                this, &XSortFilterModel::sourceLayoutAboutToBeChanged);
+        connect(model, &QAbstractItemModel::rowsMoved,
+                this, &XSortFilterModel::sourceLayoutChanged);
+        connect(model, &QAbstractItemModel::layoutAboutToBeChanged,
+                this, &XSortFilterModel::sourceLayoutAboutToBeChanged);
+        connect(model, &QAbstractItemModel::layoutChanged,
+                this, &XSortFilterModel::sourceLayoutChanged);
+        connect(model, &QAbstractItemModel::columnsAboutToBeMoved,
+                this, &XSortFilterModel::sourceAboutToBeReset);
+        connect(model, &QAbstractItemModel::columnsMoved,
+                this, &XSortFilterModel::sourceReset);
+        connect(model, &QAbstractItemModel::columnsAboutToBeInserted,
+                this, &XSortFilterModel::sourceAboutToBeReset);
+        connect(model, &QAbstractItemModel::columnsInserted,
+                this, &XSortFilterModel::sourceReset);
+        connect(model, &QAbstractItemModel::columnsAboutToBeRemoved,
+                this, &XSortFilterModel::sourceAboutToBeReset);
+        connect(model, &QAbstractItemModel::columnsRemoved,
+                this, &XSortFilterModel::sourceReset);
+        connect(model, &QAbstractItemModel::dataChanged,
+                this, &XSortFilterModel::sourceDataChanged);
+        connect(model, &QAbstractItemModel::headerDataChanged,
+                this, &XSortFilterModel::sourceHeaderDataChanged);
+    }
+
+    endResetModel();
+}
+
+/******************************************************************/
+
+QModelIndex XSortFilterModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent))
+        return QModelIndex();
+
+    return createIndex(row, column);
+}
+
+/******************************************************************/
+
+QModelIndex XSortFilterModel::parent(const QModelIndex &child) const
+{
+    Q_UNUSED(child)
+    return QModelIndex();
+}
+
+/******************************************************************/
+
+int XSortFilterModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !sourceModel())
+        return 0;
+
+    return isIdentity() ? sourceModel()->rowCount() : d.rows.size();
+}
+
+/******************************************************************/
+
+int XSortFilterModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !sourceModel())
+        return 0;
+
+    return sourceModel()->columnCount();
+}
+
+/******************************************************************/
+
+QModelIndex XSortFilterModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid() || !sourceModel())
+        return QModelIndex();
+
+    return sourceModel()->index(sourceRow(proxyIndex.row()), proxyIndex.column());
+}
+
+/******************************************************************/
+
+QModelIndex XSortFilterModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid())
+        return QModelIndex();
+
+    if (isIdentity())
+        return index(sourceIndex.row(), sourceIndex.column());
+
+    const int row = d.proxyRows.value(sourceIndex.row(), -1);
+    if (row < 0)
+        return QModelIndex();
+
+    return index(row, sourceIndex.column());
+}
+
+/******************************************************************/
+
+QVariant XSortFilterModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (!sourceModel())
+        return QVariant();
+
+    if (orientation == Qt::Horizontal) {
+        QVariant result = sourceModel()->headerData(section, orientation, role);
+        if (d.filters.contains(section)) {
+            if (role == Qt::DisplayRole) {
+                return QString("%1 [%2]").arg(result.toString(), d.filters.value(section));
+            }
+            if (role == Qt::ToolTipRole) {
+                return tr("Filter: %1").arg(d.filters.value(section));
+            }
+        }
+        return result;
+    }
+
+    if (role == Qt::DisplayRole) {
+        return sourceRow(section) + 1;
+    }
+    return QVariant();
+}
+
+/******************************************************************/
+
+bool XSortFilterModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !sourceModel() || !isIdentity())
+        return false;
+
+    return sourceModel()->canFetchMore(QModelIndex());
+}
+
+/******************************************************************/
+
+void XSortFilterModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || !sourceModel() || !isIdentity())
+        return;
+
+    sourceModel()->fetchMore(QModelIndex());
+}
+
+/******************************************************************/
+
+void XSortFilterModel::sort(int column, Qt::SortOrder order)
+{
+    if (!sourceModel()) return;
+    if (column >= sourceModel()->columnCount()) {
+        column = -1;
+    }
+    if (column < 0 && d.sortColumn < 0) return;
+    if (column == d.sortColumn && order == d.sortOrder) return;
+
+    fetchAll();
+
+    emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+    const QModelIndexList persistent = persistentIndexList();
+    QModelIndexList sources;
+    for (const auto &idx : persistent) {
+        sources << mapToSource(idx);
+    }
+
+    d.sortColumn = column;
+    d.sortOrder  = order;
+    updateSort();
+    updateMapping();
+
+    QModelIndexList updated;
+    for (const auto &idx : qAsConst(sources)) {
+        updated << mapFromSource(idx);
+    }
+    changePersistentIndexList(persistent, updated);
+    emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+}
+
+/******************************************************************/
+
+void XSortFilterModel::setFilter(int column, const QString &predicate)
+{
+    if (!sourceModel()) return;
+
+    fetchAll();
+
+    QBitArray bitmap;
+    if (!predicate.trimmed().isEmpty()) {
+        bitmap = evaluate(column, predicate);
+    }
+
+    emit layoutAboutToBeChanged();
+    const QModelIndexList persistent = persistentIndexList();
+    QModelIndexList sources;
+    for (const auto &idx : persistent) {
+        sources << mapToSource(idx);
+    }
+
+    if (predicate.trimmed().isEmpty()) {
+        d.filters.remove(column);
+        d.bitmaps.remove(column);
+    } else {
+        d.filters.insert(column, predicate.trimmed());
+        d.bitmaps.insert(column, bitmap);
+    }
+    updateMapping();
+
+    QModelIndexList updated;
+    for (const auto &idx : qAsConst(sources)) {
+        updated << mapFromSource(idx);
+    }
+    changePersistentIndexList(persistent, updated);
+    emit layoutChanged();
+    emit headerDataChanged(Qt::Horizontal, column, column);
+}
+
+/******************************************************************/
+
+void XSortFilterModel::clearFilters()
+{
+    if (d.filters.isEmpty()) return;
+
+    beginResetModel();
+    d.filters.clear();
+    d.bitmaps.clear();
+    updateMapping();
+    endResetModel();
+}
+
+/******************************************************************/
+
+int XSortFilterModel::sourceRow(int row) const
+{
+    if (isIdentity()) return row;
+    return d.rows.value(row, -1);
+}
+
+/******************************************************************/
+
+void XSortFilterModel::sourceAboutToBeReset()
+{
+    beginResetModel();
+}
+
+/******************************************************************/
+
+void XSortFilterModel::sourceReset()
+{
+    d = XSortFilterModelPrivate();
+    endResetModel();
+}
+
+/******************************************************************/
+
+void XSortFilterModel::sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) return;
+
+    if (isIdentity()) {
+        beginInsertRows(QModelIndex(), first, last);
+    } else {
+        beginResetModel();
+    }
+}
+
+/******************************************************************/
+
+void XSortFilterModel::sourceRowsInserted()
+{
+    if (isIdentity()) {
+        endInsertRows();
+        return;
+    }
+
+    // new rows must be sorted in and filtered
+    updateAll();
+    endResetModel();
+}
+
+/******************************************************************/
+
+void XSortFilterModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) return;
+
+    if (isIdentity()) {
+        beginRemoveRows(QModelIndex(), first, last);
+    } else {
+        beginResetModel();
+    }
+}
+
+/******************************************************************/
+
+void XSortFilterModel::sourceRowsRemoved()
+{
+    if (isIdentity()) {
+        endRemoveRows();
+        return;
+    }
+
+    updateAll();
+    endResetModel();
+}
+
+/******************************************************************/
+//! the source indexes of the persistent indexes are moved along by the source
+void XSortFilterModel::sourceLayoutAboutToBeChanged()
+{
+    emit layoutAboutToBeChanged();
+    d.layoutIndexes = persistentIndexList();
+    d.layoutSources.clear();
+    for (const auto &idx : qAsConst(d.layoutIndexes)) {
+        d.layoutSources << QPersistentModelIndex(mapToSource(idx));
+    }
+}
+
+/******************************************************************/
+
+void XSortFilterModel::sourceLayoutChanged()
+{
+    // sort permutation and filter bitmaps are indexed by source rows
+    if (!isIdentity()) {
+        updateAll();
+    }
+
+    QModelIndexList updated;
+    for (const auto &idx : qAsConst(d.layoutSources)) {
+        updated << mapFromSource(idx);
+    }
+    changePersistentIndexList(d.layoutIndexes, updated);
+    d.layoutIndexes.clear();
+    d.layoutSources.clear();
+    emit layoutChanged();
+}
+
+/******************************************************************/
+
+void XSortFilterModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    if (isIdentity()) {
+        emit dataChanged(mapFromSource(topLeft), mapFromSource(bottomRight), roles);
+        return;
+    }
+
+    for (int r = topLeft.row(); r <= bottomRight.row(); ++r) {
+        const int row = d.proxyRows.value(r, -1);
+        if (row < 0) continue;
+        emit dataChanged(index(row, topLeft.column()), index(row, bottomRight.column()), roles);
+    }
+}
+
+/******************************************************************/
+
+void XSortFilterModel::sourceHeaderDataChanged(Qt::Orientation orientation, int first, int last)
+{
+    if (orientation == Qt::Horizontal) {
+        emit headerDataChanged(orientation, first, last);
+    } else {
+        emit headerDataChanged(orientation, 0, rowCount() - 1);
+    }
+}
+
+/******************************************************************/
+
+void XSortFilterModel::fetchAll()
+{
+    while (sourceModel()->canFetchMore(QModelIndex())) {
+        sourceModel()->fetchMore(QModelIndex());
+    }
+}
+
+/******************************************************************/
+
+void XSortFilterModel::updateSort()
+{
+    d.permutation.clear();
+    if (d.sortColumn < 0) return;
+
+    const ColumnKeys keys = columnKeys(sourceModel(), d.sortColumn);
+    const int n = keys.nulls.size();
+    d.permutation.resize(n);
+    for (int r = 0; r < n; ++r) {
+        d.permutation[r] = r;
+    }
+
+    const bool descending = d.sortOrder == Qt::DescendingOrder;
+    switch (keys.kind) {
+    case IntKey:
+    case DateKey:
+        sortPermutation(d.permutation, keys.ints, keys.nulls, descending);
+        break;
+    case DoubleKey:
+        sortPermutation(d.permutation, keys.doubles, keys.nulls, descending);
+        break;
+    case StringKey:
+        sortPermutation(d.permutation, keys.strings, keys.nulls, descending);
+        break;
+    }
+}
+
+/******************************************************************/
+
+void XSortFilterModel::updateMapping()
+{
+    d.rows.clear();
+    d.proxyRows.clear();
+    if (isIdentity()) return;
+
+    const int n = sourceModel()->rowCount();
+    QBitArray mask(n, true);
+    for (const auto &bitmap : qAsConst(d.bitmaps)) {
+        if (bitmap.size() == n) {
+            mask &= bitmap;
+        }
+    }
+
+    d.rows.reserve(mask.count(true));
+    if (d.permutation.size() == n) {
+        for (int r : qAsConst(d.permutation)) {
+            if (mask.testBit(r)) d.rows.append(r);
+        }
+    } else {
+        for (int r = 0; r < n; ++r) {
+            if (mask.testBit(r)) d.rows.append(r);
+        }
+    }
+
+    d.proxyRows.fill(-1, n);
+    for (int i = 0; i < d.rows.size(); ++i) {
+        d.proxyRows[d.rows.at(i)] = i;
+    }
+}
+
+/******************************************************************/
+//! sorts and filters all source rows again
+void XSortFilterModel::updateAll()
+{
+    updateSort();
+    for (auto it = d.filters.constBegin(); it != d.filters.constEnd(); ++it) {
+        d.bitmaps.insert(it.key(), evaluate(it.key(), it.value()));
+    }
+    updateMapping();
+}
+
+/******************************************************************/
+
+QBitArray XSortFilterModel::evaluate(int column, const QString &predicate) const
+{
+    const QAbstractItemModel *model = sourceModel();
+    const int n = model->rowCount();
+    const QString text = predicate.trimmed();
+
+    if (text.compare("null", Qt::CaseInsensitive) == 0 || text.compare("!null", Qt::CaseInsensitive) == 0) {
+        const bool isNull = !text.startsWith('!');
+        QBitArray bits(n);
+        for (int r = 0; r < n; ++r) {
+            if (model->index(r, column).data().isNull() == isNull) bits.setBit(r);
+        }
+        return bits;
+    }
+
+    static const QStringList ops = QStringList() << "!=" << ">=" << "<=" << "=" << ">" << "<";
+    static const FilterOp codes[] = { NotEqualOp, GreaterEqualOp, LessEqualOp, EqualOp, GreaterOp, LessOp };
+
+    int opIdx = -1;
+    for (int i = 0; i < ops.size(); ++i) {
+        if (text.startsWith(ops.at(i))) {
+            opIdx = i;
+            break;
+        }
+    }
+
+    if (opIdx < 0) {
+        QBitArray bits(n);
+        for (int r = 0; r < n; ++r) {
+            if (model->index(r, column).data().toString().contains(text, Qt::CaseInsensitive)) bits.setBit(r);
+        }
+        return bits;
+    }
+
+    const FilterOp op = codes[opIdx];
+    const QString operand = text.mid(ops.at(opIdx).size()).trimmed();
+    const ColumnKeys keys = columnKeys(model, column);
+    bool ok = true;
+
+    switch (keys.kind) {
+    case IntKey: {
+        const qint64 value = operand.toLongLong(&ok);
+        if (ok) {
+            return matchBits(keys.ints, keys.nulls, op, value);
+        }
+        QVector<double> doubles(keys.ints.size());
+        for (int r = 0; r < keys.ints.size(); ++r) {
+            doubles[r] = double(keys.ints.at(r));
+        }
+        const double fraction = operand.toDouble(&ok);
+        return ok ? matchBits(doubles, keys.nulls, op, fraction) : QBitArray(n);
+    }
+    case DoubleKey: {
+        const double value = operand.toDouble(&ok);
+        return ok ? matchBits(keys.doubles, keys.nulls, op, value) : QBitArray(n);
+    }
+    case DateKey: {
+        QDateTime value = QDateTime::fromString(operand, Qt::ISODate);
+        if (!value.isValid()) {
+            value = QDateTime(QDate::fromString(operand, Qt::ISODate), QTime(0, 0));
+        }
+        return value.isValid() ? matchBits(keys.ints, keys.nulls, op, value.toMSecsSinceEpoch()) : QBitArray(n);
+    }
+    case StringKey:
+        return matchBits(keys.strings, keys.nulls, op, operand);
+    }
+    return QBitArray(n);
+}
+
+/******************************************************************/
@@ -0,0 +1,112 @@
+#ifndef XSORTFILTERMODEL_H
+#define XSORTFILTERMODEL_H
+
+#include <QAbstractProxyModel>
+#include <QBitArray>
+#include <QVector>
+#include <QMap>
+
+/******************************************************************/
+/**
+ * @brief Sort and filter proxy over flat table models
+ *
+ * Unlike QSortFilterProxyModel no per row mapping objects are kept:
+ * sorting produces a permutation vector of source rows from typed keys
+ * (integers, doubles, dates as msecs, strings) and every column filter
+ * is a bitmap over source rows. Bitmaps are combined with AND, so
+ * changing one filter only evaluates that column again.
+ *
+ * Without sort and filters the proxy maps rows one to one and keeps the
+ * lazy fetching of the source model; otherwise all rows are fetched.
+ * A layout change or row move of the source sorts and filters the rows
+ * again and is passed on as a layout change of the proxy.
+ */
+class XSortFilterModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+    struct XSortFilterModelPrivate {
+        QVector<int>         rows;        ///< proxy row -> source row, empty in identity mode
+        QVector<int>         proxyRows;   ///< source row -> proxy row or -1
+        QVector<int>         permutation; ///< sorted source rows, empty if not sorted
+        QMap<int, QString>   filters;     ///< column -> predicate
+        QMap<int, QBitArray> bitmaps;     ///< column -> matching source rows
+        int                  sortColumn = -1;
+        Qt::SortOrder        sortOrder  = Qt::AscendingOrder;
+        QModelIndexList      layoutIndexes; ///< persistent proxy indexes during a source layout change
+        QList<QPersistentModelIndex> layoutSources; ///< their source indexes, moved along by the source
+    };
+
+public:
+    explicit XSortFilterModel(QObject *parent = Q_NULLPTR);
+
+    void setSourceModel(QAbstractItemModel *model) override;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    int sortColumn() const {
+        return d.sortColumn;
+    }
+
+    /**
+     * @brief Sets the filter of a column, an empty predicate removes it
+     *
+     * "text" matches values containing text (case insensitive),
+     * "=v", "!=v", "<v", "<=v", ">v", ">=v" compare typed values,
+     * "null" and "!null" test for NULL.
+     */
+    void setFilter(int column, const QString &predicate);
+
+    QString filter(int column) const {
+        return d.filters.value(column);
+    }
+
+    bool hasFilters() const {
+        return !d.filters.isEmpty();
+    }
+
+    void clearFilters();
+
+    int sourceRow(int row) const;
+
+private Q_SLOTS:
+    void sourceAboutToBeReset();
+    void sourceReset();
+    void sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsInserted();
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved();
+    void sourceLayoutAboutToBeChanged();
+    void sourceLayoutChanged();
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void sourceHeaderDataChanged(Qt::Orientation orientation, int first, int last);
+
+private:
+    bool isIdentity() const {
+        return d.sortColumn < 0 && d.filters.isEmpty();
+    }
+
+    void fetchAll();
+    void updateSort();
+    void updateMapping();
+    void updateAll();
+    QBitArray evaluate(int column, const QString &predicate) const;
+
+private:
+    XSortFilterModelPrivate d;
+};
+
+#endif // XSORTFILTERMODEL_H
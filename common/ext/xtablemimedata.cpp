@@ -0,0 +1,275 @@
+#include "xtablemimedata.h"
+
+#include <climits>
+
+/******************************************************************/
+
+XTableMimeData::XTableMimeData(QAbstractItemModel *model, const QItemSelection &selection)
+    : m_Model(model)
+{
+    for (const auto &range : selection) {
+        m_Ranges << range;
+        m_LastRow = qMax(m_LastRow, range.bottom());
+        for (int c = range.left(); c <= range.right(); ++c) {
+            if (!m_Headers.contains(c)) {
+                m_Headers.insert(c, model->headerData(c, Qt::Horizontal).toString());
+            }
+        }
+    }
+
+    // the copied rows must be read before they move or disappear
+    connect(model, &QAbstractItemModel::modelAboutToBeReset,
+            this, &XTableMimeData::takeSnapshot);
+    connect(model, &QAbstractItemModel::layoutAboutToBeChanged,
+            this, &XTableMimeData::takeSnapshot);
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &XTableMimeData::takeSnapshot);
+    connect(model, &QAbstractItemModel::columnsAboutToBeInserted,
+            this, &XTableMimeData::takeSnapshot);
+    connect(model, &QAbstractItemModel::columnsAboutToBeRemoved,
+            this, &XTableMimeData::takeSnapshot);
+    connect(model, &QAbstractItemModel::rowsAboutToBeInserted, this, [this](const QModelIndex &, int first, int){
+        // fetching more rows appends behind the selection
+        if (first <= m_LastRow) {
+            takeSnapshot();
+        }
+    });
+}
+
+/******************************************************************/
+
+void XTableMimeData::setCellText(int row, int column, const QString &text)
+{
+    m_Cells.insert(qMakePair(row, column), text);
+    m_Cached = QByteArray();
+}
+
+/******************************************************************/
+
+QStringList XTableMimeData::formats() const
+{
+    return QStringList() << mimeType(Tsv) << mimeType(Csv) << mimeType(Markdown) << mimeType(Html);
+}
+
+/******************************************************************/
+
+bool XTableMimeData::hasFormat(const QString &mimetype) const
+{
+    return formats().contains(mimetype);
+}
+
+/******************************************************************/
+
+QByteArray XTableMimeData::render(Format format) const
+{
+    qint64 total = 0;
+    for (const auto &range : m_Ranges) {
+        total += range.height();
+    }
+
+    QByteArray out;
+    if (format == Html) {
+        out += "<html><head><meta charset=\"utf-8\"></head><body>\n";
+    }
+
+    int position = 0;
+    int rendered = 0;
+    for (int i = 0; i < m_Ranges.size(); ++i) {
+        const QItemSelectionRange &range = m_Ranges.at(i);
+        if (format == Markdown || format == Html || (format == Csv && i == 0)) {
+            appendHeader(out, format, range.left(), range.right());
+        }
+        for (int r = range.top(); r <= range.bottom(); ++r) {
+            appendRow(out, format, r, range.left(), range.right(), position);
+            // the sample tells how large the whole text will be
+            if (++rendered == SampleRows && total > SampleRows) {
+                out.reserve(int(qMin<qint64>(out.size() * total / SampleRows * 11 / 10, INT_MAX / 2)));
+            }
+        }
+        if (format == Html) {
+            out += "</table>\n";
+        } else if (format == Markdown) {
+            out += '\n';
+        }
+    }
+
+    if (format == Html) {
+        out += "</body></html>\n";
+    }
+    return out;
+}
+
+/******************************************************************/
+
+QVariant XTableMimeData::retrieveData(const QString &mimetype, QVariant::Type preferredType) const
+{
+    Q_UNUSED(preferredType)
+
+    for (Format format : { Tsv, Csv, Markdown, Html }) {
+        if (mimeType(format) != mimetype) continue;
+        // applications often ask for the same format several times
+        if (m_Cached.isNull() || m_CachedFormat != format) {
+            m_Cached = QByteArray();
+            m_Cached = render(format);
+            m_CachedFormat = format;
+        }
+        return m_Cached;
+    }
+    return QVariant();
+}
+
+/******************************************************************/
+
+void XTableMimeData::takeSnapshot()
+{
+    if (!m_Model) return;
+
+    int total = 0;
+    for (const auto &range : qAsConst(m_Ranges)) {
+        total += range.height() * range.width();
+    }
+    QVector<QString> snapshot;
+    snapshot.reserve(total);
+    for (const auto &range : qAsConst(m_Ranges)) {
+        for (int r = range.top(); r <= range.bottom(); ++r) {
+            for (int c = range.left(); c <= range.right(); ++c) {
+                snapshot << cell(r, c, snapshot.size());
+            }
+        }
+    }
+    m_Snapshot = snapshot;
+
+    disconnect(m_Model, Q_NULLPTR, this, Q_NULLPTR);
+    m_Model = Q_NULLPTR;
+}
+
+/******************************************************************/
+
+QString XTableMimeData::cell(int row, int column, int position) const
+{
+    if (m_Model) {
+        const auto it = m_Cells.constFind(qMakePair(row, column));
+        if (it != m_Cells.constEnd()) return it.value();
+        return m_Model->index(row, column).data().toString();
+    }
+    return m_Snapshot.value(position);
+}
+
+/******************************************************************/
+
+void XTableMimeData::appendRow(QByteArray &out, Format format, int row, int left, int right, int &position) const
+{
+    if (format == Markdown) {
+        out += '|';
+    } else if (format == Html) {
+        out += "<tr>";
+    }
+
+    for (int c = left; c <= right; ++c) {
+        const QString text = cell(row, c, position++);
+        switch (format) {
+        case Tsv:
+        case Csv:
+            if (c > left) out += format == Tsv ? '\t' : ',';
+            appendCell(out, format, text);
+            break;
+        case Markdown:
+            out += ' ';
+            appendCell(out, format, text);
+            out += " |";
+            break;
+        case Html:
+            out += "<td>";
+            appendCell(out, format, text);
+            out += "</td>";
+            break;
+        }
+    }
+
+    out += format == Html ? "</tr>\n" : "\n";
+}
+
+/******************************************************************/
+
+void XTableMimeData::appendHeader(QByteArray &out, Format format, int left, int right) const
+{
+    switch (format) {
+    case Tsv:
+        break;
+    case Csv:
+        for (int c = left; c <= right; ++c) {
+            if (c > left) out += ',';
+            appendCell(out, format, m_Headers.value(c));
+        }
+        out += '\n';
+        break;
+    case Markdown:
+        out += '|';
+        for (int c = left; c <= right; ++c) {
+            out += ' ';
+            appendCell(out, format, m_Headers.value(c));
+            out += " |";
+        }
+        out += "\n|";
+        for (int c = left; c <= right; ++c) {
+            out += " --- |";
+        }
+        out += '\n';
+        break;
+    case Html:
+        out += "<table border=\"1\" cellspacing=\"0\">\n<tr>";
+        for (int c = left; c <= right; ++c) {
+            out += "<th>";
+            appendCell(out, format, m_Headers.value(c));
+            out += "</th>";
+        }
+        out += "</tr>\n";
+        break;
+    }
+}
+
+/******************************************************************/
+
+QString XTableMimeData::mimeType(Format format)
+{
+    switch (format) {
+    case Tsv:      return QStringLiteral("text/plain");
+    case Csv:      return QStringLiteral("text/csv");
+    case Markdown: return QStringLiteral("text/markdown");
+    case Html:     return QStringLiteral("text/html");
+    }
+    return QString();
+}
+
+/******************************************************************/
+
+void XTableMimeData::appendCell(QByteArray &out, Format format, const QString &text)
+{
+    switch (format) {
+    case Tsv:
+        out += text.toUtf8();
+        break;
+    case Csv:
+        if (text.contains(QLatin1Char(',')) || text.contains(QLatin1Char('"'))
+                || text.contains(QLatin1Char('\n')) || text.contains(QLatin1Char('\r'))) {
+            out += '"';
+            out += QString(text).replace(QLatin1Char('"'), QLatin1String("\"\"")).toUtf8();
+            out += '"';
+        } else {
+            out += text.toUtf8();
+        }
+        break;
+    case Markdown:
+        out += QString(text)
+                .replace(QLatin1Char('|'), QLatin1String("\\|"))
+                .replace(QLatin1String("\r\n"), QLatin1String("<br>"))
+                .replace(QLatin1Char('\n'), QLatin1String("<br>"))
+                .toUtf8();
+        break;
+    case Html:
+        out += text.toHtmlEscaped().replace(QLatin1Char('\n'), QLatin1String("<br>")).toUtf8();
+        break;
+    }
+}
+
+/******************************************************************/
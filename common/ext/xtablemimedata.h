@@ -0,0 +1,74 @@
+#ifndef XTABLEMIMEDATA_H
+#define XTABLEMIMEDATA_H
+
+#include <QMimeData>
+#include <QPointer>
+#include <QAbstractItemModel>
+#include <QItemSelection>
+#include <QVector>
+#include <QHash>
+
+/******************************************************************/
+/**
+ * @brief Clipboard data of selected table cells in several formats
+ *
+ * Offers tab separated text, CSV, Markdown and HTML. A format is only
+ * rendered when the receiving application asks for it; cells are read
+ * from the model and written straight into a UTF-8 buffer sized from a
+ * sample of rows. If the model is about to change, the selected cell
+ * texts are copied first, so the clipboard keeps the copied state.
+ */
+class XTableMimeData : public QMimeData
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        Tsv,
+        Csv,
+        Markdown,
+        Html
+    };
+
+    enum {
+        SampleRows = 64 ///< rows rendered to estimate the buffer size
+    };
+
+    XTableMimeData(QAbstractItemModel *model, const QItemSelection &selection);
+
+    /// text of a cell which replaces the model data, e.g. the full value of a preview
+    void setCellText(int row, int column, const QString &text);
+
+    QStringList formats() const override;
+    bool hasFormat(const QString &mimetype) const override;
+
+    /// the complete text of format
+    QByteArray render(Format format) const;
+
+protected:
+    QVariant retrieveData(const QString &mimetype, QVariant::Type preferredType) const override;
+
+private Q_SLOTS:
+    void takeSnapshot();
+
+private:
+    QString cell(int row, int column, int position) const;
+    void appendRow(QByteArray &out, Format format, int row, int left, int right, int &position) const;
+    void appendHeader(QByteArray &out, Format format, int left, int right) const;
+
+private: // static
+    static QString mimeType(Format format);
+    static void appendCell(QByteArray &out, Format format, const QString &text);
+
+private:
+    QPointer<QAbstractItemModel> m_Model;
+    QVector<QItemSelectionRange> m_Ranges;
+    QHash<int, QString>          m_Headers;   ///< column -> header text
+    QHash<QPair<int, int>, QString> m_Cells;  ///< (row, column) -> text set by setCellText
+    QVector<QString>             m_Snapshot;  ///< cell texts in render order once the model changed
+    int                          m_LastRow = -1;
+    mutable Format               m_CachedFormat = Tsv;
+    mutable QByteArray           m_Cached;    ///< last rendered format
+};
+
+#endif // XTABLEMIMEDATA_H
@@ -0,0 +1,69 @@
+#include "xtablesizer.h"
+
+#include <QTableView>
+#include <QHeaderView>
+#include <QStyle>
+#include <QFontMetrics>
+#include <QHash>
+
+/******************************************************************/
+
+void XTableSizer::resize(QTableView *view, const QVector<int> &lengths)
+{
+    QAbstractItemModel *model = view->model();
+    if (!model) return;
+
+    const int rows = model->rowCount();
+    if (rows <= RowThreshold) {
+        view->resizeColumnsToContents();
+        view->resizeRowsToContents();
+        return;
+    }
+
+    const QFontMetrics &fm = metrics(view->font());
+    const QFontMetrics &headerFm = metrics(view->horizontalHeader()->font());
+    const int margin = 2 * fm.horizontalAdvance(QLatin1Char(' ')) + view->showGrid();
+    const int headerMargin = margin + view->horizontalHeader()->style()->pixelMetric(QStyle::PM_HeaderMarkSize);
+    const int maxWidth = qMax(MinWidth * 5, view->viewport()->width() / 2);
+    const int sample = qMin(rows, int(SampleRows));
+
+    for (int c = 0; c < model->columnCount(); ++c) {
+        if (view->isColumnHidden(c)) continue;
+
+        const int headerWidth = headerFm.horizontalAdvance(model->headerData(c, Qt::Horizontal).toString()) + headerMargin;
+        int width = headerWidth;
+        int longest = 0;
+        for (int r = 0; r < sample; ++r) {
+            const QString text = model->index(r, c).data().toString();
+            // measuring is the expensive part, shorter texts are rarely wider
+            if (text.size() * 2 < longest) continue;
+            longest = qMax(longest, text.size());
+            width = qMax(width, fm.horizontalAdvance(text) + margin);
+        }
+
+        // no value can be longer than declared
+        const int declared = lengths.value(c);
+        if (declared > 0) {
+            const int declaredWidth = declared * fm.maxWidth() + margin;
+            width = qMin(width, qMax(declaredWidth, headerWidth));
+        }
+        view->horizontalHeader()->resizeSection(c, qBound(int(MinWidth), width, maxWidth));
+    }
+
+    // sets every row, no row is measured
+    view->verticalHeader()->setDefaultSectionSize(fm.height() + 2 * fm.descent());
+}
+
+/******************************************************************/
+//! metrics per font, sizing runs after every query
+const QFontMetrics &XTableSizer::metrics(const QFont &font)
+{
+    static QHash<QString, QFontMetrics> cache;
+    auto it = cache.constFind(font.key());
+    if (it == cache.constEnd()) {
+        it = cache.insert(font.key(), QFontMetrics(font));
+    }
+    return it.value();
+}
+
+/******************************************************************/
@@ -0,0 +1,37 @@
+#ifndef XTABLESIZER_H
+#define XTABLESIZER_H
+
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QTableView;
+class QFont;
+class QFontMetrics;
+QT_END_NAMESPACE
+
+/******************************************************************/
+/**
+ * @brief Column widths of large tables from a sample of rows
+ *
+ * Up to RowThreshold rows the view is resized to contents as before.
+ * Above it column widths are measured from the header and the first
+ * SampleRows rows, limited by the declared length of the column if it is
+ * known, and all rows keep the default height.
+ */
+class XTableSizer
+{
+public:
+    enum {
+        RowThreshold = 1000,
+        SampleRows   = 200,
+        MinWidth     = 40
+    };
+
+    /// lengths are the declared characters per column, 0 or less if unknown
+    static void resize(QTableView *view, const QVector<int> &lengths = QVector<int>());
+
+private:
+    static const QFontMetrics &metrics(const QFont &font);
+};
+
+#endif // XTABLESIZER_H
@@ -13,9 +13,11 @@ HEADERS += \
     $$PWD/reportdoctemplate.h \
     $$PWD/reporttypes.h \
     $$PWD/reportutils.h \
-    $$PWD/simplereport.h
+    $$PWD/simplereport.h \
+    $$PWD/sqlrefmodel.h
 
-SOURCES +=
+SOURCES += \
+    $$PWD/sqlrefmodel.cpp
 
 contains(DEFINES, KD_REPORTS) {
     HEADERS += \
@@ -2,6 +2,7 @@
 #define REPORTUTILS_H
 
 #include "reporttypes.h"
+#include "sqlrefmodel.h"
 
 #include <QObject>
 #include <QLabel>
@@ -9,6 +10,8 @@
 #include <QLineEdit>
 #include <QSpinBox>
 #include <QDateEdit>
+#include <QCompleter>
+#include <QTimer>
 
 #include <QTextCursor>
 #include <QTextTable>
@@ -128,6 +131,58 @@ inline bool fillSqlRef(QComboBox *cmb, const QString &sql, QSqlDatabase db = QSq
     return false;
 }
 
+/******************************************************************/
+/**
+ * @brief backs the combo box with a lazily loaded reference model
+ *
+ * The combo shows the first page of the reference SQL, typing in it
+ * completes from the server with a prefix search.
+ */
+inline bool setupSqlRef(QComboBox *cmb, const QString &sql, QSqlDatabase db = QSqlDatabase(), QString *err = Q_NULLPTR)
+{
+    if (!cmb || sql.isEmpty()) return false;
+
+    const QSignalBlocker blocker(cmb);
+
+    auto model = qobject_cast<SqlRefModel*>(cmb->model());
+    if (!model) {
+        model = new SqlRefModel(cmb);
+    }
+    if (!model->setQuery(sql, db, err)) {
+        return false;
+    }
+    if (cmb->model() != model) {
+        cmb->setModel(model);
+        cmb->setEditable(true);
+        cmb->setInsertPolicy(QComboBox::NoInsert);
+
+        auto completion = new SqlRefModel(cmb);
+        auto completer  = new QCompleter(completion, cmb);
+        completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+        cmb->setCompleter(completer);
+
+        auto timer = new QTimer(cmb);
+        timer->setSingleShot(true);
+        timer->setInterval(250);
+
+        QObject::connect(cmb->lineEdit(), &QLineEdit::textEdited,
+                         timer, QOverload<>::of(&QTimer::start));
+        QObject::connect(timer, &QTimer::timeout, cmb, [cmb, model, completion, completer]() {
+            completion->setSource(model);
+            completion->setPrefix(cmb->lineEdit()->text());
+            completer->complete();
+        });
+        QObject::connect(completer, QOverload<const QModelIndex &>::of(&QCompleter::activated),
+                         cmb, [cmb, model](const QModelIndex &index) {
+            const int row = model->appendItem(index.data(Qt::DisplayRole).toString(),
+                                              index.data(Qt::UserRole));
+            cmb->setCurrentIndex(row);
+        });
+    }
+    cmb->setCurrentIndex(model->rowCount() ? 0 : -1);
+    return true;
+}
+
 /******************************************************************/
 
 inline QVariant paramValue(QWidget *editor) {
@@ -174,7 +229,9 @@ inline void setParamValue(QWidget *editor, QVariant value)
 
     QComboBox *refCombo = qobject_cast<QComboBox*>(editor);
     if (refCombo) {
-        int idx = refCombo->findData(value);
+        // a reference combo only holds the first page, the id is looked up on the server
+        auto refModel = qobject_cast<SqlRefModel*>(refCombo->model());
+        const int idx = refModel ? refModel->findId(value) : refCombo->findData(value);
         refCombo->setCurrentIndex(idx);
     }
 
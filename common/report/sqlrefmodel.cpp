@@ -0,0 +1,280 @@
+#include "sqlrefmodel.h"
+
+#include "dbdialect.h"
+
+#include <QCache>
+#include <QDateTime>
+
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlDriver>
+#include <QSqlError>
+
+using namespace Report;
+
+/******************************************************************/
+
+namespace {
+
+struct RefCacheEntry {
+    QDateTime               loaded;
+    SqlRefModel::ItemList   items;
+};
+
+struct RefCache {
+    QCache<QString, RefCacheEntry> entries;  ///< cost is the number of items
+    int ttl;
+
+    RefCache() : entries(200000), ttl(SqlRefModel::DefaultTtl) {}
+};
+
+RefCache &refCache()
+{
+    static RefCache cache;
+    return cache;
+}
+
+//! escapes LIKE wildcards with '!' which needs no quoting in any dialect
+QString likePattern(const QString &prefix)
+{
+    QString result(prefix);
+    result.replace("!", "!!").replace("%", "!%").replace("_", "!_");
+    return result + "%";
+}
+
+} // namespace
+
+/******************************************************************/
+
+SqlRefModel::SqlRefModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_Limit(DefaultLimit)
+{
+}
+
+/******************************************************************/
+
+int SqlRefModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_Items.size();
+}
+
+/******************************************************************/
+
+QVariant SqlRefModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_Items.size())
+        return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return m_Items.at(index.row()).text;
+    case Qt::UserRole:
+        return m_Items.at(index.row()).id;
+    }
+    return QVariant();
+}
+
+/******************************************************************/
+
+bool SqlRefModel::setQuery(const QString &sql, const QSqlDatabase &db, QString *err)
+{
+    m_Db  = db;
+    m_Sql = sql.trimmed();
+    while (m_Sql.endsWith(';')) {
+        m_Sql.chop(1);
+    }
+    m_IdField.clear();
+    m_TextField.clear();
+
+    // the prefix filter is pushed to the server only if the SQL works as a subquery
+    QSqlQuery probe(m_Db);
+    if (probe.exec(QString("SELECT * FROM (%1) ref_q WHERE 1=0").arg(m_Sql))
+            && probe.record().count() > 1) {
+        m_IdField   = probe.record().fieldName(0);
+        m_TextField = probe.record().fieldName(1);
+    }
+
+    ItemList items;
+    const bool ok = fetch(QString(), &items, err);
+
+    beginResetModel();
+    m_Prefix.clear();
+    m_Items = items;
+    endResetModel();
+    return ok;
+}
+
+/******************************************************************/
+
+void SqlRefModel::setSource(const SqlRefModel *other)
+{
+    beginResetModel();
+    m_Db        = other->m_Db;
+    m_Sql       = other->m_Sql;
+    m_IdField   = other->m_IdField;
+    m_TextField = other->m_TextField;
+    m_Limit     = other->m_Limit;
+    m_Prefix.clear();
+    m_Items.clear();
+    endResetModel();
+}
+
+/******************************************************************/
+
+void SqlRefModel::setPrefix(const QString &prefix)
+{
+    ItemList items;
+    fetch(prefix, &items);
+
+    beginResetModel();
+    m_Prefix = prefix;
+    m_Items = items;
+    endResetModel();
+}
+
+/******************************************************************/
+
+int SqlRefModel::appendItem(const QString &text, const QVariant &id)
+{
+    for (int i = 0; i < m_Items.size(); ++i) {
+        if (m_Items.at(i).id == id) return i;
+    }
+
+    const int row = m_Items.size();
+    beginInsertRows(QModelIndex(), row, row);
+    Item item;
+    item.text = text;
+    item.id   = id;
+    m_Items.append(item);
+    endInsertRows();
+    return row;
+}
+
+/******************************************************************/
+//! the id may be behind the loaded page, it is looked up in the reference SQL then
+int SqlRefModel::findId(const QVariant &id)
+{
+    for (int i = 0; i < m_Items.size(); ++i) {
+        if (m_Items.at(i).id == id) return i;
+    }
+    if (m_Sql.isEmpty() || id.isNull()) return -1;
+
+    if (m_IdField.isEmpty()) {
+        ItemList page;
+        if (!loadPage(QString(), &page)) return -1;
+        for (const auto &item : qAsConst(page)) {
+            if (item.id == id) return appendItem(item.text, item.id);
+        }
+        return -1;
+    }
+
+    QSqlQuery query(m_Db);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT * FROM (%1) ref_q WHERE %2 = :id")
+                  .arg(m_Sql, m_Db.driver()->escapeIdentifier(m_IdField, QSqlDriver::FieldName)));
+    query.bindValue(":id", id);
+    if (!query.exec() || !query.next()) return -1;
+    return appendItem(query.value(1).toString(), query.value(0));
+}
+
+/******************************************************************/
+
+void SqlRefModel::setCacheTtl(int seconds)
+{
+    refCache().ttl = seconds;
+}
+
+/******************************************************************/
+
+void SqlRefModel::clearCache()
+{
+    refCache().entries.clear();
+}
+
+/******************************************************************/
+
+bool SqlRefModel::fetch(const QString &prefix, ItemList *items, QString *err) const
+{
+    // without server side filter all rows are fetched once and filtered here
+    const bool serverSide = !m_TextField.isEmpty();
+    ItemList page;
+    if (!loadPage(serverSide ? prefix : QString(), &page, err)) {
+        return false;
+    }
+
+    if (serverSide) {
+        *items = page;
+        return true;
+    }
+
+    items->clear();
+    for (const auto &item : qAsConst(page)) {
+        if (items->size() >= m_Limit) break;
+        if (item.text.startsWith(prefix, Qt::CaseInsensitive)) {
+            items->append(item);
+        }
+    }
+    return true;
+}
+
+/******************************************************************/
+//! rows of the reference SQL starting with pagePrefix, all rows if it is filtered on the client
+bool SqlRefModel::loadPage(const QString &pagePrefix, ItemList *page, QString *err) const
+{
+    if (m_Sql.isEmpty()) return false;
+
+    const bool serverSide = !m_TextField.isEmpty();
+    const QString key = m_Db.connectionName() + '\n' + m_Sql + '\n'
+            + QString::number(serverSide ? m_Limit : -1) + '\n' + pagePrefix;
+
+    RefCache &cache = refCache();
+    RefCacheEntry *entry = cache.entries.object(key);
+    if (entry && entry->loaded.secsTo(QDateTime::currentDateTime()) < cache.ttl) {
+        *page = entry->items;
+        return true;
+    }
+
+    QString sql = m_Sql;
+    if (serverSide) {
+        sql = QString("SELECT * FROM (%1) ref_q").arg(m_Sql);
+        if (!pagePrefix.isEmpty()) {
+            // LIKE is case sensitive on some servers, the client filter is not
+            sql += QString(" WHERE UPPER(%1) LIKE UPPER(:prefix) ESCAPE '!'")
+                    .arg(m_Db.driver()->escapeIdentifier(m_TextField, QSqlDriver::FieldName));
+        }
+        sql = Db::limitSql(m_Db.driverName(), sql, m_Limit);
+    }
+
+    QSqlQuery query(m_Db);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    if (serverSide && !pagePrefix.isEmpty()) {
+        query.bindValue(":prefix", likePattern(pagePrefix));
+    }
+    if (!query.exec() || !query.isSelect()) {
+        if (err && query.lastError().type() != QSqlError::NoError) {
+            err->append(query.lastError().text());
+        }
+        return false;
+    }
+    page->clear();
+    while (query.next()) {
+        if (serverSide && page->size() >= m_Limit) break;
+        Item item;
+        item.id   = query.value(0);
+        item.text = query.value(1).toString();
+        page->append(item);
+    }
+
+    // QCache drops entries above its capacity, all rows of a client side filter take the whole cache
+    entry = new RefCacheEntry;
+    entry->loaded = QDateTime::currentDateTime();
+    entry->items  = *page;
+    cache.entries.insert(key, entry, qMin(page->size() + 1, cache.entries.maxCost()));
+    return true;
+}
+
+/******************************************************************/
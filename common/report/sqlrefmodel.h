@@ -0,0 +1,87 @@
+#ifndef SQLREFMODEL_H
+#define SQLREFMODEL_H
+
+#include <QAbstractListModel>
+#include <QSqlDatabase>
+#include <QVector>
+
+namespace Report {
+
+/******************************************************************/
+/**
+ * @brief List model of a reference SQL (first column is id, second is text)
+ *
+ * Rows are not loaded eagerly: only the first limit() rows whose text starts
+ * with prefix() are fetched, the prefix filter and the limit are pushed to the
+ * server when the reference SQL can be used as a subquery. Fetched pages are
+ * shared between models through a cache keyed by connection, SQL and prefix.
+ */
+class SqlRefModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    struct Item {
+        QString  text;
+        QVariant id;
+    };
+    typedef QVector<Item> ItemList;
+
+    enum { DefaultLimit = 100, DefaultTtl = 300 };
+
+    explicit SqlRefModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /// checks the reference SQL and loads the first page
+    bool setQuery(const QString &sql, const QSqlDatabase &db, QString *err = Q_NULLPTR);
+
+    /// use the same reference SQL as other without checking it again
+    void setSource(const SqlRefModel *other);
+
+    QString prefix() const {
+        return m_Prefix;
+    }
+
+    /// reloads rows whose text starts with prefix
+    void setPrefix(const QString &prefix);
+
+    int limit() const {
+        return m_Limit;
+    }
+
+    void setLimit(int limit) {
+        m_Limit = limit;
+    }
+
+    /// appends the item unless an item with the same id is loaded, returns its row
+    int appendItem(const QString &text, const QVariant &id);
+
+    /// row of the item with id, it is loaded and appended if it is not on the page; -1 if unknown
+    int findId(const QVariant &id);
+
+public: // static
+    /// seconds while fetched rows are reused
+    static void setCacheTtl(int seconds);
+    static void clearCache();
+
+private:
+    bool fetch(const QString &prefix, ItemList *items, QString *err = Q_NULLPTR) const;
+    bool loadPage(const QString &pagePrefix, ItemList *page, QString *err = Q_NULLPTR) const;
+
+private:
+    QSqlDatabase m_Db;
+    QString      m_Sql;
+    QString      m_IdField;    ///< name of the id column, empty if filtered on the client
+    QString      m_TextField;  ///< name of the text column, empty if filtered on the client
+    QString      m_Prefix;
+    int          m_Limit;
+    ItemList     m_Items;
+};
+
+/******************************************************************/
+
+} // namespace Report
+
+#endif // SQLREFMODEL_H
@@ -8,7 +8,7 @@
 #include <QMimeDatabase>
 #include <QMimeType>
 
-#include <QSqlQueryModel>
+#include <QAbstractItemModel>
 
 /******************************************************************/
 
@@ -31,7 +31,7 @@ SimpleReportWidget::~SimpleReportWidget()
 
 /******************************************************************/
 
-void SimpleReportWidget::setUserQueryModel(QSqlQueryModel *model)
+void SimpleReportWidget::setUserQueryModel(QAbstractItemModel *model)
 {
     m_Model = model;
     ui->querySrTable->setModel(m_Model);
@@ -7,7 +7,7 @@
 #include <QIcon>
 
 QT_BEGIN_NAMESPACE
-class QSqlQueryModel;
+class QAbstractItemModel;
 QT_END_NAMESPACE
 
 namespace Ui {
@@ -22,7 +22,7 @@ public:
     explicit SimpleReportWidget(QWidget *parent = nullptr);
     ~SimpleReportWidget();
 
-    void setUserQueryModel(QSqlQueryModel *model);
+    void setUserQueryModel(QAbstractItemModel *model);
     void updateView();
 
 Q_SIGNALS:
@@ -46,7 +46,7 @@ public: // static
 
 private:
     Ui::SimpleReportWidget *ui;
-    QSqlQueryModel *m_Model;
+    QAbstractItemModel *m_Model;
 };
 
 #endif // SIMPLEREPORTWIDGET_H
@@ -0,0 +1,190 @@
+#include "xsortfiltermodel.h"
+
+#include <QtTest>
+#include <QAbstractTableModel>
+
+/******************************************************************/
+/**
+ * @brief One integer column whose rows are rearranged like DbRefreshModel does
+ */
+class PermutedModel : public QAbstractTableModel
+{
+public:
+    explicit PermutedModel(const QVector<int> &values, QObject *parent = Q_NULLPTR)
+        : QAbstractTableModel(parent)
+        , m_Values(values)
+    {
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : m_Values.size();
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : 1;
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override {
+        if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+            return QVariant();
+        return m_Values.at(index.row());
+    }
+
+    /// row i takes the old row order[i]
+    void permute(const QVector<int> &order) {
+        emit layoutAboutToBeChanged();
+        QVector<int> values(order.size());
+        QVector<int> target(order.size());
+        for (int i = 0; i < order.size(); ++i) {
+            values[i] = m_Values.at(order.at(i));
+            target[order.at(i)] = i;
+        }
+        m_Values = values;
+
+        const QModelIndexList from = persistentIndexList();
+        QModelIndexList to;
+        for (const auto &idx : from) {
+            to << index(target.at(idx.row()), idx.column());
+        }
+        changePersistentIndexList(from, to);
+        emit layoutChanged();
+    }
+
+    /// moves the first row to the end
+    void rotate() {
+        beginMoveRows(QModelIndex(), 0, 0, QModelIndex(), m_Values.size());
+        m_Values.append(m_Values.takeFirst());
+        endMoveRows();
+    }
+
+private:
+    QVector<int> m_Values;
+};
+
+/******************************************************************/
+
+class XSortFilterModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void sortedLayoutChange();
+    void filteredLayoutChange();
+    void identityLayoutChange();
+    void sortedRowsMoved();
+
+private: // static
+    static QVector<int> proxyValues(const XSortFilterModel &proxy);
+    static void checkMapping(const XSortFilterModel &proxy);
+};
+
+/******************************************************************/
+
+QVector<int> XSortFilterModelTest::proxyValues(const XSortFilterModel &proxy)
+{
+    QVector<int> values;
+    for (int r = 0; r < proxy.rowCount(); ++r) {
+        values << proxy.index(r, 0).data().toInt();
+    }
+    return values;
+}
+
+/******************************************************************/
+//! every proxy row maps to a source row and back
+void XSortFilterModelTest::checkMapping(const XSortFilterModel &proxy)
+{
+    for (int r = 0; r < proxy.rowCount(); ++r) {
+        const QModelIndex source = proxy.mapToSource(proxy.index(r, 0));
+        QVERIFY(source.isValid());
+        QCOMPARE(source.data(), proxy.index(r, 0).data());
+        QCOMPARE(proxy.mapFromSource(source).row(), r);
+    }
+}
+
+/******************************************************************/
+
+void XSortFilterModelTest::sortedLayoutChange()
+{
+    PermutedModel source(QVector<int>() << 30 << 10 << 50 << 20 << 40);
+    XSortFilterModel proxy;
+    proxy.setSourceModel(&source);
+    proxy.sort(0, Qt::DescendingOrder);
+    QCOMPARE(proxyValues(proxy), QVector<int>() << 50 << 40 << 30 << 20 << 10);
+
+    const QPersistentModelIndex selected = proxy.index(1, 0);
+    QCOMPARE(selected.data().toInt(), 40);
+
+    QSignalSpy aboutSpy(&proxy, &QAbstractItemModel::layoutAboutToBeChanged);
+    QSignalSpy changedSpy(&proxy, &QAbstractItemModel::layoutChanged);
+    source.permute(QVector<int>() << 4 << 2 << 0 << 3 << 1);
+
+    QCOMPARE(aboutSpy.count(), 1);
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(proxyValues(proxy), QVector<int>() << 50 << 40 << 30 << 20 << 10);
+    checkMapping(proxy);
+    QVERIFY(selected.isValid());
+    QCOMPARE(selected.row(), 1);
+    QCOMPARE(selected.data().toInt(), 40);
+    QCOMPARE(proxy.mapToSource(selected).row(), 0);
+}
+
+/******************************************************************/
+
+void XSortFilterModelTest::filteredLayoutChange()
+{
+    PermutedModel source(QVector<int>() << 30 << 10 << 50 << 20 << 40);
+    XSortFilterModel proxy;
+    proxy.setSourceModel(&source);
+    proxy.setFilter(0, ">25");
+    QCOMPARE(proxyValues(proxy), QVector<int>() << 30 << 50 << 40);
+
+    const QPersistentModelIndex selected = proxy.index(1, 0);
+    source.permute(QVector<int>() << 1 << 3 << 4 << 2 << 0);
+
+    QCOMPARE(proxyValues(proxy), QVector<int>() << 40 << 50 << 30);
+    checkMapping(proxy);
+    QCOMPARE(selected.data().toInt(), 50);
+    QCOMPARE(selected.row(), 1);
+}
+
+/******************************************************************/
+
+void XSortFilterModelTest::identityLayoutChange()
+{
+    PermutedModel source(QVector<int>() << 1 << 2 << 3);
+    XSortFilterModel proxy;
+    proxy.setSourceModel(&source);
+
+    const QPersistentModelIndex selected = proxy.index(0, 0);
+    QSignalSpy changedSpy(&proxy, &QAbstractItemModel::layoutChanged);
+    source.permute(QVector<int>() << 2 << 1 << 0);
+
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(proxyValues(proxy), QVector<int>() << 3 << 2 << 1);
+    QCOMPARE(selected.row(), 2);
+    QCOMPARE(selected.data().toInt(), 1);
+}
+
+/******************************************************************/
+
+void XSortFilterModelTest::sortedRowsMoved()
+{
+    PermutedModel source(QVector<int>() << 3 << 1 << 2);
+    XSortFilterModel proxy;
+    proxy.setSourceModel(&source);
+    proxy.sort(0, Qt::AscendingOrder);
+
+    const QPersistentModelIndex selected = proxy.index(2, 0);
+    source.rotate();
+
+    QCOMPARE(proxyValues(proxy), QVector<int>() << 1 << 2 << 3);
+    checkMapping(proxy);
+    QCOMPARE(selected.row(), 2);
+    QCOMPARE(proxy.mapToSource(selected).row(), 2);
+}
+
+/******************************************************************/
+
+QTEST_APPLESS_MAIN(XSortFilterModelTest)
+
+#include "tst_xsortfiltermodel.moc"
@@ -0,0 +1,16 @@
+QT += testlib concurrent
+QT -= gui
+
+CONFIG += c++11 testcase console
+CONFIG -= app_bundle
+
+TARGET = tst_xsortfiltermodel
+
+INCLUDEPATH += ../../common/ext
+
+HEADERS += \
+    ../../common/ext/xsortfiltermodel.h
+
+SOURCES += \
+    ../../common/ext/xsortfiltermodel.cpp \
+    tst_xsortfiltermodel.cpp